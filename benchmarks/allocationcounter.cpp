@@ -0,0 +1,159 @@
+#include "allocationcounter.h"
+
+#include <QtCore/qfile.h>
+#include <QtCore/qbytearray.h>
+
+#include <atomic>
+#include <cstdlib>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *pointer);
+}
+
+// Constant-initialized, so they are usable by the allocations made before main()
+static std::atomic<qint64> allocationCount(0);
+static std::atomic<qint64> allocatedByteCount(0);
+static std::atomic<qint64> liveByteCount(0);
+static std::atomic<qint64> peakByteCount(0);
+static std::atomic<qint64> baseByteCount(0);
+
+static void *recordAllocation(void *pointer)
+{
+    if (!pointer)
+        return pointer;
+    const qint64 size = qint64(malloc_usable_size(pointer));
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedByteCount.fetch_add(size, std::memory_order_relaxed);
+    const qint64 live = liveByteCount.fetch_add(size, std::memory_order_relaxed) + size;
+    qint64 peak = peakByteCount.load(std::memory_order_relaxed);
+    while (live > peak && !peakByteCount.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return pointer;
+}
+
+static void recordRelease(void *pointer)
+{
+    if (pointer)
+        liveByteCount.fetch_sub(qint64(malloc_usable_size(pointer)), std::memory_order_relaxed);
+}
+
+extern "C" {
+
+void *malloc(size_t size)
+{
+    return recordAllocation(__libc_malloc(size));
+}
+
+void *calloc(size_t count, size_t size)
+{
+    return recordAllocation(__libc_calloc(count, size));
+}
+
+void *realloc(void *pointer, size_t size)
+{
+    // the size of the old block is only known before the call, and only released on success
+    const qint64 released = pointer ? qint64(malloc_usable_size(pointer)) : 0;
+    void *reallocated = __libc_realloc(pointer, size);
+    if (!reallocated && size)
+        return reallocated; // the original block is still allocated
+    liveByteCount.fetch_sub(released, std::memory_order_relaxed);
+    return recordAllocation(reallocated);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    return recordAllocation(__libc_memalign(alignment, size));
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    return recordAllocation(__libc_memalign(alignment, size));
+}
+
+int posix_memalign(void **pointer, size_t alignment, size_t size)
+{
+    void *allocated = recordAllocation(__libc_memalign(alignment, size));
+    if (!allocated)
+        return 12; // ENOMEM
+    *pointer = allocated;
+    return 0;
+}
+
+void free(void *pointer)
+{
+    recordRelease(pointer);
+    __libc_free(pointer);
+}
+
+} // extern "C"
+
+bool AllocationCounter::isAvailable()
+{
+    return true;
+}
+
+AllocationCounter::Snapshot AllocationCounter::snapshot()
+{
+    Snapshot snapshot;
+    snapshot.allocations = allocationCount.load(std::memory_order_relaxed);
+    snapshot.allocatedBytes = allocatedByteCount.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void AllocationCounter::resetPeak()
+{
+    const qint64 live = liveByteCount.load(std::memory_order_relaxed);
+    baseByteCount.store(live, std::memory_order_relaxed);
+    peakByteCount.store(live, std::memory_order_relaxed);
+}
+
+qint64 AllocationCounter::peakBytes()
+{
+    return peakByteCount.load(std::memory_order_relaxed) - baseByteCount.load(std::memory_order_relaxed);
+}
+
+#else
+
+bool AllocationCounter::isAvailable()
+{
+    return false;
+}
+
+AllocationCounter::Snapshot AllocationCounter::snapshot()
+{
+    return Snapshot();
+}
+
+void AllocationCounter::resetPeak()
+{
+}
+
+qint64 AllocationCounter::peakBytes()
+{
+    return 0;
+}
+
+#endif
+
+qint64 AllocationCounter::peakResidentBytes()
+{
+    // Linux only: "VmHWM:    123456 kB"
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (!status.open(QIODevice::ReadOnly))
+        return -1;
+    const QByteArray content = status.readAll();
+    const int line = content.indexOf("VmHWM:");
+    if (line < 0)
+        return -1;
+    const int end = content.indexOf('\n', line);
+    bool ok = false;
+    const qint64 kilobytes = content.mid(line + 6, end < 0 ? -1 : end - line - 6).replace("kB", "").trimmed().toLongLong(&ok);
+    return ok ? kilobytes * 1024 : -1;
+}
@@ -0,0 +1,31 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtCore/qglobal.h>
+
+// Counts the heap allocations of the whole process, Qt containers included, by replacing
+// malloc() and friends. Only available with glibc, elsewhere isAvailable() returns false
+// and the counters stay at zero.
+class AllocationCounter
+{
+public:
+    struct Snapshot
+    {
+        Snapshot() : allocations(0), allocatedBytes(0) {}
+
+        qint64 allocations;
+        qint64 allocatedBytes;
+    };
+
+    static bool isAvailable();
+    static Snapshot snapshot();
+
+    // peak of the bytes in use since the last resetPeak(), minus the bytes in use at that time
+    static void resetPeak();
+    static qint64 peakBytes();
+
+    // high water mark of the resident set of the process, -1 when unknown
+    static qint64 peakResidentBytes();
+};
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,290 @@
+#include "geojsongenerator.h"
+
+#include <QtCore/qmath.h>
+
+// Positions per feature, the closing position of each ring included
+static const int pointVertices = 1;
+static const int multiPointVertices = 16;
+static const int lineStringVertices = 64;
+static const int multiLineStringLines = 4;
+static const int multiLineStringLineVertices = 32;
+static const int polygonOuterVertices = 48;
+static const int polygonHoles = 2;
+static const int polygonHoleVertices = 12;
+static const int multiPolygonPolygons = 3;
+static const int multiPolygonOuterVertices = 24;
+static const int multiPolygonHoleVertices = 8;
+static const int heavyPropertyCount = 40;
+
+GeoJsonGenerator::GeoJsonGenerator(quint64 seed)
+    : m_state(seed ? seed : 1)
+{
+}
+
+QString GeoJsonGenerator::kindName(Kind kind)
+{
+    switch (kind) {
+    case Point:
+        return QStringLiteral("Point");
+    case MultiPoint:
+        return QStringLiteral("MultiPoint");
+    case LineString:
+        return QStringLiteral("LineString");
+    case MultiLineString:
+        return QStringLiteral("MultiLineString");
+    case Polygon:
+        return QStringLiteral("Polygon");
+    case MultiPolygon:
+        return QStringLiteral("MultiPolygon");
+    case GeometryCollection:
+        return QStringLiteral("GeometryCollection");
+    case HeavyProperties:
+        return QStringLiteral("HeavyProperties");
+    }
+    return QString();
+}
+
+int GeoJsonGenerator::featureVertexCount(Kind kind)
+{
+    switch (kind) {
+    case Point:
+    case HeavyProperties:
+        return pointVertices;
+    case MultiPoint:
+        return multiPointVertices;
+    case LineString:
+        return lineStringVertices;
+    case MultiLineString:
+        return multiLineStringLines * multiLineStringLineVertices;
+    case Polygon:
+        return polygonOuterVertices + 1 + polygonHoles * (polygonHoleVertices + 1);
+    case MultiPolygon:
+        return multiPolygonPolygons * (multiPolygonOuterVertices + 1 + multiPolygonHoleVertices + 1);
+    case GeometryCollection:
+        // a Point, a LineString and a GeometryCollection of a Polygon and a MultiPoint
+        return 1 + 16 + (16 + 1) + 4;
+    }
+    return 0;
+}
+
+GeoJsonGenerator::Document GeoJsonGenerator::generate(Kind kind, qint64 vertexCount)
+{
+    Document document;
+    const int perFeature = featureVertexCount(kind);
+    document.featureCount = int(qMax<qint64>(1, vertexCount / perFeature));
+    document.vertexCount = qint64(document.featureCount) * perFeature;
+
+    // about 20 bytes per position, more for the properties
+    document.text.reserve(int(qMin<qint64>(document.vertexCount * 24 + qint64(document.featureCount) * 96
+                                           * (kind == HeavyProperties ? 16 : 1), 1 << 30)));
+    document.text.append("{\"type\":\"FeatureCollection\",\"features\":[");
+    for (int i = 0; i < document.featureCount; ++i) {
+        if (i)
+            document.text.append(',');
+        document.text.append("{\"type\":\"Feature\",\"id\":");
+        document.text.append(QByteArray::number(i));
+        document.text.append(",\"geometry\":");
+        appendGeometry(&document.text, kind);
+        document.text.append(",\"properties\":");
+        appendProperties(&document.text, kind, i);
+        document.text.append('}');
+    }
+    document.text.append("]}");
+    return document;
+}
+
+// xorshift64*, fixed so that the documents do not depend on the standard library
+quint64 GeoJsonGenerator::next()
+{
+    m_state ^= m_state >> 12;
+    m_state ^= m_state << 25;
+    m_state ^= m_state >> 27;
+    return m_state * Q_UINT64_C(0x2545F4914F6CDD1D);
+}
+
+double GeoJsonGenerator::uniform(double low, double high)
+{
+    return low + (high - low) * double(next() >> 11) / double(Q_UINT64_C(1) << 53);
+}
+
+void GeoJsonGenerator::appendNumber(QByteArray *text, double value)
+{
+    // seven decimals, about 1 cm, as most producers write them
+    QByteArray number = QByteArray::number(value, 'f', 7);
+    int size = number.size();
+    while (number.at(size - 1) == '0')
+        --size;
+    if (number.at(size - 1) == '.')
+        --size;
+    number.truncate(size);
+    text->append(number);
+}
+
+void GeoJsonGenerator::appendPosition(QByteArray *text, double x, double y)
+{
+    text->append('[');
+    appendNumber(text, x);
+    text->append(',');
+    appendNumber(text, y);
+    text->append(']');
+}
+
+void GeoJsonGenerator::appendLine(QByteArray *text, double x, double y, int count)
+{
+    // random walk of about 100 m steps
+    text->append('[');
+    for (int i = 0; i < count; ++i) {
+        if (i)
+            text->append(',');
+        appendPosition(text, x, y);
+        x = qBound(-180.0, x + uniform(-0.001, 0.001), 180.0);
+        y = qBound(-85.0, y + uniform(-0.001, 0.001), 85.0);
+    }
+    text->append(']');
+}
+
+void GeoJsonGenerator::appendRing(QByteArray *text, double x, double y, double radius, int count)
+{
+    // count positions around the center, then the first one again
+    QByteArray first;
+    text->append('[');
+    for (int i = 0; i < count; ++i) {
+        const double angle = 2 * M_PI * i / count;
+        const double distance = radius * uniform(0.8, 1.0);
+        const int begin = text->size();
+        appendPosition(text, x + distance * qCos(angle), y + distance * qSin(angle));
+        if (i == 0)
+            first = text->mid(begin);
+        text->append(',');
+    }
+    text->append(first);
+    text->append(']');
+}
+
+void GeoJsonGenerator::appendPolygon(QByteArray *text, double x, double y, double radius, int outerCount,
+                                     int holeCount, int holeVertexCount)
+{
+    text->append('[');
+    appendRing(text, x, y, radius, outerCount);
+    for (int i = 0; i < holeCount; ++i) {
+        text->append(',');
+        const double offset = (i - (holeCount - 1) / 2.0) * radius * 0.4;
+        appendRing(text, x + offset, y, radius * 0.15, holeVertexCount);
+    }
+    text->append(']');
+}
+
+void GeoJsonGenerator::appendGeometry(QByteArray *text, Kind kind)
+{
+    const double x = uniform(-179, 179);
+    const double y = uniform(-84, 84);
+    switch (kind) {
+    case Point:
+    case HeavyProperties:
+        text->append("{\"type\":\"Point\",\"coordinates\":");
+        appendPosition(text, x, y);
+        break;
+    case MultiPoint:
+        text->append("{\"type\":\"MultiPoint\",\"coordinates\":");
+        appendLine(text, x, y, multiPointVertices);
+        break;
+    case LineString:
+        text->append("{\"type\":\"LineString\",\"coordinates\":");
+        appendLine(text, x, y, lineStringVertices);
+        break;
+    case MultiLineString:
+        text->append("{\"type\":\"MultiLineString\",\"coordinates\":[");
+        for (int i = 0; i < multiLineStringLines; ++i) {
+            if (i)
+                text->append(',');
+            appendLine(text, x, y + i * 0.01, multiLineStringLineVertices);
+        }
+        text->append(']');
+        break;
+    case Polygon:
+        text->append("{\"type\":\"Polygon\",\"coordinates\":");
+        appendPolygon(text, x, y, 0.01, polygonOuterVertices, polygonHoles, polygonHoleVertices);
+        break;
+    case MultiPolygon:
+        text->append("{\"type\":\"MultiPolygon\",\"coordinates\":[");
+        for (int i = 0; i < multiPolygonPolygons; ++i) {
+            if (i)
+                text->append(',');
+            appendPolygon(text, x + i * 0.03, y, 0.01, multiPolygonOuterVertices, 1, multiPolygonHoleVertices);
+        }
+        text->append(']');
+        break;
+    case GeometryCollection:
+        text->append("{\"type\":\"GeometryCollection\",\"geometries\":[{\"type\":\"Point\",\"coordinates\":");
+        appendPosition(text, x, y);
+        text->append("},{\"type\":\"LineString\",\"coordinates\":");
+        appendLine(text, x, y, 16);
+        text->append("},{\"type\":\"GeometryCollection\",\"geometries\":[{\"type\":\"Polygon\",\"coordinates\":");
+        appendPolygon(text, x, y, 0.005, 16, 0, 0);
+        text->append("},{\"type\":\"MultiPoint\",\"coordinates\":");
+        appendLine(text, x, y, 4);
+        text->append("}]}]");
+        break;
+    }
+    text->append('}');
+}
+
+void GeoJsonGenerator::appendProperties(QByteArray *text, Kind kind, int feature)
+{
+    if (kind != HeavyProperties) {
+        text->append("{\"name\":\"feature ");
+        text->append(QByteArray::number(feature));
+        text->append("\",\"rank\":");
+        text->append(QByteArray::number(int(next() % 1000)));
+        text->append('}');
+        return;
+    }
+
+    // the same keys for every feature, values of every JSON type
+    text->append('{');
+    for (int i = 0; i < heavyPropertyCount; ++i) {
+        if (i)
+            text->append(',');
+        text->append("\"attribute");
+        text->append(QByteArray::number(i));
+        text->append("\":");
+        switch (i % 8) {
+        case 0:
+            text->append('"');
+            for (int j = 0; j < 24; ++j)
+                text->append(char('a' + next() % 26));
+            text->append('"');
+            break;
+        case 1:
+            text->append(QByteArray::number(qint64(next() % 1000000)));
+            break;
+        case 2:
+            appendNumber(text, uniform(-1000, 1000));
+            break;
+        case 3:
+            text->append(next() & 1 ? "true" : "false");
+            break;
+        case 4:
+            text->append("null");
+            break;
+        case 5:
+            text->append("\"quoted \\\"value\\\" \\u00e9 ");
+            text->append(QByteArray::number(feature));
+            text->append('"');
+            break;
+        case 6:
+            text->append('[');
+            text->append(QByteArray::number(int(next() % 100)));
+            text->append(',');
+            text->append(QByteArray::number(int(next() % 100)));
+            text->append(",\"tag\"]");
+            break;
+        case 7:
+            text->append("{\"code\":");
+            text->append(QByteArray::number(int(next() % 100000)));
+            text->append(",\"source\":\"survey\"}");
+            break;
+        }
+    }
+    text->append('}');
+}
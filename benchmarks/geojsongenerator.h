@@ -0,0 +1,57 @@
+#ifndef GEOJSONGENERATOR_H
+#define GEOJSONGENERATOR_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstring.h>
+
+// Deterministic synthetic GeoJSON: the same kind, vertex count and seed always give the same
+// bytes, on every platform, so results can be compared between versions of the importer.
+class GeoJsonGenerator
+{
+public:
+    enum Kind {
+        Point,
+        MultiPoint,
+        LineString,
+        MultiLineString,
+        Polygon, // with holes
+        MultiPolygon,
+        GeometryCollection, // nested
+        HeavyProperties // Point features with many properties
+    };
+    static const int KindCount = HeavyProperties + 1;
+
+    struct Document
+    {
+        Document() : vertexCount(0), featureCount(0) {}
+
+        QByteArray text; // a FeatureCollection
+        qint64 vertexCount;
+        int featureCount;
+    };
+
+    explicit GeoJsonGenerator(quint64 seed = 1);
+
+    // a FeatureCollection of features of the given kind, with about vertexCount positions
+    Document generate(Kind kind, qint64 vertexCount);
+
+    static QString kindName(Kind kind);
+    static int featureVertexCount(Kind kind);
+
+private:
+    quint64 next();
+    double uniform(double low, double high);
+
+    void appendNumber(QByteArray *text, double value);
+    void appendPosition(QByteArray *text, double x, double y);
+    void appendLine(QByteArray *text, double x, double y, int count);
+    void appendRing(QByteArray *text, double x, double y, double radius, int count);
+    void appendPolygon(QByteArray *text, double x, double y, double radius, int outerCount,
+                       int holeCount, int holeVertexCount);
+    void appendGeometry(QByteArray *text, Kind kind);
+    void appendProperties(QByteArray *text, Kind kind, int feature);
+
+    quint64 m_state;
+};
+
+#endif // GEOJSONGENERATOR_H
@@ -0,0 +1,403 @@
+#include "allocationcounter.h"
+#include "geojsongenerator.h"
+
+#include <qgeojson_p.h>
+
+#include <QtCore/qcborvalue.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qcommandlineparser.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
+#include <QtCore/qsysinfo.h>
+#include <QtCore/qtextstream.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qvector.h>
+
+#include <algorithm>
+
+/*
+    Import and export benchmarks of QGeoJson on deterministic synthetic documents.
+
+    Each case is a FeatureCollection of one kind of feature, see GeoJsonGenerator, at one of
+    the sizes below. Every operation is run once to warm up, then until it ran at least
+    --iterations times and for at least --min-time milliseconds. One JSON object per line is
+    written for each case and operation, with the median and fastest wall time, the
+    throughput in bytes and vertices per second, and the heap allocations, allocated bytes
+    and peak heap bytes of one run. Two result files can be compared with --baseline.
+
+    The cbor-* operations time the same documents in the CBOR encoding of
+    exportGeoJsonCbor(); their bytes are those of the CBOR payload, so their MB/s and
+    vertices/s compare directly with the text operations.
+*/
+
+struct SizeClass
+{
+    const char *name;
+    qint64 vertexCount;
+};
+
+static const SizeClass sizeClasses[] = {
+    { "tiny", 100 },
+    { "small", 10000 },
+    { "medium", 250000 },
+    { "large", 2000000 },
+    { "huge", 10000000 }
+};
+
+struct Measurement
+{
+    Measurement() : iterations(0), minimumNs(0), medianNs(0), allocations(0), allocatedBytes(0), peakBytes(0) {}
+
+    int iterations;
+    qint64 minimumNs;
+    qint64 medianNs;
+    qint64 allocations; // of the first measured run
+    qint64 allocatedBytes;
+    qint64 peakBytes; // largest over the runs, what the result holds included
+};
+
+// The result of function is released after the clock stops
+template <typename Function>
+static Measurement measure(Function function, int minIterations, qint64 minTimeNs)
+{
+    {
+        const auto warmUp = function();
+        Q_UNUSED(warmUp)
+    }
+
+    Measurement measurement;
+    QVector<qint64> times;
+    qint64 totalNs = 0;
+    QElapsedTimer timer;
+    while (times.size() < minIterations || (totalNs < minTimeNs && times.size() < 1000)) {
+        AllocationCounter::resetPeak();
+        const AllocationCounter::Snapshot before = AllocationCounter::snapshot();
+        timer.start();
+        const auto result = function();
+        const qint64 elapsed = timer.nsecsElapsed();
+        const AllocationCounter::Snapshot after = AllocationCounter::snapshot();
+        Q_UNUSED(result)
+        if (times.isEmpty()) {
+            measurement.allocations = after.allocations - before.allocations;
+            measurement.allocatedBytes = after.allocatedBytes - before.allocatedBytes;
+        }
+        measurement.peakBytes = qMax(measurement.peakBytes, AllocationCounter::peakBytes());
+        times.append(elapsed);
+        totalNs += elapsed;
+    }
+
+    std::sort(times.begin(), times.end());
+    measurement.iterations = times.size();
+    measurement.minimumNs = times.first();
+    measurement.medianNs = times.at(times.size() / 2);
+    return measurement;
+}
+
+class BenchmarkRunner
+{
+public:
+    BenchmarkRunner(QTextStream *output, QTextStream *log)
+        : m_output(output), m_log(log), m_minIterations(3), m_minTimeNs(500000000), m_verify(false), m_failed(false) {}
+
+    void setMinIterations(int iterations) { m_minIterations = qMax(1, iterations); }
+    void setMinTime(qint64 milliseconds) { m_minTimeNs = qMax<qint64>(0, milliseconds) * 1000000; }
+    void setOperations(const QStringList &operations) { m_operations = operations; }
+    void setVerify(bool verify) { m_verify = verify; }
+
+    void writeRecord(const QJsonObject &record);
+    void runCase(const QString &caseName, const GeoJsonGenerator::Document &document);
+    bool hasFailed() const { return m_failed; }
+    QVector<QJsonObject> results() const { return m_results; }
+
+private:
+    bool isSelected(const QString &operation) const
+    {
+        return m_operations.isEmpty() || m_operations.contains(operation);
+    }
+    bool verify(const QString &caseName, const GeoJsonGenerator::Document &document);
+    void report(const QString &caseName, const QString &operation, qint64 bytes,
+                const GeoJsonGenerator::Document &document, const Measurement &measurement);
+
+    QTextStream *m_output;
+    QTextStream *m_log;
+    QStringList m_operations;
+    int m_minIterations;
+    qint64 m_minTimeNs;
+    bool m_verify;
+    bool m_failed;
+    QVector<QJsonObject> m_results;
+};
+
+void BenchmarkRunner::writeRecord(const QJsonObject &record)
+{
+    // QJsonObject sorts its keys, so the lines of two runs can be compared with diff
+    *m_output << QJsonDocument(record).toJson(QJsonDocument::Compact) << '\n';
+    m_output->flush();
+}
+
+// The direct and QJsonDocument import paths must agree, and an export, text or CBOR, must import back to itself
+bool BenchmarkRunner::verify(const QString &caseName, const GeoJsonGenerator::Document &document)
+{
+    const QVariantMap imported = QGeoJson::importGeoJson(document.text);
+    const QByteArray exported = QGeoJson::exportGeoJsonText(imported);
+    QGeoJson::ExportOptions parallel;
+    parallel.threadCount = 4;
+    QString failure;
+    if (imported.value(QStringLiteral("FeatureCollection")).toList().size() != document.featureCount)
+        failure = QStringLiteral("wrong feature count");
+    else if (QGeoJson::exportGeoJsonText(QGeoJson::importGeoJson(QJsonDocument::fromJson(document.text))) != exported)
+        failure = QStringLiteral("the QJsonDocument import differs from the direct import");
+    else if (QGeoJson::exportGeoJsonText(QGeoJson::importGeoJson(exported)) != exported)
+        failure = QStringLiteral("the exported text does not import back to the same map");
+    else if (QGeoJson::exportGeoJsonText(imported, parallel) != exported)
+        failure = QStringLiteral("the parallel export differs from the serial one");
+    else if (QGeoJson::exportGeoJsonText(QGeoJson::importGeoJsonCbor(QGeoJson::exportGeoJsonCbor(imported).toCbor()))
+             != exported)
+        failure = QStringLiteral("the CBOR encoding does not import back to the same map");
+    if (failure.isEmpty())
+        return true;
+    *m_log << "FAIL " << caseName << ": " << failure << '\n';
+    m_log->flush();
+    m_failed = true;
+    return false;
+}
+
+void BenchmarkRunner::report(const QString &caseName, const QString &operation, qint64 bytes,
+                             const GeoJsonGenerator::Document &document, const Measurement &measurement)
+{
+    const double seconds = measurement.medianNs / 1e9;
+    QJsonObject record;
+    record.insert(QStringLiteral("record"), QStringLiteral("result"));
+    record.insert(QStringLiteral("case"), caseName);
+    record.insert(QStringLiteral("operation"), operation);
+    record.insert(QStringLiteral("bytes"), double(bytes));
+    record.insert(QStringLiteral("vertices"), double(document.vertexCount));
+    record.insert(QStringLiteral("features"), document.featureCount);
+    record.insert(QStringLiteral("iterations"), measurement.iterations);
+    record.insert(QStringLiteral("minimumNs"), double(measurement.minimumNs));
+    record.insert(QStringLiteral("medianNs"), double(measurement.medianNs));
+    record.insert(QStringLiteral("megabytesPerSecond"), seconds > 0 ? bytes / 1e6 / seconds : 0);
+    record.insert(QStringLiteral("verticesPerSecond"), seconds > 0 ? document.vertexCount / seconds : 0);
+    record.insert(QStringLiteral("allocations"), double(measurement.allocations));
+    record.insert(QStringLiteral("allocatedBytes"), double(measurement.allocatedBytes));
+    record.insert(QStringLiteral("peakHeapBytes"), double(measurement.peakBytes));
+    writeRecord(record);
+    m_results.append(record);
+
+    *m_log << QStringLiteral("%1 %2 %3 MB/s %4 Mvertices/s %5 allocations %6 MB peak\n")
+              .arg(caseName, -32).arg(operation, -16)
+              .arg(record.value(QStringLiteral("megabytesPerSecond")).toDouble(), 8, 'f', 1)
+              .arg(record.value(QStringLiteral("verticesPerSecond")).toDouble() / 1e6, 8, 'f', 2)
+              .arg(measurement.allocations, 10)
+              .arg(measurement.peakBytes / 1e6, 8, 'f', 1);
+    m_log->flush();
+}
+
+void BenchmarkRunner::runCase(const QString &caseName, const GeoJsonGenerator::Document &document)
+{
+    if (m_verify && !verify(caseName, document))
+        return;
+
+    const QByteArray &text = document.text;
+    const QVariantMap imported = QGeoJson::importGeoJson(text);
+    const qint64 exportedSize = QGeoJson::exportGeoJsonText(imported).size();
+
+    if (isSelected(QStringLiteral("import"))) {
+        report(caseName, QStringLiteral("import"), text.size(), document,
+               measure([&text]() { return QGeoJson::importGeoJson(text); }, m_minIterations, m_minTimeNs));
+    }
+    if (isSelected(QStringLiteral("import-document"))) {
+        report(caseName, QStringLiteral("import-document"), text.size(), document,
+               measure([&text]() { return QGeoJson::importGeoJson(QJsonDocument::fromJson(text)); },
+                       m_minIterations, m_minTimeNs));
+    }
+    if (isSelected(QStringLiteral("export"))) {
+        report(caseName, QStringLiteral("export"), exportedSize, document,
+               measure([&imported]() { return QGeoJson::exportGeoJsonText(imported); }, m_minIterations, m_minTimeNs));
+    }
+    if (isSelected(QStringLiteral("export-document"))) {
+        report(caseName, QStringLiteral("export-document"), exportedSize, document,
+               measure([&imported]() { return QGeoJson::exportGeoJson(imported).toJson(QJsonDocument::Compact); },
+                       m_minIterations, m_minTimeNs));
+    }
+    if (isSelected(QStringLiteral("roundtrip"))) {
+        report(caseName, QStringLiteral("roundtrip"), text.size(), document,
+               measure([&text]() { return QGeoJson::exportGeoJsonText(QGeoJson::importGeoJson(text)); },
+                       m_minIterations, m_minTimeNs));
+    }
+
+    if (!isSelected(QStringLiteral("cbor-import")) && !isSelected(QStringLiteral("cbor-export"))
+            && !isSelected(QStringLiteral("cbor-roundtrip")))
+        return;
+    const QByteArray cbor = QGeoJson::exportGeoJsonCbor(imported).toCbor();
+    if (isSelected(QStringLiteral("cbor-import"))) {
+        report(caseName, QStringLiteral("cbor-import"), cbor.size(), document,
+               measure([&cbor]() { return QGeoJson::importGeoJsonCbor(cbor); }, m_minIterations, m_minTimeNs));
+    }
+    if (isSelected(QStringLiteral("cbor-export"))) {
+        report(caseName, QStringLiteral("cbor-export"), cbor.size(), document,
+               measure([&imported]() { return QGeoJson::exportGeoJsonCbor(imported).toCbor(); },
+                       m_minIterations, m_minTimeNs));
+    }
+    if (isSelected(QStringLiteral("cbor-roundtrip"))) {
+        report(caseName, QStringLiteral("cbor-roundtrip"), cbor.size(), document,
+               measure([&cbor]() { return QGeoJson::exportGeoJsonCbor(QGeoJson::importGeoJsonCbor(cbor)).toCbor(); },
+                       m_minIterations, m_minTimeNs));
+    }
+}
+
+static QString resultKey(const QJsonObject &record)
+{
+    return record.value(QStringLiteral("case")).toString() + QLatin1Char(' ')
+            + record.value(QStringLiteral("operation")).toString();
+}
+
+// Relative change of the median time and of the allocations against an earlier result file
+static bool compareWithBaseline(const QString &fileName, const QVector<QJsonObject> &results, QTextStream *log)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *log << "cannot read " << fileName << ": " << file.errorString() << '\n';
+        return false;
+    }
+    QHash<QString, QJsonObject> baseline;
+    while (!file.atEnd()) {
+        const QJsonObject record = QJsonDocument::fromJson(file.readLine()).object();
+        if (record.value(QStringLiteral("record")).toString() == QLatin1String("result"))
+            baseline.insert(resultKey(record), record);
+    }
+
+    *log << "\nchange against " << fileName << '\n';
+    for (const QJsonObject &record: results) {
+        const QString key = resultKey(record);
+        if (!baseline.contains(key))
+            continue;
+        const QJsonObject old = baseline.value(key);
+        const double oldTime = old.value(QStringLiteral("medianNs")).toDouble();
+        const double oldAllocations = old.value(QStringLiteral("allocations")).toDouble();
+        const double time = record.value(QStringLiteral("medianNs")).toDouble();
+        const double allocations = record.value(QStringLiteral("allocations")).toDouble();
+        *log << QStringLiteral("%1 %2 % time %3 % allocations\n")
+                .arg(key, -50)
+                .arg(oldTime > 0 ? (time / oldTime - 1) * 100 : 0.0, 7, 'f', 1)
+                .arg(oldAllocations > 0 ? (allocations / oldAllocations - 1) * 100 : 0.0, 7, 'f', 1);
+    }
+    log->flush();
+    return true;
+}
+
+static QStringList optionList(const QString &value)
+{
+    QStringList list;
+    for (const QString &item: value.split(QLatin1Char(','))) {
+        if (!item.trimmed().isEmpty())
+            list.append(item.trimmed());
+    }
+    return list;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("qgeojson_benchmark"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Import and export benchmarks of QGeoJson."));
+    parser.addHelpOption();
+    const QCommandLineOption sizesOption(QStringLiteral("sizes"),
+            QStringLiteral("Comma separated sizes: tiny (100 vertices), small (10k), medium (250k), large (2M), huge (10M)."),
+            QStringLiteral("sizes"), QStringLiteral("tiny,small,medium"));
+    const QCommandLineOption kindsOption(QStringLiteral("kinds"),
+            QStringLiteral("Comma separated feature kinds, all by default."), QStringLiteral("kinds"));
+    const QCommandLineOption operationsOption(QStringLiteral("operations"),
+            QStringLiteral("Comma separated operations: import, import-document, export, export-document, roundtrip, "
+                           "cbor-import, cbor-export, cbor-roundtrip."),
+            QStringLiteral("operations"));
+    const QCommandLineOption iterationsOption(QStringLiteral("iterations"),
+            QStringLiteral("Minimum number of measured runs."), QStringLiteral("count"), QStringLiteral("3"));
+    const QCommandLineOption minTimeOption(QStringLiteral("min-time"),
+            QStringLiteral("Minimum measured time per operation, in milliseconds."), QStringLiteral("ms"),
+            QStringLiteral("500"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"),
+            QStringLiteral("Seed of the generated documents."), QStringLiteral("seed"), QStringLiteral("1"));
+    const QCommandLineOption outputOption(QStringLiteral("output"),
+            QStringLiteral("Write the JSON lines to file instead of the standard output."), QStringLiteral("file"));
+    const QCommandLineOption baselineOption(QStringLiteral("baseline"),
+            QStringLiteral("Compare the results with an earlier output file."), QStringLiteral("file"));
+    const QCommandLineOption verifyOption(QStringLiteral("verify"),
+            QStringLiteral("Check that the import paths agree and that exports import back, fail otherwise."));
+    parser.addOptions({ sizesOption, kindsOption, operationsOption, iterationsOption, minTimeOption, seedOption,
+                        outputOption, baselineOption, verifyOption });
+    parser.process(application);
+
+    QTextStream log(stderr);
+    QFile outputFile;
+    if (parser.isSet(outputOption)) {
+        outputFile.setFileName(parser.value(outputOption));
+        if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            log << "cannot write " << outputFile.fileName() << ": " << outputFile.errorString() << '\n';
+            return 2;
+        }
+    } else if (!outputFile.open(stdout, QIODevice::WriteOnly)) {
+        return 2;
+    }
+    QTextStream output(&outputFile);
+
+    QVector<SizeClass> sizes;
+    for (const QString &name: optionList(parser.value(sizesOption))) {
+        bool found = false;
+        for (const SizeClass &size: sizeClasses) {
+            if (name == QLatin1String(size.name)) {
+                sizes.append(size);
+                found = true;
+            }
+        }
+        if (!found) {
+            log << "unknown size " << name << '\n';
+            return 2;
+        }
+    }
+    const QStringList kinds = optionList(parser.value(kindsOption));
+    const quint64 seed = parser.value(seedOption).toULongLong();
+
+    BenchmarkRunner runner(&output, &log);
+    runner.setMinIterations(parser.value(iterationsOption).toInt());
+    runner.setMinTime(parser.value(minTimeOption).toLongLong());
+    runner.setOperations(optionList(parser.value(operationsOption)));
+    runner.setVerify(parser.isSet(verifyOption));
+
+    QJsonObject meta;
+    meta.insert(QStringLiteral("record"), QStringLiteral("meta"));
+    meta.insert(QStringLiteral("qtVersion"), QString::fromLatin1(qVersion()));
+    meta.insert(QStringLiteral("cpuArchitecture"), QSysInfo::currentCpuArchitecture());
+    meta.insert(QStringLiteral("kernel"), QSysInfo::kernelType() + QLatin1Char(' ') + QSysInfo::kernelVersion());
+    meta.insert(QStringLiteral("idealThreadCount"), QThread::idealThreadCount());
+    meta.insert(QStringLiteral("seed"), QString::number(seed));
+    meta.insert(QStringLiteral("allocationCounting"), AllocationCounter::isAvailable());
+    runner.writeRecord(meta);
+
+    for (const SizeClass &size: qAsConst(sizes)) {
+        for (int kind = 0; kind < GeoJsonGenerator::KindCount; ++kind) {
+            const QString kindName = GeoJsonGenerator::kindName(GeoJsonGenerator::Kind(kind));
+            if (!kinds.isEmpty() && !kinds.contains(kindName))
+                continue;
+            // the same document for a kind and size whatever else is selected
+            GeoJsonGenerator generator(seed + quint64(kind));
+            const GeoJsonGenerator::Document document =
+                    generator.generate(GeoJsonGenerator::Kind(kind), size.vertexCount);
+            runner.runCase(kindName + QLatin1Char('/') + QLatin1String(size.name), document);
+        }
+    }
+
+    QJsonObject process;
+    process.insert(QStringLiteral("record"), QStringLiteral("process"));
+    process.insert(QStringLiteral("peakResidentBytes"), double(AllocationCounter::peakResidentBytes()));
+    runner.writeRecord(process);
+
+    if (parser.isSet(baselineOption) && !compareWithBaseline(parser.value(baselineOption), runner.results(), &log))
+        return 2;
+    return runner.hasFailed() ? 1 : 0;
+}
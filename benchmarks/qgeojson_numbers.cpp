@@ -0,0 +1,292 @@
+#include "qgeojsonnumbers_p.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Checks the number kernels of the UTF-8 import against strtod(), bit for bit, and times
+// them. Each case is a list of deterministic numbers of one shape; the results are written
+// as one JSON object per line, like qgeojson_benchmark does.
+
+namespace {
+
+class Random
+{
+public:
+    explicit Random(quint64 seed) : m_state(seed ? seed : 1) {}
+
+    // xorshift64*, as GeoJsonGenerator
+    quint64 next()
+    {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+        return m_state * Q_UINT64_C(0x2545F4914F6CDD1D);
+    }
+
+    double uniform(double low, double high)
+    {
+        return low + (high - low) * double(next() >> 11) / double(Q_UINT64_C(1) << 53);
+    }
+
+private:
+    quint64 m_state;
+};
+
+enum Case {
+    Coordinates, // longitudes and latitudes with 1 to 15 decimals
+    Shortest, // any double of a normal magnitude, with the 17 digits that identify it
+    Integers, // up to 20 digits, past the 19 of the mantissa
+    LongMantissas, // 20 to 40 significant digits, the slow path
+    Exponents, // scientific notation from 1e-300 to 1e300
+    Limits // subnormals and the largest doubles, at both ends of the table of powers of ten
+};
+static const int CaseCount = Limits + 1;
+
+const char *caseName(int which)
+{
+    static const char *const names[] = { "coordinates", "shortest", "integers", "long-mantissas", "exponents", "limits" };
+    return names[which];
+}
+
+std::string number(Random *random, int which)
+{
+    char text[128];
+    switch (which) {
+    case Coordinates:
+        snprintf(text, sizeof(text), "%.*f", int(1 + random->next() % 15), random->uniform(-180, 180));
+        break;
+    case Shortest:
+    {
+        // a random sign and mantissa, with a binary exponent far from subnormals and infinity
+        const quint64 bits = (random->next() & Q_UINT64_C(0x800FFFFFFFFFFFFF))
+                | (quint64(24 + random->next() % 2000) << 52);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        snprintf(text, sizeof(text), "%.17g", value);
+        break;
+    }
+    case Integers:
+    {
+        const int digits = int(1 + random->next() % 20);
+        std::string integer(1, char('1' + random->next() % 9));
+        for (int i = 1; i < digits; ++i)
+            integer += char('0' + random->next() % 10);
+        return random->next() & 1 ? integer : "-" + integer;
+    }
+    case LongMantissas:
+    {
+        const int digits = int(20 + random->next() % 21);
+        std::string mantissa(1, char('1' + random->next() % 9));
+        mantissa += '.';
+        for (int i = 1; i < digits; ++i)
+            mantissa += char('0' + random->next() % 10);
+        snprintf(text, sizeof(text), "%se%d", mantissa.c_str(), int(random->next() % 601) - 300);
+        break;
+    }
+    case Exponents:
+        snprintf(text, sizeof(text), "%.*fe%d", int(random->next() % 8), random->uniform(1, 10),
+                 int(random->next() % 601) - 300);
+        break;
+    case Limits:
+    {
+        // a binary exponent among the 40 lowest, subnormals included, or the 40 highest
+        const quint64 exponent = random->next() % 80;
+        const quint64 bits = (random->next() & Q_UINT64_C(0x800FFFFFFFFFFFFF))
+                | ((exponent < 40 ? exponent : 2046 - (exponent - 40)) << 52);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        snprintf(text, sizeof(text), "%.17g", value);
+        break;
+    }
+    }
+    return text;
+}
+
+// The numbers of a case, separated by commas as in a JSON array
+struct Numbers
+{
+    std::string text;
+    std::vector<std::string> values;
+};
+
+Numbers generate(int which, int count, quint64 seed)
+{
+    Random random(seed + quint64(which));
+    Numbers numbers;
+    numbers.values.reserve(size_t(count));
+    for (int i = 0; i < count; ++i) {
+        numbers.values.push_back(number(&random, which));
+        numbers.text += numbers.values.back();
+        numbers.text += ',';
+    }
+    return numbers;
+}
+
+// Positions as written by most producers: compact, or indented like QJsonDocument::Indented
+std::string coordinateArray(int count, quint64 seed, bool indented)
+{
+    Random random(seed);
+    std::string text = indented ? "[\n" : "[";
+    char position[128];
+    for (int i = 0; i < count; ++i) {
+        const double x = random.uniform(-180, 180);
+        const double y = random.uniform(-85, 85);
+        if (indented)
+            snprintf(position, sizeof(position), "%s            [\n                %.7f,\n                %.7f\n            ]",
+                     i ? ",\n" : "", x, y);
+        else
+            snprintf(position, sizeof(position), "%s[%.7f,%.7f]", i ? "," : "", x, y);
+        text += position;
+    }
+    text += indented ? "\n]" : "]";
+    return text;
+}
+
+int verify(int which, const Numbers &numbers)
+{
+    int mismatches = 0;
+    for (const std::string &value: numbers.values) {
+        const char *begin = value.c_str();
+        const char *end = begin + value.size();
+        double parsed = 0;
+        const char *parsedEnd = parseJsonNumber(begin, end, &parsed);
+        const char *skippedEnd = skipJsonNumber(begin, end);
+        const double expected = strtod(begin, nullptr);
+        if (parsedEnd != end || skippedEnd != end || memcmp(&parsed, &expected, sizeof(double)) != 0) {
+            if (++mismatches <= 10)
+                fprintf(stderr, "%s: %s parsed as %.17g instead of %.17g\n", caseName(which), begin, parsed, expected);
+        }
+    }
+    return mismatches;
+}
+
+double scanNumbers(const std::string &text, int operation)
+{
+    const char *p = text.c_str();
+    const char *end = p + text.size();
+    double sum = 0;
+    while (p < end) {
+        double value = 0;
+        switch (operation) {
+        case 0:
+            p = parseJsonNumber(p, end, &value);
+            break;
+        case 1:
+            p = skipJsonNumber(p, end);
+            break;
+        default:
+        {
+            char *next;
+            value = strtod(p, &next);
+            p = next;
+            break;
+        }
+        }
+        sum += value;
+        ++p; // ','
+    }
+    return sum;
+}
+
+// The walk of the importer over "coordinates": whitespace, structure and numbers
+double scanCoordinates(const std::string &text)
+{
+    const char *p = text.c_str();
+    const char *end = p + text.size();
+    double sum = 0;
+    while (p < end) {
+        if (isJsonWhitespace(*p)) {
+            p = skipJsonWhitespace(p, end);
+        } else if (*p == '-' || isJsonDigit(*p)) {
+            double value;
+            p = parseJsonNumber(p, end, &value);
+            sum += value;
+        } else {
+            ++p; // '[', ',' or ']'
+        }
+    }
+    return sum;
+}
+
+struct Timing
+{
+    qint64 medianNs;
+    int iterations;
+};
+
+template <typename Function>
+Timing measure(Function function, double minTime)
+{
+    volatile double sink = function(); // warm-up
+    std::vector<qint64> times;
+    const auto start = std::chrono::steady_clock::now();
+    do {
+        const auto begin = std::chrono::steady_clock::now();
+        sink = sink + function();
+        times.push_back(qint64(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - begin).count()));
+    } while (times.size() < 3 || (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < minTime
+                                  && times.size() < 1000));
+    std::sort(times.begin(), times.end());
+    Timing timing;
+    timing.medianNs = times[times.size() / 2];
+    timing.iterations = int(times.size());
+    return timing;
+}
+
+void writeResult(const char *name, const char *operation, size_t bytes, int numbers, const Timing &timing)
+{
+    const double seconds = timing.medianNs / 1e9;
+    printf("{\"record\":\"result\",\"case\":\"%s\",\"operation\":\"%s\",\"bytes\":%zu,\"numbers\":%d,"
+           "\"iterations\":%d,\"medianNs\":%lld,\"megabytesPerSecond\":%.1f,\"numbersPerSecond\":%.0f}\n",
+           name, operation, bytes, numbers, timing.iterations, static_cast<long long>(timing.medianNs),
+           seconds > 0 ? bytes / 1e6 / seconds : 0, seconds > 0 ? numbers / seconds : 0);
+    fprintf(stderr, "%-16s %-8s %9.1f MB/s %8.2f M numbers/s\n", name, operation,
+            seconds > 0 ? bytes / 1e6 / seconds : 0, seconds > 0 ? numbers / seconds / 1e6 : 0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int count = 1000000;
+    double minTime = 0.5;
+    quint64 seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--count"))
+            count = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--min-time"))
+            minTime = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--seed"))
+            seed = strtoull(argv[i + 1], nullptr, 10);
+    }
+
+    int mismatches = 0;
+    for (int which = 0; which < CaseCount; ++which) {
+        const Numbers numbers = generate(which, count, seed);
+        const int caseMismatches = verify(which, numbers);
+        printf("{\"record\":\"verify\",\"case\":\"%s\",\"numbers\":%d,\"mismatches\":%d}\n",
+               caseName(which), count, caseMismatches);
+        mismatches += caseMismatches;
+
+        const char *const operations[] = { "parse", "skip", "strtod" };
+        for (int operation = 0; operation < 3; ++operation) {
+            const Timing timing = measure([&]() { return scanNumbers(numbers.text, operation); }, minTime);
+            writeResult(caseName(which), operations[operation], numbers.text.size(), count, timing);
+        }
+    }
+
+    for (int indented = 0; indented < 2; ++indented) {
+        const std::string text = coordinateArray(count / 2, seed, indented);
+        const Timing timing = measure([&]() { return scanCoordinates(text); }, minTime);
+        writeResult(indented ? "positions-indented" : "positions", "scan", text.size(), count / 2 * 2, timing);
+    }
+
+    return mismatches ? 1 : 0;
+}
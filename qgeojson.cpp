@@ -1,12 +1,37 @@
 #include "qgeojson_p.h"
+#include "qgeojsonnumbers_p.h"
 #include <qjsonobject.h>
 #include <qjsonvalue.h>
 #include <qjsonarray.h>
+#include <qcborvalue.h>
+#include <qcborarray.h>
+#include <qcbormap.h>
 #include <qgeocoordinate.h>
 #include <qgeocircle.h>
 #include <qgeopath.h>
 #include <qgeopolygon.h>
+#include <qgeorectangle.h>
+#include <qiodevice.h>
+#include <qfile.h>
+#include <qsavefile.h>
+#include <qlocale.h>
+#include <qmath.h>
+#include <qalgorithms.h>
+#include <qendian.h>
+#include <qthread.h>
+#include <qthreadpool.h>
+#include <qatomic.h>
+#include <qfutureinterface.h>
+#include <qrunnable.h>
 #include <qdebug.h>
+#include <qelapsedtimer.h>
+#include <qloggingcategory.h>
+#include <private/qsimd_p.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
 QT_BEGIN_NAMESPACE
 
 /*! \class QGeoJson
@@ -133,6 +158,181 @@ static QList<QList<QGeoCoordinate>> importPolygonCoordinates(const QVariant &obt
     return parsedCoordinatesPoly;
 }
 
+// Simplification of the imported geometries, see QGeoJson::ImportOptions::simplification
+
+/*
+    Reduces the vertex count of the coordinate lists of paths and polygon rings, before the
+    importers build QGeoPath and QGeoPolygon objects from them. Coordinates are compared as
+    planar degrees, the first and last positions are always
+    kept so closed rings stay closed, and a ring which would be left with fewer than four
+    positions is kept as it was rather than collapsing. Points are never touched.
+*/
+class GeoJsonSimplifier
+{
+public:
+    GeoJsonSimplifier(QGeoJson::Simplification method, double tolerance)
+        : m_method(tolerance > 0 ? method : QGeoJson::NoSimplification), m_tolerance(tolerance) {}
+
+    bool isActive() const { return m_method != QGeoJson::NoSimplification; }
+
+    QList<QGeoCoordinate> simplifyLine(const QList<QGeoCoordinate> &line) const;
+    QList<QGeoCoordinate> simplifyRing(const QList<QGeoCoordinate> &ring) const;
+    void simplifyLines(QList<QList<QGeoCoordinate>> *lines) const;
+    void simplifyRings(QList<QList<QGeoCoordinate>> *rings) const;
+
+private:
+    void markDouglasPeucker(const QVector<double> &x, const QVector<double> &y, QVector<bool> *keep) const;
+    void markVisvalingamWhyatt(const QVector<double> &x, const QVector<double> &y, QVector<bool> *keep) const;
+
+    QGeoJson::Simplification m_method;
+    double m_tolerance;
+};
+
+static inline double segmentDistanceSquared(double px, double py, double ax, double ay, double bx, double by)
+{
+    const double dx = bx - ax;
+    const double dy = by - ay;
+    const double lengthSquared = dx * dx + dy * dy;
+    double t = 0;
+    if (lengthSquared > 0)
+        t = qBound(0.0, ((px - ax) * dx + (py - ay) * dy) / lengthSquared, 1.0);
+    const double ex = px - (ax + t * dx);
+    const double ey = py - (ay + t * dy);
+    return ex * ex + ey * ey;
+}
+
+static inline double triangleArea(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    return qAbs((bx - ax) * (cy - ay) - (cx - ax) * (by - ay)) * 0.5;
+}
+
+void GeoJsonSimplifier::markDouglasPeucker(const QVector<double> &x, const QVector<double> &y,
+                                           QVector<bool> *keep) const
+{
+    // Iterative, so that very long rings cannot exhaust the stack
+    const double toleranceSquared = m_tolerance * m_tolerance;
+    QVector<QPair<int, int>> ranges;
+    ranges.append(qMakePair(0, x.size() - 1));
+    while (!ranges.isEmpty()) {
+        const QPair<int, int> range = ranges.takeLast();
+        const int first = range.first;
+        const int last = range.second;
+        double maxDistance = 0;
+        int farthest = -1;
+        for (int i = first + 1; i < last; ++i) {
+            const double distance = segmentDistanceSquared(x[i], y[i], x[first], y[first], x[last], y[last]);
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                farthest = i;
+            }
+        }
+        if (farthest < 0 || maxDistance <= toleranceSquared)
+            continue;
+        (*keep)[farthest] = true;
+        ranges.append(qMakePair(first, farthest));
+        ranges.append(qMakePair(farthest, last));
+    }
+}
+
+void GeoJsonSimplifier::markVisvalingamWhyatt(const QVector<double> &x, const QVector<double> &y,
+                                              QVector<bool> *keep) const
+{
+    // Removes the vertex of the smallest effective area until all remaining ones reach the
+    // threshold; stale heap entries are recognized by their area no longer matching.
+    const double threshold = m_tolerance * m_tolerance;
+    const int count = x.size();
+    QVector<int> previous(count);
+    QVector<int> next(count);
+    QVector<double> area(count, std::numeric_limits<double>::infinity());
+    typedef QPair<double, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    for (int i = 0; i < count; ++i) {
+        previous[i] = i - 1;
+        next[i] = i + 1;
+        (*keep)[i] = true;
+    }
+    for (int i = 1; i < count - 1; ++i) {
+        area[i] = triangleArea(x[i - 1], y[i - 1], x[i], y[i], x[i + 1], y[i + 1]);
+        heap.push(Entry(area[i], i));
+    }
+
+    while (!heap.empty()) {
+        const Entry entry = heap.top();
+        heap.pop();
+        const int i = entry.second;
+        if (!(*keep)[i] || entry.first != area[i])
+            continue;
+        if (entry.first >= threshold)
+            break;
+        (*keep)[i] = false;
+        const int p = previous[i];
+        const int n = next[i];
+        next[p] = n;
+        previous[n] = p;
+        if (p > 0) {
+            area[p] = triangleArea(x[previous[p]], y[previous[p]], x[p], y[p], x[n], y[n]);
+            heap.push(Entry(area[p], p));
+        }
+        if (n < count - 1) {
+            area[n] = triangleArea(x[p], y[p], x[n], y[n], x[next[n]], y[next[n]]);
+            heap.push(Entry(area[n], n));
+        }
+    }
+}
+
+QList<QGeoCoordinate> GeoJsonSimplifier::simplifyLine(const QList<QGeoCoordinate> &line) const
+{
+    const int count = line.size();
+    if (count < 3 || !isActive())
+        return line;
+
+    QVector<double> x(count);
+    QVector<double> y(count);
+    for (int i = 0; i < count; ++i) {
+        const QGeoCoordinate &coordinate = line.at(i);
+        x[i] = coordinate.longitude();
+        y[i] = coordinate.latitude();
+    }
+
+    QVector<bool> keep(count, false);
+    if (m_method == QGeoJson::DouglasPeucker)
+        markDouglasPeucker(x, y, &keep);
+    else
+        markVisvalingamWhyatt(x, y, &keep);
+    keep[0] = true;
+    keep[count - 1] = true;
+
+    QList<QGeoCoordinate> simplified;
+    for (int i = 0; i < count; ++i) {
+        if (keep.at(i))
+            simplified.append(line.at(i));
+    }
+    return simplified;
+}
+
+QList<QGeoCoordinate> GeoJsonSimplifier::simplifyRing(const QList<QGeoCoordinate> &ring) const
+{
+    // A closed ring needs three distinct positions plus the closing one
+    const QList<QGeoCoordinate> simplified = simplifyLine(ring);
+    return simplified.size() < 4 ? ring : simplified;
+}
+
+void GeoJsonSimplifier::simplifyLines(QList<QList<QGeoCoordinate>> *lines) const
+{
+    if (!isActive())
+        return;
+    for (QList<QGeoCoordinate> &line: *lines)
+        line = simplifyLine(line);
+}
+
+void GeoJsonSimplifier::simplifyRings(QList<QList<QGeoCoordinate>> *rings) const
+{
+    if (!isActive())
+        return;
+    for (QList<QGeoCoordinate> &ring: *rings)
+        ring = simplifyRing(ring);
+}
+
 static QGeoCircle importPoint(const QVariantMap &pointMap)
 {
     QGeoCircle parsedPoint;
@@ -146,7 +346,7 @@ static QGeoCircle importPoint(const QVariantMap &pointMap)
     return parsedPoint;
 }
 
-static QGeoPath importLineString(const QVariantMap &lineMap)
+static QGeoPath importLineString(const QVariantMap &lineMap, const GeoJsonSimplifier *simplifier = nullptr)
 {
     QGeoPath parsedLineString;
 
@@ -155,23 +355,19 @@ static QGeoPath importLineString(const QVariantMap &lineMap)
     QList <QGeoCoordinate> coordinatesList;
     QVariant valueCoordinates = lineMap.value(keyCoord); // returns the value associated with the key coordinates (LineString)
     coordinatesList = importLineStringCoordinates(valueCoordinates); // import an array of QGeoCoordinate from a nested GeoJSON array
+    if (simplifier)
+        coordinatesList = simplifier->simplifyLine(coordinatesList);
     parsedLineString.setPath(coordinatesList);
     return parsedLineString;
 }
 
-static QGeoPolygon importPolygon(const QVariantMap &polyMap)
+static QGeoPolygon importPolygonPerimeters(const QList<QList<QGeoCoordinate>> &perimeters)
 {
     QGeoPolygon parsedPolygon;
 
     int i = 0; // meant to bypass the lack of iterator position tracking
 
-    QString keyCoord = QStringLiteral("coordinates");
-
-    QList<QList<QGeoCoordinate>> perimeters;
-    QList<QList<QGeoCoordinate>> ::iterator iter;
-    QVariant valueCoordinates = polyMap.value(keyCoord); // returns the value associated with the key coordinates (Polygon)
-    perimeters = importPolygonCoordinates(valueCoordinates); // import an array of QList<QGeocoordinates>
-
+    QList<QList<QGeoCoordinate>>::const_iterator iter;
     for (iter = perimeters.begin(); iter != perimeters.end(); ++iter) {
         if (i == 0)
             parsedPolygon.setPath(*iter); // external perimeter
@@ -182,60 +378,70 @@ static QGeoPolygon importPolygon(const QVariantMap &polyMap)
     return parsedPolygon;
 }
 
-static QVariantList importMultiPoint(const QVariantMap &multiPointMap)
+static QGeoPolygon importPolygon(const QVariantMap &polyMap, const GeoJsonSimplifier *simplifier = nullptr)
 {
-    QVariantList parsedMultiPoint;
-
     QString keyCoord = QStringLiteral("coordinates");
 
+    QList<QList<QGeoCoordinate>> perimeters;
+    QVariant valueCoordinates = polyMap.value(keyCoord); // returns the value associated with the key coordinates (Polygon)
+    perimeters = importPolygonCoordinates(valueCoordinates); // import an array of QList<QGeocoordinates>
+    if (simplifier)
+        simplifier->simplifyRings(&perimeters);
+    return importPolygonPerimeters(perimeters);
+}
+
+static QVariantList importMultiPointCoordinates(const QList<QGeoCoordinate> &centers)
+{
+    QVariantList parsedMultiPoint;
     QGeoCircle parsedPoint;
-    QGeoCoordinate coordinatesCenter;
 
-    QVariant listCoords = multiPointMap.value(keyCoord);
-    QVariantList list = listCoords.value<QVariantList>();
-    QVariantList::iterator iter; // iterating MultiPoint coordinates nasted arrays
-    for (iter = list.begin(); iter != list.end(); ++iter) {
-        coordinatesCenter = importPointCoordinates(*iter);
+    for (const QGeoCoordinate &coordinatesCenter: centers) {
         parsedPoint.setCenter(coordinatesCenter);
         parsedMultiPoint.append(QVariant::fromValue(parsedPoint)); // adding the newly created QGeoCircle to the dastination QVariantList
     }
     return parsedMultiPoint;
 }
 
-static QVariantList importMultiLineString(const QVariantMap &multiLineStringMap)
+static QVariantList importMultiPoint(const QVariantMap &multiPointMap)
 {
-    QVariantList parsedMultiLineString;
-    QList <QGeoCoordinate> coordinatesList;
-    QGeoPath parsedLineString;
-
     QString keyCoord = QStringLiteral("coordinates");
 
+    QVariant listCoords = multiPointMap.value(keyCoord);
+    return importMultiPointCoordinates(importLineStringCoordinates(listCoords));
+}
 
-    QVariant listCoords = multiLineStringMap.value(keyCoord);
-    QVariantList list = listCoords.value<QVariantList>();
+static QVariantList importMultiLineStringCoordinates(const QList<QList<QGeoCoordinate>> &paths)
+{
+    QVariantList parsedMultiLineString;
+    QGeoPath parsedLineString;
 
-    QVariantList::iterator iter; // iterating the MultiLineString coordinates nasted arrays using importLineStringCoordinates
-    for (iter = list.begin(); iter != list.end(); ++iter) {
-        coordinatesList = importLineStringCoordinates(*iter);
+    for (const QList<QGeoCoordinate> &coordinatesList: paths) {
         parsedLineString.setPath(coordinatesList);
         parsedMultiLineString.append(QVariant::fromValue(parsedLineString));
     }
     return parsedMultiLineString;
 }
 
-static QVariantList importMultiPolygon(const QVariantMap &multiPolyMap)
+static QVariantList importMultiLineString(const QVariantMap &multiLineStringMap,
+                                          const GeoJsonSimplifier *simplifier = nullptr)
 {
-    QVariantList parsedMultiPoly;
     QString keyCoord = QStringLiteral("coordinates");
 
-    QList<QList<QGeoCoordinate>> coordinatesList;
-    QList<QList<QGeoCoordinate>>::iterator iter;
+    QVariant listCoords = multiLineStringMap.value(keyCoord);
+    QList<QList<QGeoCoordinate>> paths = importPolygonCoordinates(listCoords); // a MultiLineString nests like the rings of a Polygon
+    if (simplifier)
+        simplifier->simplifyLines(&paths);
+    return importMultiLineStringCoordinates(paths);
+}
+
+static QVariantList importMultiPolygonCoordinates(const QList<QList<QList<QGeoCoordinate>>> &polygons)
+{
+    QVariantList parsedMultiPoly;
+
+    QList<QList<QGeoCoordinate>>::const_iterator iter;
     QGeoPolygon singlePoly;
-    QVariant valueCoordinates = multiPolyMap.value(keyCoord);
 
-    QVariantList list = valueCoordinates.value<QVariantList>();
-    for (const QVariant &polyVariantCoords: list) {
-        coordinatesList = importPolygonCoordinates(polyVariantCoords);
+    for (const QList<QList<QGeoCoordinate>> &coordinatesList: polygons) {
         for (iter = coordinatesList.begin(); iter != coordinatesList.end(); ++iter) {
             if (coordinatesList.indexOf(*iter) == 0)
                 singlePoly.setPath(*iter);
@@ -247,9 +453,26 @@ static QVariantList importMultiPolygon(const QVariantMap &multiPolyMap)
     return parsedMultiPoly;
 }
 
-static QVariantMap importGeometry(const QVariantMap &geometryMap);
+static QVariantList importMultiPolygon(const QVariantMap &multiPolyMap, const GeoJsonSimplifier *simplifier = nullptr)
+{
+    QString keyCoord = QStringLiteral("coordinates");
+
+    QList<QList<QList<QGeoCoordinate>>> polygons;
+    QVariant valueCoordinates = multiPolyMap.value(keyCoord);
+
+    QVariantList list = valueCoordinates.value<QVariantList>();
+    for (const QVariant &polyVariantCoords: list) {
+        polygons << importPolygonCoordinates(polyVariantCoords);
+        if (simplifier)
+            simplifier->simplifyRings(&polygons.last());
+    }
+    return importMultiPolygonCoordinates(polygons);
+}
+
+static QVariantMap importGeometry(const QVariantMap &geometryMap, const GeoJsonSimplifier *simplifier = nullptr);
 
-static QVariantList importGeometryCollection(const QVariantMap &geometryCollection)
+static QVariantList importGeometryCollection(const QVariantMap &geometryCollection,
+                                             const GeoJsonSimplifier *simplifier = nullptr)
 {
     QVariantList parsedGeoCollection;
 
@@ -260,13 +483,13 @@ static QVariantList importGeometryCollection(const QVariantMap &geometryCollecti
     QVariantList::iterator iterGeometries;
     for (iterGeometries = list.begin(); iterGeometries != list.end(); ++ iterGeometries) {
         QVariantMap geometryMap = iterGeometries->value<QVariantMap>();
-        QVariantMap geoMap = importGeometry(geometryMap);
+        QVariantMap geoMap = importGeometry(geometryMap, simplifier);
         parsedGeoCollection.append(geoMap);
     }
     return parsedGeoCollection;
 }
 
-static QVariantMap importGeometry(const QVariantMap &geometryMap)
+static QVariantMap importGeometry(const QVariantMap &geometryMap, const GeoJsonSimplifier *simplifier)
 {
     QVariantMap parsedGeoJsonMap;
     QString geometryTypes[] = {
@@ -321,7 +544,7 @@ static QVariantMap importGeometry(const QVariantMap &geometryMap)
     case LineString:
     {
         const QString geoKey = QStringLiteral("LineString");
-        QGeoPath lineString = importLineString(geometryMap);
+        QGeoPath lineString = importLineString(geometryMap, simplifier);
         QVariant geoValue = QVariant::fromValue(lineString);
         parsedGeoJsonMap.insert(geoKey, geoValue);
         break;
@@ -329,7 +552,7 @@ static QVariantMap importGeometry(const QVariantMap &geometryMap)
     case MultiLineString:
     {
         const QString geoKey = QStringLiteral("MultiLineString");
-        QVariantList multiLineString = importMultiLineString(geometryMap);
+        QVariantList multiLineString = importMultiLineString(geometryMap, simplifier);
         QVariant geoValue = QVariant::fromValue(multiLineString);
         parsedGeoJsonMap.insert(geoKey, geoValue);
         break;
@@ -337,7 +560,7 @@ static QVariantMap importGeometry(const QVariantMap &geometryMap)
     case Polygon:
     {
         const QString geoKey = QStringLiteral("Polygon");
-        QGeoPolygon poly = importPolygon(geometryMap);
+        QGeoPolygon poly = importPolygon(geometryMap, simplifier);
         QVariant geoValue = QVariant::fromValue(poly);
         parsedGeoJsonMap.insert(geoKey, geoValue);
         break;
@@ -345,7 +568,7 @@ static QVariantMap importGeometry(const QVariantMap &geometryMap)
     case MultiPolygon:
     {
         const QString geoKey = QStringLiteral("MultiPolygon");
-        QVariantList multiPoly = importMultiPolygon(geometryMap);
+        QVariantList multiPoly = importMultiPolygon(geometryMap, simplifier);
         QVariant geoValue = QVariant::fromValue(multiPoly);
         parsedGeoJsonMap.insert(geoKey, geoValue);
         break;
@@ -353,7 +576,7 @@ static QVariantMap importGeometry(const QVariantMap &geometryMap)
     case GeometryCollection: // list of GeoJson geometry objects
     {
         const QString geoKey = QStringLiteral("GeometryCollection");
-        QVariantList multigeo = importGeometryCollection(geometryMap);
+        QVariantList multigeo = importGeometryCollection(geometryMap, simplifier);
         QVariant geoValue = QVariant::fromValue(multigeo);
         parsedGeoJsonMap.insert(geoKey, geoValue);
         break;
@@ -362,14 +585,14 @@ static QVariantMap importGeometry(const QVariantMap &geometryMap)
     return parsedGeoJsonMap;
 }
 
-static QVariantMap importFeature(const QVariantMap &feature)
+static QVariantMap importFeature(const QVariantMap &feature, const GeoJsonSimplifier *simplifier = nullptr)
 {
     QVariantMap parsedFeature;
     QString key = QStringLiteral("geometry");
     QVariant featureGeometry = feature.value(key); // Importing GeoJson "geometry" member from the QVariantMap
 
     QVariantMap mapGeometry = featureGeometry.value<QVariantMap>();
-    QVariantMap geoMap = importGeometry(mapGeometry);
+    QVariantMap geoMap = importGeometry(mapGeometry, simplifier);
 
     QVariant variantValue = QVariant::fromValue(geoMap);
     parsedFeature.insert(key, variantValue);
@@ -386,7 +609,8 @@ static QVariantMap importFeature(const QVariantMap &feature)
     return parsedFeature;
 }
 
-static QVariantList importFeatureCollection(const QVariantMap &featureCollection)
+static QVariantList importFeatureCollection(const QVariantMap &featureCollection,
+                                            const GeoJsonSimplifier *simplifier = nullptr)
 {
     QVariantList parsedFeatureCollection;
     QString keyFeatures = QStringLiteral("features");
@@ -397,525 +621,8351 @@ static QVariantList importFeatureCollection(const QVariantMap &featureCollection
     QVariantMap importedMap;
     for (const QVariant &singleVariantFeature: featureVariantList) {
         QVariantMap featureMap = singleVariantFeature.value<QVariantMap>();
-        QVariantMap featMap = importFeature(featureMap);
+        QVariantMap featMap = importFeature(featureMap, simplifier);
         importedMap.insert(keyFeature,featMap);
         parsedFeatureCollection.append(importedMap);
     }
     return parsedFeatureCollection;
 }
 
-static QJsonValue exportPointCoordinates(const QGeoCoordinate &obtainedCoordinates)
-{
-    QJsonValue geoLat = obtainedCoordinates.latitude();
-    QJsonValue geoLong = obtainedCoordinates.longitude();
-
-    QJsonArray array = {geoLat, geoLong};
-    QJsonValue geoAlt;
-
-    if (!qIsNaN(obtainedCoordinates.altitude())) {
-        geoAlt = obtainedCoordinates.altitude();
-        array.append(geoAlt);
-    }
-    QJsonValue geoArray = array;
-    return geoArray;
-}
-
-static QJsonValue exportLineStringCoordinates(const QList<QGeoCoordinate> &obtainedCoordinatesList)
+// Direct UTF-8 import, bypassing QJsonDocument and QJsonObject::toVariantMap()
+
+static const char *const geoJsonTypeNames[] = {
+    "Point",
+    "MultiPoint",
+    "LineString",
+    "MultiLineString",
+    "Polygon",
+    "MultiPolygon",
+    "GeometryCollection",
+    "Feature",
+    "FeatureCollection"
+};
+
+static void appendUtf8(QByteArray *utf8, uint code)
 {
-    QJsonValue lineCoordinates;
-    QJsonValue multiPosition;
-    QJsonArray arrayPosition;
-
-    for (const QGeoCoordinate &pointCoordinates: obtainedCoordinatesList) {
-        multiPosition = exportPointCoordinates(pointCoordinates);
-        arrayPosition.append(multiPosition);
+    if (QChar::isHighSurrogate(code) || QChar::isLowSurrogate(code))
+        code = 0xfffd; // unpaired surrogate
+    if (code < 0x80) {
+        utf8->append(char(code));
+    } else if (code < 0x800) {
+        utf8->append(char(0xc0 | (code >> 6)));
+        utf8->append(char(0x80 | (code & 0x3f)));
+    } else if (code < 0x10000) {
+        utf8->append(char(0xe0 | (code >> 12)));
+        utf8->append(char(0x80 | ((code >> 6) & 0x3f)));
+        utf8->append(char(0x80 | (code & 0x3f)));
+    } else {
+        utf8->append(char(0xf0 | (code >> 18)));
+        utf8->append(char(0x80 | ((code >> 12) & 0x3f)));
+        utf8->append(char(0x80 | ((code >> 6) & 0x3f)));
+        utf8->append(char(0x80 | (code & 0x3f)));
     }
-    lineCoordinates = arrayPosition;
-    return lineCoordinates;
 }
 
-static QJsonValue exportPolygonCoordinates(const QList<QList<QGeoCoordinate>> &obtainedCoordinates)
+static bool parseHex4(const char *p, const char *end, uint *code)
 {
-    QJsonValue lineCoordinates;
-    QJsonValue polyCoordinates;
-    QJsonArray arrayPath;
-    for (const QList<QGeoCoordinate> &parsedPath: obtainedCoordinates) {
-        lineCoordinates = exportLineStringCoordinates(parsedPath);
-        arrayPath.append(lineCoordinates);
+    if (end - p < 4)
+        return false;
+    uint value = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char c = p[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9')
+            value |= uint(c - '0');
+        else if (c >= 'a' && c <= 'f')
+            value |= uint(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F')
+            value |= uint(c - 'A' + 10);
+        else
+            return false;
     }
-    polyCoordinates = arrayPath;
-    return polyCoordinates;
+    *code = value;
+    return true;
 }
 
-static QJsonObject exportPoint(const QVariantMap &pointMap)
+class GeoJsonMemoryBudget;
+struct GeoJsonExtent;
+class GeoJsonRegionFilter;
+
+/*
+    Recursive descent parser reading GeoJSON text straight into the map layout produced by
+    QGeoJson::importGeoJson(). Members meaningful to GeoJSON are interpreted while parsing,
+    coordinates are decoded directly into QGeoCoordinate lists when the "type" member
+    precedes them, everything else is skipped without being converted. Values which do not
+    have the expected shape are handed to the QVariantMap based importers, so the output
+    is the same as the one of the QJsonDocument code path.
+*/
+class GeoJsonTextParser
 {
-    QJsonObject parsedPoint;
+public:
+    GeoJsonTextParser(const char *begin, const char *end);
+
+    QVariantMap parseDocument(); // importGeoJson() layout
+    QVariantMap parseFeature(); // importFeature() layout
+    bool parseStore(QGeoJsonGeometryStore *store); // importGeometryStore() content
+    QVariantMap parseGeometry(); // importGeometry() layout
+    bool scanFeatures(QGeoJsonGeometryStore::DocumentType *type, QVector<int> *ranges,
+                      QVariant *bbox); // importLazy() content
+    QVariant parseJsonValue(); // a single JSON value, as QJsonValue::toVariant()
+    bool atEnd() { skipWhitespace(); return m_pos == m_end; } // nothing but whitespace left
+
+    QJsonParseError::ParseError error() const { return m_error; }
+    int errorOffset() const { return int(m_errorPos - m_begin); }
+
+    void setSimplifier(const GeoJsonSimplifier *simplifier) { m_simplifier = simplifier; }
+    // called by scanFeatures() with the bytes scanned so far, the scan stops when it returns false
+    void setScanProgress(const std::function<bool(int)> &progress) { m_scanProgress = progress; }
+    // charged by parseDocument() as the values are built, which stops once it is exceeded
+    void setMemoryBudget(GeoJsonMemoryBudget *budget) { m_budget = budget; }
+    bool isBudgetExceeded() const { return m_budgetExceeded; }
+    // leaves the features outside of it out of the "features" lists, without building them
+    void setFilter(const GeoJsonRegionFilter *filter) { m_filter = filter; }
+
+private:
+    enum ObjectType {
+        UnknownType = -1,
+        Point,
+        MultiPoint,
+        LineString,
+        MultiLineString,
+        Polygon,
+        MultiPolygon,
+        GeometryCollection,
+        Feature,
+        FeatureCollection
+    };
 
-    QString keyType = QStringLiteral("type");
-    QString keyCoord = QStringLiteral("coordinates");
-    QString valuePoint = QStringLiteral("Point");
+    enum Member {
+        OtherMember,
+        TypeMember,
+        CoordinatesMember,
+        GeometriesMember,
+        GeometryMember,
+        FeaturesMember,
+        PropertiesMember,
+        IdMember,
+        BboxMember
+    };
 
-    QVariant geoCircle = pointMap.value(valuePoint); // exporting the value of "Point" QVariantMap node in a QVariant
-    QGeoCircle circle = geoCircle.value<QGeoCircle>();
-    QGeoCoordinate center = circle.center();
-    QJsonValue valueType = valuePoint;
+    // What scanStoreObject() imports into the store while it locates the members of an object
+    enum StoreScan {
+        ScanSpans = 0x0, // nothing, the members are only located
+        ScanGeometries = 0x1, // "coordinates" and "geometries"
+        ScanGeometry = 0x2, // "geometry"
+        ScanFeatures = 0x4, // "features"
+        ScanDocument = ScanGeometries | ScanGeometry | ScanFeatures
+    };
 
-    parsedPoint.insert(keyType,valueType);
-    parsedPoint.insert(keyCoord, exportPointCoordinates(center));
-    return parsedPoint;
-}
+    enum StoreMember {
+        StoreCoordinates = 0x1,
+        StoreGeometries = 0x2,
+        StoreGeometry = 0x4,
+        StoreFeatures = 0x8
+    };
 
-static QJsonObject exportLineString(const QVariantMap &lineStringMap)
-{
-    QJsonObject parsedMultiPoint;
+    // Where the members of an object start, and which of them are already imported
+    struct StoreSpans
+    {
+        StoreSpans()
+            : type(UnknownType), coordinates(nullptr), geometries(nullptr), geometry(nullptr),
+              geometryEnd(nullptr), features(nullptr), properties(nullptr), propertiesEnd(nullptr), id(nullptr), idEnd(nullptr),
+              bbox(nullptr), written(0), imported(0), firstGeometry(0), firstFeature(0), childCount(0),
+              shapeBegin(0), valueBegin(0) {}
+
+        ObjectType type;
+        const char *coordinates;
+        const char *geometries;
+        const char *geometry;
+        const char *geometryEnd;
+        const char *features;
+        const char *properties;
+        const char *propertiesEnd;
+        const char *id;
+        const char *idEnd;
+        const char *bbox;
+
+        int written; // StoreMember flags of the members which added to the store
+        int imported; // StoreMember flags of the members whose last occurrence is imported
+        int firstGeometry; // in the store when the object was reached
+        int firstFeature;
+        int childCount; // elements of "geometries"
+        int shapeBegin; // coordinate tokens of "coordinates"
+        int valueBegin;
+    };
 
-    QString keyType = QStringLiteral("type");
-    QString keyCoord = QStringLiteral("coordinates");
+    // "coordinates" read before the geometry type is known: the structure of the value,
+    // and its numbers already converted
+    enum CoordinateToken : quint8 {
+        ArrayBeginToken,
+        ArrayEndToken,
+        NumberToken,
+        OtherToken // any other value, imported as 0 or as an empty array
+    };
 
-    QString valueLineString = QStringLiteral("LineString");
+    struct GeoJsonObject
+    {
+        GeoJsonObject() : type(UnknownType), coordinatesType(UnknownType), hasGeometry(false) {}
+
+        ObjectType type;
+        ObjectType coordinatesType; // when known, coordinates holds the imported geometry value
+        QVariant coordinates;
+        QVariantList geometries;
+        QVariantMap geometry;
+        bool hasGeometry;
+        QVariantList features;
+        QVariant properties;
+        QVariant id;
+        QVariant bbox;
+    };
 
-    QJsonValue lineCoordinates;
+    static const int MaxDepth = 1024;
+    static const int ScanProgressBytes = 1 << 20; // between two calls of the scan progress
+
+    QVariantMap geometryMap(const GeoJsonObject &object) const;
+    QVariantMap featureMap(const GeoJsonObject &object) const;
+    QVariantMap documentMap(const GeoJsonObject &object) const;
+    QVariant geometryValue(const GeoJsonObject &object, ObjectType type) const;
+
+    bool chargeBudget(const QVariant &value, qint64 charged);
+    bool chargeListElement(const QVariant &element, qint64 charged);
+
+    bool parseObject(GeoJsonObject *object);
+    bool parseType(ObjectType *type);
+    bool parseMember(GeoJsonObject *object, Member member);
+    bool parseObjectList(QVariantList *list, Member member);
+    bool parseListElement(QVariantList *list, Member member);
+    bool skipFilteredFeature(bool *skipped);
+    bool scanFeatureExtent(GeoJsonExtent *extent);
+    bool scanGeometryExtent(GeoJsonExtent *extent);
+    bool scanGeometryListExtent(GeoJsonExtent *extent);
+    bool scanCoordinatesExtent(GeoJsonExtent *extent);
+    bool parseCoordinates(GeoJsonObject *object);
+    bool parseTypedCoordinates(ObjectType type, QVariant *value);
+
+    bool parsePosition(QGeoCoordinate *coordinate);
+    bool parsePositions(QList<QGeoCoordinate> *positions);
+    bool parseRings(QList<QList<QGeoCoordinate>> *rings);
+    bool parsePolygons(QList<QList<QList<QGeoCoordinate>>> *polygons);
+    template <typename T>
+    bool parseCoordinateArray(QList<T> *list, bool (GeoJsonTextParser::*parseElement)(T *));
+
+    typedef void (GeoJsonTextParser::*StoreElementParser)(QGeoJsonGeometryStore *store);
+    bool scanStoreObject(StoreSpans *spans, QGeoJsonGeometryStore *store = nullptr, int scan = ScanSpans);
+    bool scanStoreMember(StoreSpans *spans, QGeoJsonGeometryStore *store, int scan, Member member);
+    bool scanStoreGeometry(QGeoJsonGeometryStore *store);
+    bool scanStoreFeature(QGeoJsonGeometryStore *store);
+    bool scanStoreList(QGeoJsonGeometryStore *store, bool (GeoJsonTextParser::*scanElement)(QGeoJsonGeometryStore *),
+                       int *count);
+    bool scanCoordinateTokens();
+    bool storeGeometry(QGeoJsonGeometryStore *store, StoreSpans *spans);
+    void storeCoordinates(QGeoJsonGeometryStore *store, ObjectType type);
+    void storeArray(QGeoJsonGeometryStore *store, StoreElementParser parseElement);
+    void storePolygonPart(QGeoJsonGeometryStore *store);
+    void storeLinePart(QGeoJsonGeometryStore *store);
+    void storePointPart(QGeoJsonGeometryStore *store);
+    void storeRing(QGeoJsonGeometryStore *store);
+    void storePosition(QGeoJsonGeometryStore *store);
+    void skipCoordinateToken();
+    bool scanFeatureList(QVector<int> *ranges);
+    void appendFeatureRanges(QVector<int> *ranges, const StoreSpans &spans) const;
+
+    bool parseValue(QVariant *value);
+    bool parseMap(QVariantMap *map);
+    bool parseList(QVariantList *list);
+    bool parseString(QString *string);
+    bool parseNumber(double *value);
+    bool parseLiteral(const char *literal, int length);
+    bool skipValue();
+    bool skipNumber();
+
+    bool scanString(const char **begin, const char **end, bool *escaped);
+    bool decodeString(const char *begin, const char *end, QString *string);
+    Member memberFromKey(const char *begin, const char *end, bool escaped);
+
+    inline void skipWhitespace()
+    {
+        if (m_pos < m_end && isJsonWhitespace(*m_pos))
+            m_pos = skipJsonWhitespace(m_pos, m_end);
+    }
 
-    QList <QGeoCoordinate> lineCoordinatesList;
-    QVariant pathVariant = lineStringMap.value(valueLineString);
-    QJsonValue valueType = valueLineString;
+    bool setError(QJsonParseError::ParseError error)
+    {
+        if (m_error == QJsonParseError::NoError) {
+            m_error = error;
+            m_errorPos = m_pos;
+        }
+        return false;
+    }
 
-    QGeoPath parsedPath;
-    parsedPath = pathVariant.value<QGeoPath>();
+    const char *m_begin;
+    const char *m_pos;
+    const char *m_end;
+    const char *m_errorPos;
+    int m_depth;
+    QJsonParseError::ParseError m_error;
+    const GeoJsonSimplifier *m_simplifier; // applied to the coordinate lists before the shapes are built
+    std::function<bool(int)> m_scanProgress;
+    GeoJsonMemoryBudget *m_budget;
+    qint64 m_budgetCharged; // by the values built so far
+    bool m_budgetExceeded;
+    const GeoJsonRegionFilter *m_filter;
+
+    QVector<quint8> m_coordinateShape; // CoordinateToken, a stack with the innermost geometry on top
+    QVector<double> m_coordinateValues; // one per NumberToken
+    const quint8 *m_shapePos; // while storing tokens
+    const double *m_valuePos;
+};
+
+GeoJsonTextParser::GeoJsonTextParser(const char *begin, const char *end)
+    : m_begin(begin), m_pos(begin), m_end(end), m_errorPos(begin), m_depth(0),
+      m_error(QJsonParseError::NoError), m_simplifier(nullptr), m_budget(nullptr), m_budgetCharged(0),
+      m_budgetExceeded(false), m_filter(nullptr), m_shapePos(nullptr), m_valuePos(nullptr)
+{
+}
 
-    lineCoordinatesList = parsedPath.path();
-    lineCoordinates = exportLineStringCoordinates(lineCoordinatesList);
+QVariantMap GeoJsonTextParser::parseDocument()
+{
+    GeoJsonObject object;
+    skipWhitespace();
+    // Like QJsonDocument::object(), any other value is imported as an empty object
+    const bool ok = (m_pos < m_end && *m_pos == '{') ? parseObject(&object) : skipValue();
+    if (ok) {
+        skipWhitespace();
+        if (m_pos != m_end)
+            setError(QJsonParseError::GarbageAtEnd);
+    }
+    if (m_error != QJsonParseError::NoError || m_budgetExceeded)
+        return documentMap(GeoJsonObject());
+    const QVariantMap parsedGeoJsonMap = documentMap(object);
+    // the document map and list, its bbox, and a geometry not imported from typed coordinates
+    if (m_budget && !chargeBudget(parsedGeoJsonMap, 0))
+        return documentMap(GeoJsonObject());
+    return parsedGeoJsonMap;
+}
 
-    parsedMultiPoint.insert(keyType, valueType);
-    parsedMultiPoint.insert(keyCoord, lineCoordinates);
-    return parsedMultiPoint;
+QVariantMap GeoJsonTextParser::parseFeature()
+{
+    GeoJsonObject object;
+    skipWhitespace();
+    const bool ok = (m_pos < m_end && *m_pos == '{') ? parseObject(&object) : skipValue();
+    if (ok) {
+        skipWhitespace();
+        if (m_pos != m_end)
+            setError(QJsonParseError::GarbageAtEnd);
+    }
+    if (m_error != QJsonParseError::NoError)
+        return featureMap(GeoJsonObject());
+    return featureMap(object);
 }
 
-static QJsonObject exportPolygon(const QVariantMap &polygonMap)
+QVariant GeoJsonTextParser::geometryValue(const GeoJsonObject &object, ObjectType type) const
 {
-    QJsonObject parsedPolygon;
+    // already simplified by parseTypedCoordinates()
+    if (object.coordinatesType == type)
+        return object.coordinates;
+
+    // coordinates preceding "type", or not shaped as expected: use the QVariantMap importers
+    QVariantMap geometry;
+    geometry.insert(QStringLiteral("coordinates"), object.coordinates);
+    switch (type) {
+    case Point:
+        return QVariant::fromValue(importPoint(geometry));
+    case MultiPoint:
+        return QVariant::fromValue(importMultiPoint(geometry));
+    case LineString:
+        return QVariant::fromValue(importLineString(geometry, m_simplifier));
+    case MultiLineString:
+        return QVariant::fromValue(importMultiLineString(geometry, m_simplifier));
+    case Polygon:
+        return QVariant::fromValue(importPolygon(geometry, m_simplifier));
+    case MultiPolygon:
+        return QVariant::fromValue(importMultiPolygon(geometry, m_simplifier));
+    default:
+        break;
+    }
+    return QVariant();
+}
 
-    QString keyType = QStringLiteral("type");
+QVariantMap GeoJsonTextParser::geometryMap(const GeoJsonObject &object) const
+{
+    // importGeometry() falls back to GeometryCollection for any other type
+    const ObjectType type = (object.type >= Point && object.type <= MultiPolygon) ? object.type : GeometryCollection;
+    const QString geoKey = QString::fromLatin1(geoJsonTypeNames[type]);
 
-    QString keyCoord = QStringLiteral("coordinates");
+    QVariantMap parsedGeoJsonMap;
+    if (type == GeometryCollection)
+        parsedGeoJsonMap.insert(geoKey, QVariant::fromValue(object.geometries));
+    else
+        parsedGeoJsonMap.insert(geoKey, geometryValue(object, type));
+    return parsedGeoJsonMap;
+}
 
-    QString valuePolygon = QStringLiteral("Polygon");
-    QJsonValue polyCoordinates;
+QVariantMap GeoJsonTextParser::featureMap(const GeoJsonObject &object) const
+{
+    QVariantMap parsedFeature;
+    parsedFeature.insert(QStringLiteral("geometry"), object.hasGeometry ? object.geometry : geometryMap(GeoJsonObject()));
+    parsedFeature.insert(QStringLiteral("properties"), object.properties);
+    if (object.id != QVariant::Invalid)
+        parsedFeature.insert(QStringLiteral("id"), object.id);
+    return parsedFeature;
+}
 
-    QGeoPolygon parsedPoly;
+QVariantMap GeoJsonTextParser::documentMap(const GeoJsonObject &object) const
+{
+    // importGeoJson() falls back to FeatureCollection for any other type
+    const ObjectType type = object.type == UnknownType ? FeatureCollection : object.type;
+    const QString keyMap = QString::fromLatin1(geoJsonTypeNames[type]);
 
-    QList<QList<QGeoCoordinate>> obtainedCoordinatesPoly;
-    QVariant polygonVariant = polygonMap.value(valuePolygon);
+    QVariantMap parsedGeoJsonMap;
+    switch (type) {
+    case GeometryCollection:
+        parsedGeoJsonMap.insert(keyMap, QVariant::fromValue(object.geometries));
+        break;
+    case Feature:
+        parsedGeoJsonMap.insert(keyMap, QVariant::fromValue(featureMap(object)));
+        break;
+    case FeatureCollection:
+        parsedGeoJsonMap.insert(keyMap, QVariant::fromValue(object.features));
+        break;
+    default:
+        parsedGeoJsonMap.insert(keyMap, geometryValue(object, type));
+        break;
+    }
 
-    QJsonValue valueType = valuePolygon;
+    if (object.bbox != QVariant::Invalid)
+        parsedGeoJsonMap.insert(QStringLiteral("bbox"), object.bbox);
+    return parsedGeoJsonMap;
+}
 
-    parsedPoly = polygonVariant.value<QGeoPolygon>();
-    obtainedCoordinatesPoly << parsedPoly.path();
+GeoJsonTextParser::Member GeoJsonTextParser::memberFromKey(const char *begin, const char *end, bool escaped)
+{
+    QByteArray decodedKey;
+    if (escaped) {
+        QString key;
+        if (!decodeString(begin, end, &key))
+            return OtherMember;
+        decodedKey = key.toUtf8();
+        begin = decodedKey.constData();
+        end = begin + decodedKey.size();
+    }
 
-    if (parsedPoly.holesCount()!=0)
-        for (int i = 0; i<parsedPoly.holesCount(); i++) {
-            obtainedCoordinatesPoly << parsedPoly.holePath(i);
-        }
-    polyCoordinates = exportPolygonCoordinates(obtainedCoordinatesPoly);
-    qDebug() << " 8: " << parsedPolygon;
-    parsedPolygon.insert(keyType, valueType);
-    qDebug() << " 9: " << parsedPolygon;
-    parsedPolygon.insert(keyCoord, polyCoordinates);
-    qDebug() << " 10: " << parsedPolygon;
-    return parsedPolygon;
+    const int length = int(end - begin);
+    switch (length) {
+    case 2:
+        if (memcmp(begin, "id", 2) == 0)
+            return IdMember;
+        break;
+    case 4:
+        if (memcmp(begin, "type", 4) == 0)
+            return TypeMember;
+        if (memcmp(begin, "bbox", 4) == 0)
+            return BboxMember;
+        break;
+    case 8:
+        if (memcmp(begin, "geometry", 8) == 0)
+            return GeometryMember;
+        if (memcmp(begin, "features", 8) == 0)
+            return FeaturesMember;
+        break;
+    case 10:
+        if (memcmp(begin, "properties", 10) == 0)
+            return PropertiesMember;
+        if (memcmp(begin, "geometries", 10) == 0)
+            return GeometriesMember;
+        break;
+    case 11:
+        if (memcmp(begin, "coordinates", 11) == 0)
+            return CoordinatesMember;
+        break;
+    default:
+        break;
+    }
+    return OtherMember;
 }
 
-static QJsonObject exportMultiPoint(const QVariantMap &multiPointMap)
+bool GeoJsonTextParser::parseObject(GeoJsonObject *object)
 {
-    QJsonObject parsedMultiPoint;
+    if (++m_depth > MaxDepth)
+        return setError(QJsonParseError::DeepNesting);
+    ++m_pos; // '{'
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == '}') {
+        ++m_pos;
+        --m_depth;
+        return true;
+    }
 
-    QString keyType = QStringLiteral("type");
-    QString keyCoord = QStringLiteral("coordinates");
+    forever {
+        skipWhitespace();
+        if (m_pos >= m_end || *m_pos != '"')
+            return setError(QJsonParseError::UnterminatedObject);
+        const char *keyBegin;
+        const char *keyEnd;
+        bool escaped;
+        if (!scanString(&keyBegin, &keyEnd, &escaped))
+            return false;
+        skipWhitespace();
+        if (m_pos >= m_end || *m_pos != ':')
+            return setError(QJsonParseError::MissingNameSeparator);
+        ++m_pos;
+        skipWhitespace();
+        if (!parseMember(object, memberFromKey(keyBegin, keyEnd, escaped)))
+            return false;
+        skipWhitespace();
+        if (m_pos >= m_end)
+            return setError(QJsonParseError::UnterminatedObject);
+        const char c = *m_pos++;
+        if (c == '}')
+            break;
+        if (c != ',')
+            return setError(QJsonParseError::MissingValueSeparator);
+    }
+    --m_depth;
+    return true;
+}
 
-    QString valueMultiPoint = QStringLiteral("MultiPoint");
-
-    QJsonValue multiPosition;
-
-    QList <QGeoCoordinate> obtainedCoordinatesMP;
-    QVariant multiCircleVariant = multiPointMap.value(valueMultiPoint);
-    QVariantList multiCircleVariantList = multiCircleVariant.value<QVariantList>();
-    QJsonValue typeValue = valueMultiPoint;
+bool GeoJsonTextParser::parseMember(GeoJsonObject *object, Member member)
+{
+    switch (member) {
+    case TypeMember:
+        return parseType(&object->type);
+    case CoordinatesMember:
+        return parseCoordinates(object);
+    case GeometriesMember:
+        object->geometries.clear();
+        return parseObjectList(&object->geometries, member);
+    case FeaturesMember:
+        object->features.clear();
+        return parseObjectList(&object->features, member);
+    case GeometryMember:
+    {
+        GeoJsonObject geometry;
+        if (m_pos < m_end && *m_pos == '{') {
+            if (!parseObject(&geometry))
+                return false;
+        } else if (!skipValue()) {
+            return false;
+        }
+        object->geometry = geometryMap(geometry);
+        object->hasGeometry = true;
+        return true;
+    }
+    case PropertiesMember:
+        return parseValue(&object->properties);
+    case IdMember:
+        return parseValue(&object->id);
+    case BboxMember:
+        return parseValue(&object->bbox);
+    case OtherMember:
+        break;
+    }
+    return skipValue();
+}
 
-    for (const QVariant &exCircle: multiCircleVariantList) {
-        obtainedCoordinatesMP << exCircle.value<QGeoCircle>().center();
+bool GeoJsonTextParser::parseType(ObjectType *type)
+{
+    if (m_pos < m_end && *m_pos == '"') {
+        // the common case, compared without decoding the string
+        const char *begin;
+        const char *end;
+        bool escaped;
+        const char *start = m_pos;
+        if (!scanString(&begin, &end, &escaped))
+            return false;
+        if (!escaped) {
+            *type = UnknownType;
+            for (int i = Point; i <= FeatureCollection; ++i) {
+                if (qstrlen(geoJsonTypeNames[i]) == uint(end - begin)
+                        && memcmp(begin, geoJsonTypeNames[i], size_t(end - begin)) == 0) {
+                    *type = ObjectType(i);
+                    break;
+                }
+            }
+            return true;
+        }
+        m_pos = start;
     }
-    multiPosition = exportLineStringCoordinates(obtainedCoordinatesMP);
 
-    parsedMultiPoint.insert(keyType, typeValue);
-    parsedMultiPoint.insert(keyCoord, multiPosition);
-    return parsedMultiPoint;
+    QVariant typeValue;
+    if (!parseValue(&typeValue))
+        return false;
+    *type = UnknownType;
+    if (typeValue.type() == QVariant::String) {
+        const QString typeName = typeValue.toString();
+        for (int i = Point; i <= FeatureCollection; ++i) {
+            if (typeName == QLatin1String(geoJsonTypeNames[i])) {
+                *type = ObjectType(i);
+                break;
+            }
+        }
+    }
+    return true;
 }
 
-static QJsonObject exportMultiLineString(const QVariantMap &multiLineStringMap)
+bool GeoJsonTextParser::parseObjectList(QVariantList *list, Member member)
 {
-    QJsonObject parsedMultiLineString;
-
-    QString keyType = QStringLiteral("type");
-    QString keyCoord = QStringLiteral("coordinates");
-    QString valueMultiLineString = QStringLiteral("MultiLineString");
+    if (m_pos >= m_end || *m_pos != '[')
+        return skipValue(); // not a list, imported as an empty one
+    if (++m_depth > MaxDepth)
+        return setError(QJsonParseError::DeepNesting);
+    ++m_pos;
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == ']') {
+        ++m_pos;
+        --m_depth;
+        return true;
+    }
 
-    QList<QList<QGeoCoordinate>> obtainedCoordinatesMLS;
-    QVariant multiPathVariant = multiLineStringMap.value(valueMultiLineString);
-    QVariantList multiPathList = multiPathVariant.value<QVariantList>();
-    QJsonValue typeValue = valueMultiLineString;
+    forever {
+        skipWhitespace();
+        bool skipped = false;
+        if (m_filter && member == FeaturesMember && !skipFilteredFeature(&skipped))
+            return false;
+        if (!skipped && !parseListElement(list, member))
+            return false;
+
+        skipWhitespace();
+        if (m_pos >= m_end)
+            return setError(QJsonParseError::UnterminatedArray);
+        const char c = *m_pos++;
+        if (c == ']')
+            break;
+        if (c != ',')
+            return setError(QJsonParseError::MissingValueSeparator);
+    }
+    --m_depth;
+    return true;
+}
 
-    for (const QVariant &singlePath: multiPathList ){
-        obtainedCoordinatesMLS << singlePath.value<QGeoPath>().path();
+bool GeoJsonTextParser::parseListElement(QVariantList *list, Member member)
+{
+    const qint64 charged = m_budgetCharged;
+    GeoJsonObject element;
+    if (m_pos < m_end && *m_pos == '{') {
+        if (!parseObject(&element))
+            return false;
+    } else if (!skipValue()) {
+        return false;
     }
 
-    parsedMultiLineString.insert(keyType, typeValue);
-    parsedMultiLineString.insert(keyCoord, exportPolygonCoordinates(obtainedCoordinatesMLS));
-    return parsedMultiLineString;
+    if (member == FeaturesMember) {
+        QVariantMap importedMap;
+        importedMap.insert(QStringLiteral("Feature"), featureMap(element));
+        list->append(importedMap);
+    } else {
+        list->append(geometryMap(element));
+    }
+    return !m_budget || chargeListElement(list->last(), charged);
 }
 
-static QJsonObject exportMultiPolygon(const QVariantMap &multiPolygonMap)
+bool GeoJsonTextParser::parseCoordinates(GeoJsonObject *object)
 {
-    QJsonObject parsedMultiPolygon;
-
-    QString keyType = QStringLiteral("type");
-    QString keyCoord = QStringLiteral("coordinates");
-    QString valueMultiPolygon = QStringLiteral("MultiPolygon");
+    const char *start = m_pos;
+    if (object->type >= Point && object->type <= MultiPolygon) {
+        QVariant geometry;
+        if (parseTypedCoordinates(object->type, &geometry)) {
+            object->coordinates = geometry;
+            object->coordinatesType = object->type;
+            return !m_budget || chargeBudget(geometry, m_budgetCharged);
+        }
+        m_pos = start; // unexpected shape, parse again as a generic value
+    }
+    object->coordinatesType = UnknownType;
+    return parseValue(&object->coordinates);
+}
 
-    QJsonValue polyCoordinates;
+bool GeoJsonTextParser::parseTypedCoordinates(ObjectType type, QVariant *value)
+{
+    switch (type) {
+    case Point:
+    {
+        QGeoCoordinate center;
+        if (!parsePosition(&center))
+            return false;
+        QGeoCircle parsedPoint;
+        parsedPoint.setCenter(center);
+        *value = QVariant::fromValue(parsedPoint);
+        return true;
+    }
+    case MultiPoint:
+    {
+        QList<QGeoCoordinate> centers;
+        if (!parsePositions(&centers))
+            return false;
+        *value = QVariant::fromValue(importMultiPointCoordinates(centers));
+        return true;
+    }
+    case LineString:
+    {
+        QList<QGeoCoordinate> path;
+        if (!parsePositions(&path))
+            return false;
+        if (m_simplifier)
+            path = m_simplifier->simplifyLine(path);
+        QGeoPath parsedLineString;
+        parsedLineString.setPath(path);
+        *value = QVariant::fromValue(parsedLineString);
+        return true;
+    }
+    case MultiLineString:
+    {
+        QList<QList<QGeoCoordinate>> paths;
+        if (!parseRings(&paths))
+            return false;
+        if (m_simplifier)
+            m_simplifier->simplifyLines(&paths);
+        *value = QVariant::fromValue(importMultiLineStringCoordinates(paths));
+        return true;
+    }
+    case Polygon:
+    {
+        QList<QList<QGeoCoordinate>> perimeters;
+        if (!parseRings(&perimeters))
+            return false;
+        if (m_simplifier)
+            m_simplifier->simplifyRings(&perimeters);
+        *value = QVariant::fromValue(importPolygonPerimeters(perimeters));
+        return true;
+    }
+    case MultiPolygon:
+    {
+        QList<QList<QList<QGeoCoordinate>>> polygons;
+        if (!parsePolygons(&polygons))
+            return false;
+        if (m_simplifier) {
+            for (QList<QList<QGeoCoordinate>> &polygon: polygons)
+                m_simplifier->simplifyRings(&polygon);
+        }
+        *value = QVariant::fromValue(importMultiPolygonCoordinates(polygons));
+        return true;
+    }
+    default:
+        break;
+    }
+    return false;
+}
 
-    QJsonArray parsedArrayPolygon;
-    QList<QList<QGeoCoordinate>> obtainedPolyCoordinates;
+// The coordinate parsers never raise errors: on anything unexpected they return false and
+// the value is parsed again by parseValue()
 
-    QVariant multiPolygonVariant = multiPolygonMap.value(valueMultiPolygon);
-    QVariantList multiPolygonList = multiPolygonVariant.value<QVariantList>();
+bool GeoJsonTextParser::parsePosition(QGeoCoordinate *coordinate)
+{
+    if (m_pos >= m_end || *m_pos != '[')
+        return false;
+    ++m_pos;
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == ']') {
+        ++m_pos;
+        return true;
+    }
 
-    QJsonValue typeValue = valueMultiPolygon;
-    int polyHoles = 0;
-    int currentHole;
+    for (int i = 0; ; ++i) {
+        skipWhitespace();
+        double value;
+        if (!parseNumber(&value))
+            return false;
+        switch (i) { // same member order as importPointCoordinates()
+        case 0:
+            coordinate->setLatitude(value);
+            break;
+        case 1:
+            coordinate->setLongitude(value);
+            break;
+        case 2:
+            coordinate->setAltitude(value);
+            break;
+        }
+        skipWhitespace();
+        if (m_pos >= m_end)
+            return false;
+        const char c = *m_pos++;
+        if (c == ']')
+            return true;
+        if (c != ',')
+            return false;
+    }
+}
 
-    for (const QVariant &singlePoly: multiPolygonList ) { // Start parsing èolygon list
-        obtainedPolyCoordinates << singlePoly.value<QGeoPolygon>().path(); // Extract external polygon path
-        polyHoles = singlePoly.value<QGeoPolygon>().holesCount();
+template <typename T>
+bool GeoJsonTextParser::parseCoordinateArray(QList<T> *list, bool (GeoJsonTextParser::*parseElement)(T *))
+{
+    if (m_pos >= m_end || *m_pos != '[')
+        return false;
+    ++m_pos;
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == ']') {
+        ++m_pos;
+        return true;
+    }
 
-        if (polyHoles) //Check if the polygon has holes
-            for (currentHole = 0 ; currentHole<polyHoles; currentHole++)
-                obtainedPolyCoordinates << singlePoly.value<QGeoPolygon>().holePath(currentHole);
-        polyCoordinates = exportPolygonCoordinates(obtainedPolyCoordinates); //Generates QJsonDocument compatible value
-        parsedArrayPolygon.append(polyCoordinates); // Adds one level of nesting in coordinates
-        obtainedPolyCoordinates.clear(); // Clears the temporary polygon linear ring storage
+    forever {
+        skipWhitespace();
+        T element;
+        if (!(this->*parseElement)(&element))
+            return false;
+        list->append(element);
+        skipWhitespace();
+        if (m_pos >= m_end)
+            return false;
+        const char c = *m_pos++;
+        if (c == ']')
+            return true;
+        if (c != ',')
+            return false;
     }
-    QJsonValue parsed = parsedArrayPolygon;
+}
 
-    parsedMultiPolygon.insert(keyType, typeValue);
-    parsedMultiPolygon.insert(keyCoord, parsed);
-    return parsedMultiPolygon;
+bool GeoJsonTextParser::parsePositions(QList<QGeoCoordinate> *positions)
+{
+    return parseCoordinateArray(positions, &GeoJsonTextParser::parsePosition);
 }
 
-static QJsonObject exportGeometry(const QVariantMap &geometryMap);
+bool GeoJsonTextParser::parseRings(QList<QList<QGeoCoordinate>> *rings)
+{
+    return parseCoordinateArray(rings, &GeoJsonTextParser::parsePositions);
+}
 
-static QJsonObject exportGeometryCollection(const QVariantMap &geometryCollection)
+bool GeoJsonTextParser::parsePolygons(QList<QList<QList<QGeoCoordinate>>> *polygons)
 {
-    QString keyType = QStringLiteral("type");
-    QString keyGeometries = QStringLiteral("geometries");
-    QString valueGeometryCollection = QStringLiteral("GeometryCollection");
+    return parseCoordinateArray(polygons, &GeoJsonTextParser::parseRings);
+}
 
-    QJsonObject parsed;
-    QJsonObject parsedGeometry;
-    QVariantList geometriesList;
+// Columnar import: the members of each object are located first, then imported into the
+// store in the order it needs, since "type" may follow "coordinates" or "geometries".
+// Properties and ids are not decoded, their text is copied into the store as is.
 
-    QJsonValue valueGeometries;
-    QJsonArray parsedGeometries;
+QVariant GeoJsonTextParser::parseJsonValue()
+{
+    QVariant value;
+    skipWhitespace();
+    if (!parseValue(&value))
+        return QVariant();
+    return value;
+}
 
-    geometriesList = geometryCollection.value(valueGeometryCollection).value<QVariantList>();
-    for (const QVariant &extractedGeometry: geometriesList){
-        parsedGeometry = exportGeometry(extractedGeometry.value<QVariantMap>());
-        valueGeometries = parsedGeometry;
-        parsedGeometries.append(valueGeometries);
+QVariantMap GeoJsonTextParser::parseGeometry()
+{
+    GeoJsonObject object;
+    skipWhitespace();
+    const bool ok = (m_pos < m_end && *m_pos == '{') ? parseObject(&object) : skipValue();
+    if (!ok)
+        return geometryMap(GeoJsonObject());
+    return geometryMap(object);
+}
+
+/*
+    A single pass over the text: members are imported as soon as they are reached, for the
+    object type they are meaningful for, and coordinates are converted before the type is
+    known. Only the members of documents whose type turns out to be another one than
+    expected are read a second time.
+*/
+bool GeoJsonTextParser::parseStore(QGeoJsonGeometryStore *store)
+{
+    StoreSpans spans;
+    skipWhitespace();
+    // Like QJsonDocument::object(), any other value is imported as an empty object
+    const bool ok = (m_pos < m_end && *m_pos == '{') ? scanStoreObject(&spans, store, ScanDocument) : skipValue();
+    if (!ok)
+        return false;
+    skipWhitespace();
+    if (m_pos != m_end)
+        return setError(QJsonParseError::GarbageAtEnd);
+
+    if (spans.type >= Point && spans.type <= GeometryCollection) {
+        store->setDocumentType(QGeoJsonGeometryStore::GeometryDocument);
+        if (spans.written & (StoreGeometry | StoreFeatures)) {
+            store->truncate(0, 0);
+            spans.written = 0;
+            spans.imported &= StoreCoordinates;
+        }
+        if (!storeGeometry(store, &spans))
+            return false;
+    } else if (spans.type == Feature) {
+        store->setDocumentType(QGeoJsonGeometryStore::FeatureDocument);
+        if (spans.written != StoreGeometry || !(spans.imported & StoreGeometry)) {
+            store->truncate(0, 0);
+            if (spans.geometry) {
+                m_pos = spans.geometry;
+                if (!scanStoreGeometry(store))
+                    return false;
+            }
+        }
+        if (!store->geometryCount())
+            store->addGeometry(QGeoJsonGeometryStore::GeometryCollection);
+        store->addFeatureJson(0, spans.properties, int(spans.propertiesEnd - spans.properties),
+                              spans.id, int(spans.idEnd - spans.id));
+    } else { // importGeoJson() falls back to FeatureCollection for unknown types
+        store->setDocumentType(QGeoJsonGeometryStore::FeatureCollectionDocument);
+        if (spans.written != StoreFeatures || !(spans.imported & StoreFeatures)) {
+            store->truncate(0, 0);
+            int count;
+            if (spans.features) {
+                m_pos = spans.features;
+                if (!scanStoreList(store, &GeoJsonTextParser::scanStoreFeature, &count))
+                    return false;
+            }
+        }
     }
-    valueGeometries = parsedGeometries;
-    QJsonValue valueType = valueGeometryCollection;
 
-    parsed.insert(keyType, valueType);
-    parsed.insert(keyGeometries, valueGeometries);
-    return parsed;
+    if (spans.bbox) {
+        m_pos = spans.bbox;
+        store->setBoundingBox(parseJsonValue());
+    }
+    return m_error == QJsonParseError::NoError;
 }
 
-static QJsonObject exportGeometry(const QVariantMap &geometryMap)
+bool GeoJsonTextParser::scanFeatures(QGeoJsonGeometryStore::DocumentType *type, QVector<int> *ranges, QVariant *bbox)
 {
-    QJsonObject newObject;
-    QJsonDocument newDocument;
-    if (geometryMap.contains(QStringLiteral("Point"))) // check if the map contains the key Point
-        newObject = exportPoint(geometryMap);
-    if (geometryMap.contains(QStringLiteral("MultiPoint"))) // check if the map contains the key MultiPoint
-        newObject = exportMultiPoint(geometryMap);
-    if (geometryMap.contains(QStringLiteral("LineString")))
-        newObject = exportLineString(geometryMap);
-    if (geometryMap.contains(QStringLiteral("MultiLineString")))
-        newObject = exportMultiLineString(geometryMap);
-        newDocument.setObject(newObject);
-    if (geometryMap.contains(QStringLiteral("Polygon")))
-        newObject = exportPolygon(geometryMap);
-    if (geometryMap.contains(QStringLiteral("MultiPolygon")))
-        newObject = exportMultiPolygon(geometryMap);
-    if (geometryMap.contains(QStringLiteral("GeometryCollection")))
-        newObject = exportGeometryCollection(geometryMap);
-    return newObject;
+    StoreSpans spans;
+    skipWhitespace();
+    const bool ok = (m_pos < m_end && *m_pos == '{') ? scanStoreObject(&spans) : skipValue();
+    if (!ok)
+        return false;
+    skipWhitespace();
+    if (m_pos != m_end)
+        return setError(QJsonParseError::GarbageAtEnd);
+
+    if (spans.type >= Point && spans.type <= GeometryCollection) {
+        *type = QGeoJsonGeometryStore::GeometryDocument;
+    } else if (spans.type == Feature) {
+        *type = QGeoJsonGeometryStore::FeatureDocument;
+        appendFeatureRanges(ranges, spans);
+    } else { // importGeoJson() falls back to FeatureCollection for unknown types
+        *type = QGeoJsonGeometryStore::FeatureCollectionDocument;
+        if (spans.features) {
+            m_pos = spans.features;
+            if (!scanFeatureList(ranges))
+                return false;
+        }
+    }
+
+    if (spans.bbox) {
+        m_pos = spans.bbox;
+        *bbox = parseJsonValue();
+    }
+    return m_error == QJsonParseError::NoError;
 }
 
-static QJsonObject exportFeature(const QVariantMap &feature)
+bool GeoJsonTextParser::scanFeatureList(QVector<int> *ranges)
 {
-    QString keyType = QStringLiteral("type");
-    QString keyFeature = QStringLiteral("geometry");
-    QString keyProp = QStringLiteral("properties");
-    QString keyId = QStringLiteral("id");
-    QString valueFeat = QStringLiteral("Feature");
+    if (m_pos >= m_end || *m_pos != '[')
+        return skipValue(); // not an array, imported as an empty one
+    ++m_pos;
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == ']') {
+        ++m_pos;
+        return true;
+    }
 
-    QJsonObject parsedFeature;
-    QJsonObject exportedFeature;
-    QJsonObject exportedProp;
-    QJsonObject valueProp;
+    const char *reported = m_pos;
+    forever {
+        skipWhitespace();
+        StoreSpans spans;
+        const bool ok = (m_pos < m_end && *m_pos == '{') ? scanStoreObject(&spans) : skipValue();
+        if (!ok)
+            return false;
+        appendFeatureRanges(ranges, spans);
+        if (m_scanProgress && m_pos - reported >= ScanProgressBytes) {
+            reported = m_pos;
+            if (!m_scanProgress(int(m_pos - m_begin)))
+                return false; // canceled, error() stays NoError
+        }
+        skipWhitespace();
+        if (m_pos >= m_end)
+            return setError(QJsonParseError::UnterminatedArray);
+        const char c = *m_pos++;
+        if (c == ']')
+            break;
+        if (c != ',')
+            return setError(QJsonParseError::MissingValueSeparator);
+    }
+    return true;
+}
 
-    QVariantMap featureMap;
-    QVariantMap feat;
+// Offsets of the geometry, properties and id values of a feature, begin == end when missing
+void GeoJsonTextParser::appendFeatureRanges(QVector<int> *ranges, const StoreSpans &spans) const
+{
+    const char *const values[] = {
+        spans.geometry, spans.geometryEnd, spans.properties, spans.propertiesEnd, spans.id, spans.idEnd
+    };
+    for (const char *value: values)
+        ranges->append(value ? int(value - m_begin) : 0);
+}
 
-    QJsonValue valueFeature;
-    QJsonValue valueProperties;
-    QJsonValue valueId;
+bool GeoJsonTextParser::scanStoreObject(StoreSpans *spans, QGeoJsonGeometryStore *store, int scan)
+{
+    if (++m_depth > MaxDepth)
+        return setError(QJsonParseError::DeepNesting);
+    if (store) {
+        spans->firstGeometry = store->geometryCount();
+        spans->firstFeature = store->featureCount();
+        spans->shapeBegin = m_coordinateShape.size();
+        spans->valueBegin = m_coordinateValues.size();
+    }
+    ++m_pos; // '{'
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == '}') {
+        ++m_pos;
+        --m_depth;
+        return true;
+    }
 
-    featureMap = feature.value(valueFeat).value<QVariantMap>();
-    QJsonValue valueType = valueFeat;
-    feat = featureMap.value(keyFeature).value<QVariantMap>();
-    exportedFeature = exportGeometry(feat);
-    valueFeature = exportedFeature;
+    forever {
+        skipWhitespace();
+        if (m_pos >= m_end || *m_pos != '"')
+            return setError(QJsonParseError::UnterminatedObject);
+        const char *keyBegin;
+        const char *keyEnd;
+        bool escaped;
+        if (!scanString(&keyBegin, &keyEnd, &escaped))
+            return false;
+        skipWhitespace();
+        if (m_pos >= m_end || *m_pos != ':')
+            return setError(QJsonParseError::MissingNameSeparator);
+        ++m_pos;
+        skipWhitespace();
+
+        const char *value = m_pos;
+        const Member member = memberFromKey(keyBegin, keyEnd, escaped);
+        if (!scanStoreMember(spans, store, scan, member))
+            return false;
+        switch (member) {
+        case CoordinatesMember:
+            spans->coordinates = value;
+            break;
+        case GeometriesMember:
+            spans->geometries = value;
+            break;
+        case GeometryMember:
+            spans->geometry = value;
+            spans->geometryEnd = m_pos;
+            break;
+        case FeaturesMember:
+            spans->features = value;
+            break;
+        case PropertiesMember:
+            spans->properties = value;
+            spans->propertiesEnd = m_pos;
+            break;
+        case IdMember:
+            spans->id = value;
+            spans->idEnd = m_pos;
+            break;
+        case BboxMember:
+            spans->bbox = value;
+            break;
+        case TypeMember:
+        case OtherMember:
+            break;
+        }
 
-    feat = featureMap.value(keyProp).value<QVariantMap>();
+        skipWhitespace();
+        if (m_pos >= m_end)
+            return setError(QJsonParseError::UnterminatedObject);
+        const char c = *m_pos++;
+        if (c == '}')
+            break;
+        if (c != ',')
+            return setError(QJsonParseError::MissingValueSeparator);
+    }
+    --m_depth;
+    return true;
+}
 
-    parsedFeature.insert(keyType, valueType);
-    parsedFeature.insert(keyFeature, valueFeature);
+/*
+    Imports the value of a member selected by scan as soon as it is reached, unless the type
+    of the object read so far tells it is of no use; otherwise the value is only checked.
+    A member imported again replaces everything the object added to the store, the members
+    losing their import this way are imported again from their spans once the object is
+    complete, see storeGeometry() and parseStore().
+*/
+bool GeoJsonTextParser::scanStoreMember(StoreSpans *spans, QGeoJsonGeometryStore *store, int scan, Member member)
+{
+    const ObjectType type = spans->type;
+    const bool unknown = type == UnknownType;
+    const bool shape = type >= Point && type < GeometryCollection;
+    StoreMember imported;
+    bool used;
+    switch (member) {
+    case TypeMember:
+        return parseType(&spans->type);
+    case CoordinatesMember:
+        imported = StoreCoordinates;
+        used = (scan & ScanGeometries) && (unknown || shape);
+        break;
+    case GeometriesMember:
+        // any other type is imported as a GeometryCollection, unless the object is the document
+        imported = StoreGeometries;
+        used = (scan & ScanGeometries) && (unknown || type == GeometryCollection || (!shape && !(scan & ScanFeatures)));
+        break;
+    case GeometryMember:
+        imported = StoreGeometry;
+        used = (scan & ScanGeometry) && (unknown || type == Feature || !(scan & ScanFeatures));
+        break;
+    case FeaturesMember:
+        imported = StoreFeatures;
+        used = (scan & ScanFeatures) && (unknown || type == FeatureCollection);
+        break;
+    default:
+        return skipValue();
+    }
 
-    valueProp = featureMap.value(keyProp).value<QVariant>().toJsonObject();
-    valueProperties = valueProp;
-    parsedFeature.insert(keyProp, valueProperties);
+    if (!used) {
+        spans->imported &= ~imported;
+        return skipValue();
+    }
 
-    valueId = featureMap.value(keyId).value<QVariant>().toJsonValue();
-    parsedFeature.insert(keyId, valueId);
-    return parsedFeature;
+    bool ok;
+    if (imported == StoreCoordinates) {
+        m_coordinateShape.resize(spans->shapeBegin);
+        m_coordinateValues.resize(spans->valueBegin);
+        ok = scanCoordinateTokens();
+    } else {
+        if (spans->written & imported) {
+            store->truncate(spans->firstGeometry, spans->firstFeature);
+            spans->written = 0;
+            spans->imported &= StoreCoordinates;
+        }
+        spans->written |= imported;
+        int count;
+        if (member == GeometriesMember)
+            ok = scanStoreList(store, &GeoJsonTextParser::scanStoreGeometry, &spans->childCount);
+        else if (member == GeometryMember)
+            ok = scanStoreGeometry(store);
+        else
+            ok = scanStoreList(store, &GeoJsonTextParser::scanStoreFeature, &count);
+    }
+    spans->imported |= imported;
+    return ok;
 }
 
-static QJsonObject exportFeatureCollection(const QVariantMap &featureCollection)
+// Imports the geometry object at m_pos, any other value is an empty GeometryCollection
+bool GeoJsonTextParser::scanStoreGeometry(QGeoJsonGeometryStore *store)
 {
-    QString keyType = QStringLiteral("type");
-    QString keyFeature = QStringLiteral("features");
-    QString valueFeat = QStringLiteral("FeatureCollection");
-
-    QJsonObject parsedFeatureCollection;
-    QJsonObject exportedFeature;
+    if (m_pos >= m_end || *m_pos != '{') {
+        store->addGeometry(QGeoJsonGeometryStore::GeometryCollection);
+        return skipValue();
+    }
+    StoreSpans spans;
+    return scanStoreObject(&spans, store, ScanGeometries) && storeGeometry(store, &spans);
+}
 
-    QVariantMap featureMap;
-    QVariantMap featfeat;
+bool GeoJsonTextParser::scanStoreFeature(QGeoJsonGeometryStore *store)
+{
+    const int geometry = store->geometryCount();
+    StoreSpans spans;
+    const bool ok = (m_pos < m_end && *m_pos == '{') ? scanStoreObject(&spans, store, ScanGeometry) : skipValue();
+    if (!ok)
+        return false;
+    if (store->geometryCount() == geometry)
+        store->addGeometry(QGeoJsonGeometryStore::GeometryCollection); // no "geometry" member
+    store->addFeatureJson(geometry, spans.properties, int(spans.propertiesEnd - spans.properties),
+                          spans.id, int(spans.idEnd - spans.id));
+    return true;
+}
 
-    QJsonValue valueType;
-    QJsonArray array;
+bool GeoJsonTextParser::scanStoreList(QGeoJsonGeometryStore *store,
+                                      bool (GeoJsonTextParser::*scanElement)(QGeoJsonGeometryStore *), int *count)
+{
+    *count = 0;
+    if (m_pos >= m_end || *m_pos != '[')
+        return skipValue(); // not an array, imported as an empty one
+    ++m_pos;
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == ']') {
+        ++m_pos;
+        return true;
+    }
 
-    QVariant extractedFeatureVariant = featureCollection.value(valueFeat);
-    QVariantList extractedFeaturVariantList = extractedFeatureVariant.value<QVariantList>();
-    qDebug() << " 11: " << valueFeat;
-    QJsonValue valueFeature = valueFeat;
+    forever {
+        skipWhitespace();
+        if (!(this->*scanElement)(store))
+            return false;
+        ++*count;
+        skipWhitespace();
+        if (m_pos >= m_end)
+            return setError(QJsonParseError::UnterminatedArray);
+        const char c = *m_pos++;
+        if (c == ']')
+            break;
+        if (c != ',')
+            return setError(QJsonParseError::MissingValueSeparator);
+    }
+    return true;
+}
 
+// Checks the value at m_pos and converts its numbers, whatever the geometry type turns out to be
+bool GeoJsonTextParser::scanCoordinateTokens()
+{
+    if (m_pos >= m_end)
+        return setError(QJsonParseError::IllegalValue);
+    if (*m_pos == '-' || isJsonDigit(*m_pos)) {
+        double value;
+        if (!parseNumber(&value))
+            return setError(QJsonParseError::IllegalNumber);
+        m_coordinateShape.append(NumberToken);
+        m_coordinateValues.append(value);
+        return true;
+    }
+    if (*m_pos != '[') {
+        m_coordinateShape.append(OtherToken);
+        return skipValue();
+    }
 
+    if (++m_depth > MaxDepth)
+        return setError(QJsonParseError::DeepNesting);
+    m_coordinateShape.append(ArrayBeginToken);
+    ++m_pos;
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == ']') {
+        ++m_pos;
+    } else {
+        forever {
+            skipWhitespace();
+            if (m_pos < m_end && (*m_pos == '-' || isJsonDigit(*m_pos))) {
+                // the numbers of a position, without a call per element
+                double value;
+                const char *next = parseJsonNumber(m_pos, m_end, &value);
+                if (!next)
+                    return setError(QJsonParseError::IllegalNumber);
+                m_pos = next;
+                m_coordinateShape.append(NumberToken);
+                m_coordinateValues.append(value);
+            } else if (!scanCoordinateTokens()) {
+                return false;
+            }
+            skipWhitespace();
+            if (m_pos >= m_end)
+                return setError(QJsonParseError::UnterminatedArray);
+            const char c = *m_pos++;
+            if (c == ']')
+                break;
+            if (c != ',')
+                return setError(QJsonParseError::MissingValueSeparator);
+        }
+    }
+    m_coordinateShape.append(ArrayEndToken);
+    --m_depth;
+    return true;
+}
 
-    for (const QVariant &singleVariantFeature: extractedFeaturVariantList) {
-            featureMap = singleVariantFeature.value<QVariantMap>();
-            exportedFeature = exportFeature(featureMap);
-            valueFeature = exportedFeature;
-            array.append(valueFeature);
+/*
+    Completes the geometry object whose members scanStoreObject() went through, adding the
+    geometry before the members of its "geometries" already in the store, or its positions
+    from the coordinate tokens.
+*/
+bool GeoJsonTextParser::storeGeometry(QGeoJsonGeometryStore *store, StoreSpans *spans)
+{
+    const char *next = m_pos;
+    if (spans->type >= Point && spans->type < GeometryCollection) {
+        if (spans->written)
+            store->truncate(spans->firstGeometry, store->featureCount()); // "geometries" of no use
+        if (!(spans->imported & StoreCoordinates)) {
+            // the type did not allow them when the last "coordinates" was reached
+            m_coordinateShape.resize(spans->shapeBegin);
+            m_coordinateValues.resize(spans->valueBegin);
+            if (spans->coordinates) {
+                m_pos = spans->coordinates;
+                if (!scanCoordinateTokens())
+                    return false;
+            } else {
+                // imported like an empty array, as the QJsonDocument based import does
+                m_coordinateShape.append(ArrayBeginToken);
+                m_coordinateShape.append(ArrayEndToken);
+            }
+        }
+        store->addGeometry(QGeoJsonGeometryStore::GeometryType(spans->type));
+        m_shapePos = m_coordinateShape.constData() + spans->shapeBegin;
+        m_valuePos = m_coordinateValues.constData() + spans->valueBegin;
+        storeCoordinates(store, spans->type);
+    } else {
+        // importGeometry() falls back to GeometryCollection for unknown types
+        if (spans->written != StoreGeometries || !(spans->imported & StoreGeometries)) {
+            store->truncate(spans->firstGeometry, store->featureCount());
+            spans->childCount = 0;
+            if (spans->geometries) {
+                m_pos = spans->geometries;
+                if (!scanStoreList(store, &GeoJsonTextParser::scanStoreGeometry, &spans->childCount))
+                    return false;
+            }
+        }
+        store->insertGeometryCollection(spans->firstGeometry, spans->childCount);
     }
-    valueFeature = array;
-         qDebug() << " 13: " << keyType;
-                  qDebug() << " 14: " << valueType;
-    parsedFeatureCollection.insert(keyType, valueFeat);
-         qDebug() << " 12: " << parsedFeatureCollection;
-    parsedFeatureCollection.insert(keyFeature, valueFeature);
-    return parsedFeatureCollection;
+    m_coordinateShape.resize(spans->shapeBegin);
+    m_coordinateValues.resize(spans->valueBegin);
+    m_pos = next;
+    return true;
 }
 
-QVariantMap QGeoJson::importGeoJson(const QJsonDocument &importDoc)
+void GeoJsonTextParser::storeCoordinates(QGeoJsonGeometryStore *store, ObjectType type)
 {
-    QJsonObject object = importDoc.object(); // Read json object from imported doc
-    QVariantMap standardMap = object.toVariantMap(); // extraced map using Qt's API
-    qDebug() << " 2: " << standardMap;
+    switch (type) {
+    case Point:
+        storePointPart(store);
+        break;
+    case MultiPoint:
+        storeArray(store, &GeoJsonTextParser::storePointPart);
+        break;
+    case LineString:
+        storeLinePart(store);
+        break;
+    case MultiLineString:
+        storeArray(store, &GeoJsonTextParser::storeLinePart);
+        break;
+    case Polygon:
+        storePolygonPart(store);
+        break;
+    case MultiPolygon:
+        storeArray(store, &GeoJsonTextParser::storePolygonPart);
+        break;
+    default:
+        skipCoordinateToken();
+        break;
+    }
+}
 
-    QString geoType[] = {
-        QStringLiteral("Point"),
-        QStringLiteral("MultiPoint"),
-        QStringLiteral("LineString"),
-        QStringLiteral("MultiLineString"),
-        QStringLiteral("Polygon"),
-        QStringLiteral("MultiPolygon"),
-        QStringLiteral("GeometryCollection"),
-        QStringLiteral("Feature"),
-        QStringLiteral("FeatureCollection")
-    };
+void GeoJsonTextParser::storeArray(QGeoJsonGeometryStore *store, StoreElementParser parseElement)
+{
+    if (*m_shapePos != ArrayBeginToken) {
+        skipCoordinateToken(); // not an array, imported as an empty one
+        return;
+    }
+    ++m_shapePos;
+    while (*m_shapePos != ArrayEndToken)
+        (this->*parseElement)(store);
+    ++m_shapePos;
+}
 
-    enum geoTypeSwitch {
-        Point,
-        MultiPoint,
-        LineString,
-        MultiLineString,
-        Polygon,
-        MultiPolygon,
-        GeometryCollection,
-        Feature,
-        FeatureCollection
-    };
+void GeoJsonTextParser::storePolygonPart(QGeoJsonGeometryStore *store)
+{
+    store->addPart();
+    storeArray(store, &GeoJsonTextParser::storeRing);
+}
 
-    // Checking wether the JSON object has a "type" member
+void GeoJsonTextParser::storeLinePart(QGeoJsonGeometryStore *store)
+{
+    store->addPart();
+    storeRing(store);
+}
 
-    QString keyType = QStringLiteral("type");
+void GeoJsonTextParser::storePointPart(QGeoJsonGeometryStore *store)
+{
+    store->addPart();
+    store->addRing();
+    storePosition(store);
+}
 
-    QVariant keyVariant = standardMap.value(keyType);
-    qDebug() << " 3: " << keyVariant;
-        if (keyVariant == QVariant::Invalid) {
-             // [x] Type check failed
-        }
-    QString valueType = keyVariant.value<QString>();
-    int len = sizeof(geoType)/sizeof(*geoType);
+void GeoJsonTextParser::storeRing(QGeoJsonGeometryStore *store)
+{
+    store->addRing();
+    storeArray(store, &GeoJsonTextParser::storePosition);
+}
 
-    int i = 0; // index of the iteration where the value of type has been veryfied
+void GeoJsonTextParser::storePosition(QGeoJsonGeometryStore *store)
+{
+    // as importStorePosition(): missing values are NaN, values which are not numbers are 0
+    double values[3] = { qQNaN(), qQNaN(), qQNaN() };
+    int count = 0;
+    if (*m_shapePos == ArrayBeginToken) {
+        ++m_shapePos;
+        while (*m_shapePos != ArrayEndToken) {
+            double value = 0;
+            if (*m_shapePos == NumberToken) {
+                value = *m_valuePos++;
+                ++m_shapePos;
+            } else {
+                skipCoordinateToken();
+            }
+            if (count < 3)
+                values[count] = value;
+            ++count;
+        }
+        ++m_shapePos;
+    } else {
+        skipCoordinateToken();
+    }
 
-    // Checking whether the "type" member has a GeoJSON admitted value
+    if (count > 2)
+        store->addPosition(values[0], values[1], values[2]);
+    else
+        store->addPosition(values[0], values[1]);
+}
 
-    for (i=0; i<len-1; i++) {
-        qDebug() << " 3a-" << i << geoType[i];
-        qDebug() << " 3b-" << i << valueType;
-        if (valueType == geoType[i])
+void GeoJsonTextParser::skipCoordinateToken()
+{
+    int depth = 0;
+    do {
+        switch (*m_shapePos++) {
+        case ArrayBeginToken:
+            ++depth;
             break;
-        else if (i==len-1) {}
-    }
+        case ArrayEndToken:
+            --depth;
+            break;
+        case NumberToken:
+            ++m_valuePos;
+            break;
+        default:
+            break;
+        }
+    } while (depth > 0);
+}
 
-    QVariantMap parsedGeoJsonMap;
-    switch (i) {
-    case Point:
-    {
-        QString keyMap = QStringLiteral("Point");
-        QGeoCircle circle = importPoint(standardMap);
-        QVariant valueMap = QVariant::fromValue(circle);
+bool GeoJsonTextParser::parseValue(QVariant *value)
+{
+    if (m_pos >= m_end)
+        return setError(QJsonParseError::IllegalValue);
 
-        parsedGeoJsonMap.insert(keyMap, valueMap);
-        break;
+    switch (*m_pos) {
+    case '{':
+    {
+        QVariantMap map;
+        if (!parseMap(&map))
+            return false;
+        *value = map;
+        return true;
     }
-    case MultiPoint:
+    case '[':
     {
-        QString keyMap = QStringLiteral("MultiPoint"); // creating the key for the first element of the QVariantMap that will be returned
-        QVariantList multiCircle = importMultiPoint(standardMap);
-        QVariant valueMap = QVariant::fromValue(multiCircle); // wraps up the multiCircle item in a QVariant
-        QList <QGeoCircle> testlist;
-
-        parsedGeoJsonMap.insert(keyMap, valueMap);
-        break;
+        QVariantList list;
+        if (!parseList(&list))
+            return false;
+        *value = list;
+        return true;
     }
-    case LineString:
+    case '"':
     {
-        QString keyMap = QStringLiteral("LineString");
-        QGeoPath lineString = importLineString(standardMap);
-        QVariant valueMap = QVariant::fromValue(lineString);
-
-        parsedGeoJsonMap.insert(keyMap, valueMap);
+        QString string;
+        if (!parseString(&string))
+            return false;
+        *value = string;
+        return true;
+    }
+    case 't':
+        if (!parseLiteral("true", 4))
+            return false;
+        *value = true;
+        return true;
+    case 'f':
+        if (!parseLiteral("false", 5))
+            return false;
+        *value = false;
+        return true;
+    case 'n':
+        if (!parseLiteral("null", 4))
+            return false;
+        *value = QVariant::fromValue(nullptr); // as QJsonValue::toVariant()
+        return true;
+    default:
         break;
     }
-    case MultiLineString:
-    {
-        QString keyMap = QStringLiteral("MultiLineString");
-        QVariantList multiLineString = importMultiLineString(standardMap);
-        QVariant valueMap = QVariant::fromValue(multiLineString);
 
-        parsedGeoJsonMap.insert(keyMap, valueMap);
-        break;
+    double number;
+    if (!parseNumber(&number))
+        return setError(QJsonParseError::IllegalNumber);
+    *value = number;
+    return true;
+}
+
+bool GeoJsonTextParser::parseMap(QVariantMap *map)
+{
+    if (++m_depth > MaxDepth)
+        return setError(QJsonParseError::DeepNesting);
+    ++m_pos; // '{'
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == '}') {
+        ++m_pos;
+        --m_depth;
+        return true;
     }
-    case Polygon:
-    {
-        QString keyMap = QStringLiteral("Polygon");
-        QGeoPolygon poly = importPolygon(standardMap);
-        QVariant valueMap = QVariant::fromValue(poly);
-        qDebug() << "4:" << parsedGeoJsonMap;
-        parsedGeoJsonMap.insert(keyMap, valueMap);
 
-        break;
+    forever {
+        skipWhitespace();
+        if (m_pos >= m_end || *m_pos != '"')
+            return setError(QJsonParseError::UnterminatedObject);
+        QString key;
+        if (!parseString(&key))
+            return false;
+        skipWhitespace();
+        if (m_pos >= m_end || *m_pos != ':')
+            return setError(QJsonParseError::MissingNameSeparator);
+        ++m_pos;
+        skipWhitespace();
+        QVariant value;
+        if (!parseValue(&value))
+            return false;
+        map->insert(key, value);
+        skipWhitespace();
+        if (m_pos >= m_end)
+            return setError(QJsonParseError::UnterminatedObject);
+        const char c = *m_pos++;
+        if (c == '}')
+            break;
+        if (c != ',')
+            return setError(QJsonParseError::MissingValueSeparator);
     }
-    case MultiPolygon:
-    {
-        QString keyMap = QStringLiteral("MultiPolygon");
-        QVariantList multiPoly = importMultiPolygon(standardMap);
-        QVariant valueMap = QVariant::fromValue(multiPoly);
+    --m_depth;
+    return true;
+}
 
-        parsedGeoJsonMap.insert(keyMap, valueMap);
-        break;
+bool GeoJsonTextParser::parseList(QVariantList *list)
+{
+    if (++m_depth > MaxDepth)
+        return setError(QJsonParseError::DeepNesting);
+    ++m_pos; // '['
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == ']') {
+        ++m_pos;
+        --m_depth;
+        return true;
     }
-    case GeometryCollection: // list of GeoJson geometry objects
-    {
-        QString keyMap = QStringLiteral("GeometryCollection");
-        QVariantList multiGeo = importGeometryCollection(standardMap);
-        QVariant valueMap = QVariant::fromValue(multiGeo);
 
-        parsedGeoJsonMap.insert(keyMap, valueMap);
-        break;
+    forever {
+        skipWhitespace();
+        QVariant value;
+        if (!parseValue(&value))
+            return false;
+        list->append(value);
+        skipWhitespace();
+        if (m_pos >= m_end)
+            return setError(QJsonParseError::UnterminatedArray);
+        const char c = *m_pos++;
+        if (c == ']')
+            break;
+        if (c != ',')
+            return setError(QJsonParseError::MissingValueSeparator);
     }
-    case Feature: // single GeoJson geometry object with properties
-    {
-        QString keyMap = QStringLiteral("Feature");
-        QVariantMap feat = importFeature(standardMap);
-        QVariant valueMap = QVariant::fromValue(feat);
+    --m_depth;
+    return true;
+}
 
-        parsedGeoJsonMap.insert(keyMap, valueMap);
-        break;
+bool GeoJsonTextParser::parseString(QString *string)
+{
+    const char *begin;
+    const char *end;
+    bool escaped;
+    if (!scanString(&begin, &end, &escaped))
+        return false;
+    if (!escaped) {
+        *string = QString::fromUtf8(begin, int(end - begin));
+        return true;
     }
-    case FeatureCollection: // heterogeneous list of GeoJSON geometries with properties
-    {
-        QString keyMap = QStringLiteral("FeatureCollection");
-        QVariantList featCollection = importFeatureCollection(standardMap);
-        QVariant valueMap = QVariant::fromValue(featCollection);
+    return decodeString(begin, end, string);
+}
 
-        parsedGeoJsonMap.insert(keyMap, valueMap);
+bool GeoJsonTextParser::parseNumber(double *value)
+{
+    const char *next = parseJsonNumber(m_pos, m_end, value);
+    if (!next)
+        return false;
+    m_pos = next;
+    return true;
+}
+
+bool GeoJsonTextParser::parseLiteral(const char *literal, int length)
+{
+    if (m_end - m_pos < length || memcmp(m_pos, literal, size_t(length)) != 0)
+        return setError(QJsonParseError::IllegalValue);
+    m_pos += length;
+    return true;
+}
+
+bool GeoJsonTextParser::skipValue()
+{
+    if (m_pos >= m_end)
+        return setError(QJsonParseError::IllegalValue);
+
+    switch (*m_pos) {
+    case '{':
+    case '[':
+    {
+        const bool isObject = *m_pos == '{';
+        const char close = isObject ? '}' : ']';
+        if (++m_depth > MaxDepth)
+            return setError(QJsonParseError::DeepNesting);
+        ++m_pos;
+        skipWhitespace();
+        if (m_pos < m_end && *m_pos == close) {
+            ++m_pos;
+            --m_depth;
+            return true;
+        }
+        forever {
+            skipWhitespace();
+            if (isObject) {
+                const char *keyBegin;
+                const char *keyEnd;
+                bool escaped;
+                if (m_pos >= m_end || *m_pos != '"')
+                    return setError(QJsonParseError::UnterminatedObject);
+                if (!scanString(&keyBegin, &keyEnd, &escaped))
+                    return false;
+                skipWhitespace();
+                if (m_pos >= m_end || *m_pos != ':')
+                    return setError(QJsonParseError::MissingNameSeparator);
+                ++m_pos;
+                skipWhitespace();
+            }
+            if (!skipValue())
+                return false;
+            skipWhitespace();
+            if (m_pos >= m_end)
+                return setError(isObject ? QJsonParseError::UnterminatedObject : QJsonParseError::UnterminatedArray);
+            const char c = *m_pos++;
+            if (c == close)
+                break;
+            if (c != ',')
+                return setError(QJsonParseError::MissingValueSeparator);
+        }
+        --m_depth;
+        return true;
+    }
+    case '"':
+    {
+        const char *begin;
+        const char *end;
+        bool escaped;
+        return scanString(&begin, &end, &escaped);
+    }
+    case 't':
+        return parseLiteral("true", 4);
+    case 'f':
+        return parseLiteral("false", 5);
+    case 'n':
+        return parseLiteral("null", 4);
+    default:
         break;
     }
+
+    if (!skipNumber())
+        return setError(QJsonParseError::IllegalNumber);
+    return true;
+}
+
+bool GeoJsonTextParser::skipNumber()
+{
+    const char *next = skipJsonNumber(m_pos, m_end);
+    if (!next)
+        return false;
+    m_pos = next;
+    return true;
+}
+
+bool GeoJsonTextParser::scanString(const char **begin, const char **end, bool *escaped)
+{
+    ++m_pos; // '"'
+    const char *start = m_pos;
+    bool hasEscape = false;
+    while (m_pos < m_end) {
+        const char c = *m_pos;
+        if (c == '"') {
+            *begin = start;
+            *end = m_pos;
+            *escaped = hasEscape;
+            ++m_pos;
+            return true;
+        }
+        if (c == '\\') {
+            hasEscape = true;
+            if (++m_pos >= m_end)
+                break;
+        }
+        ++m_pos;
     }
+    return setError(QJsonParseError::UnterminatedString);
+}
 
-    // searching for the bbox member, if found, copy it to the output QVariantMap
-    QString keyMap = QStringLiteral("bbox");
-    QVariant bboxValue = standardMap.value(keyMap);
-    if (bboxValue != QVariant::Invalid) {
-        parsedGeoJsonMap.insert(keyMap, bboxValue);
+bool GeoJsonTextParser::decodeString(const char *begin, const char *end, QString *string)
+{
+    QByteArray utf8;
+    utf8.reserve(int(end - begin));
+    for (const char *p = begin; p < end; ++p) {
+        if (*p != '\\') {
+            utf8.append(*p);
+            continue;
+        }
+        ++p;
+        switch (*p) {
+        case '"':
+        case '\\':
+        case '/':
+            utf8.append(*p);
+            break;
+        case 'b':
+            utf8.append('\b');
+            break;
+        case 'f':
+            utf8.append('\f');
+            break;
+        case 'n':
+            utf8.append('\n');
+            break;
+        case 'r':
+            utf8.append('\r');
+            break;
+        case 't':
+            utf8.append('\t');
+            break;
+        case 'u':
+        {
+            uint code;
+            if (!parseHex4(p + 1, end, &code))
+                return setError(QJsonParseError::IllegalEscapeSequence);
+            p += 4;
+            if (QChar::isHighSurrogate(code) && end - p > 6 && p[1] == '\\' && p[2] == 'u') {
+                uint low;
+                if (parseHex4(p + 3, end, &low) && QChar::isLowSurrogate(low)) {
+                    code = QChar::surrogateToUcs4(ushort(code), ushort(low));
+                    p += 6;
+                }
+            }
+            appendUtf8(&utf8, code);
+            break;
+        }
+        default:
+            return setError(QJsonParseError::IllegalEscapeSequence);
+        }
     }
-    return parsedGeoJsonMap;
+    *string = QString::fromUtf8(utf8);
+    return true;
 }
 
-QJsonDocument QGeoJson::exportGeoJson(const QVariantMap &exportMap)
+static QJsonValue exportPointCoordinates(const QGeoCoordinate &obtainedCoordinates)
 {
-    qDebug() << " 5: " << exportMap;
-    QJsonObject newObject;
-    QJsonDocument newDocument;
-    if (exportMap.contains(QStringLiteral("Point"))) // check if the map contains the key Point
-        newObject = exportPoint(exportMap);
-    if (exportMap.contains(QStringLiteral("MultiPoint")))
-        newObject = exportMultiPoint(exportMap);
-    if (exportMap.contains(QStringLiteral("LineString")))
-        newObject = exportLineString(exportMap);
-    if (exportMap.contains(QStringLiteral("MultiLineString")))
-        newObject = exportMultiLineString(exportMap);
-    if (exportMap.contains(QStringLiteral("Polygon"))){
-        qDebug() << " 6: " << exportMap;
-        newObject = exportPolygon(exportMap);
-            qDebug() << " 7: " << newObject;}
-    if (exportMap.contains(QStringLiteral("MultiPolygon")))
-        newObject = exportMultiPolygon(exportMap);
-    if (exportMap.contains(QStringLiteral("GeometryCollection")))
-        newObject = exportGeometry(exportMap);
-    if (exportMap.contains(QStringLiteral("Feature")))
-        newObject = exportFeature(exportMap);
-    if (exportMap.contains(QStringLiteral("FeatureCollection")))
-        newObject = exportFeatureCollection(exportMap);
-    newDocument.setObject(newObject);
-    return newDocument;
+    QJsonValue geoLat = obtainedCoordinates.latitude();
+    QJsonValue geoLong = obtainedCoordinates.longitude();
+
+    QJsonArray array = {geoLat, geoLong};
+    QJsonValue geoAlt;
+
+    if (!qIsNaN(obtainedCoordinates.altitude())) {
+        geoAlt = obtainedCoordinates.altitude();
+        array.append(geoAlt);
+    }
+    QJsonValue geoArray = array;
+    return geoArray;
+}
+
+static QJsonValue exportLineStringCoordinates(const QList<QGeoCoordinate> &obtainedCoordinatesList)
+{
+    QJsonValue lineCoordinates;
+    QJsonValue multiPosition;
+    QJsonArray arrayPosition;
+
+    for (const QGeoCoordinate &pointCoordinates: obtainedCoordinatesList) {
+        multiPosition = exportPointCoordinates(pointCoordinates);
+        arrayPosition.append(multiPosition);
+    }
+    lineCoordinates = arrayPosition;
+    return lineCoordinates;
+}
+
+static QJsonValue exportPolygonCoordinates(const QList<QList<QGeoCoordinate>> &obtainedCoordinates)
+{
+    QJsonValue lineCoordinates;
+    QJsonValue polyCoordinates;
+    QJsonArray arrayPath;
+    for (const QList<QGeoCoordinate> &parsedPath: obtainedCoordinates) {
+        lineCoordinates = exportLineStringCoordinates(parsedPath);
+        arrayPath.append(lineCoordinates);
+    }
+    polyCoordinates = arrayPath;
+    return polyCoordinates;
+}
+
+static QJsonObject exportPoint(const QVariantMap &pointMap)
+{
+    QJsonObject parsedPoint;
+
+    QString keyType = QStringLiteral("type");
+    QString keyCoord = QStringLiteral("coordinates");
+    QString valuePoint = QStringLiteral("Point");
+
+    QVariant geoCircle = pointMap.value(valuePoint); // exporting the value of "Point" QVariantMap node in a QVariant
+    QGeoCircle circle = geoCircle.value<QGeoCircle>();
+    QGeoCoordinate center = circle.center();
+    QJsonValue valueType = valuePoint;
+
+    parsedPoint.insert(keyType,valueType);
+    parsedPoint.insert(keyCoord, exportPointCoordinates(center));
+    return parsedPoint;
+}
+
+static QJsonObject exportLineString(const QVariantMap &lineStringMap)
+{
+    QJsonObject parsedMultiPoint;
+
+    QString keyType = QStringLiteral("type");
+    QString keyCoord = QStringLiteral("coordinates");
+
+    QString valueLineString = QStringLiteral("LineString");
+
+    QJsonValue lineCoordinates;
+
+    QList <QGeoCoordinate> lineCoordinatesList;
+    QVariant pathVariant = lineStringMap.value(valueLineString);
+    QJsonValue valueType = valueLineString;
+
+    QGeoPath parsedPath;
+    parsedPath = pathVariant.value<QGeoPath>();
+
+    lineCoordinatesList = parsedPath.path();
+    lineCoordinates = exportLineStringCoordinates(lineCoordinatesList);
+
+    parsedMultiPoint.insert(keyType, valueType);
+    parsedMultiPoint.insert(keyCoord, lineCoordinates);
+    return parsedMultiPoint;
+}
+
+static QJsonObject exportPolygon(const QVariantMap &polygonMap)
+{
+    QJsonObject parsedPolygon;
+
+    QString keyType = QStringLiteral("type");
+
+    QString keyCoord = QStringLiteral("coordinates");
+
+    QString valuePolygon = QStringLiteral("Polygon");
+    QJsonValue polyCoordinates;
+
+    QGeoPolygon parsedPoly;
+
+    QList<QList<QGeoCoordinate>> obtainedCoordinatesPoly;
+    QVariant polygonVariant = polygonMap.value(valuePolygon);
+
+    QJsonValue valueType = valuePolygon;
+
+    parsedPoly = polygonVariant.value<QGeoPolygon>();
+    obtainedCoordinatesPoly << parsedPoly.path();
+
+    if (parsedPoly.holesCount()!=0)
+        for (int i = 0; i<parsedPoly.holesCount(); i++) {
+            obtainedCoordinatesPoly << parsedPoly.holePath(i);
+        }
+    polyCoordinates = exportPolygonCoordinates(obtainedCoordinatesPoly);
+    parsedPolygon.insert(keyType, valueType);
+    parsedPolygon.insert(keyCoord, polyCoordinates);
+    return parsedPolygon;
+}
+
+static QJsonObject exportMultiPoint(const QVariantMap &multiPointMap)
+{
+    QJsonObject parsedMultiPoint;
+
+    QString keyType = QStringLiteral("type");
+    QString keyCoord = QStringLiteral("coordinates");
+
+    QString valueMultiPoint = QStringLiteral("MultiPoint");
+
+    QJsonValue multiPosition;
+
+    QList <QGeoCoordinate> obtainedCoordinatesMP;
+    QVariant multiCircleVariant = multiPointMap.value(valueMultiPoint);
+    QVariantList multiCircleVariantList = multiCircleVariant.value<QVariantList>();
+    QJsonValue typeValue = valueMultiPoint;
+
+    for (const QVariant &exCircle: multiCircleVariantList) {
+        obtainedCoordinatesMP << exCircle.value<QGeoCircle>().center();
+    }
+    multiPosition = exportLineStringCoordinates(obtainedCoordinatesMP);
+
+    parsedMultiPoint.insert(keyType, typeValue);
+    parsedMultiPoint.insert(keyCoord, multiPosition);
+    return parsedMultiPoint;
+}
+
+static QJsonObject exportMultiLineString(const QVariantMap &multiLineStringMap)
+{
+    QJsonObject parsedMultiLineString;
+
+    QString keyType = QStringLiteral("type");
+    QString keyCoord = QStringLiteral("coordinates");
+    QString valueMultiLineString = QStringLiteral("MultiLineString");
+
+    QList<QList<QGeoCoordinate>> obtainedCoordinatesMLS;
+    QVariant multiPathVariant = multiLineStringMap.value(valueMultiLineString);
+    QVariantList multiPathList = multiPathVariant.value<QVariantList>();
+    QJsonValue typeValue = valueMultiLineString;
+
+    for (const QVariant &singlePath: multiPathList ){
+        obtainedCoordinatesMLS << singlePath.value<QGeoPath>().path();
+    }
+
+    parsedMultiLineString.insert(keyType, typeValue);
+    parsedMultiLineString.insert(keyCoord, exportPolygonCoordinates(obtainedCoordinatesMLS));
+    return parsedMultiLineString;
+}
+
+static QJsonObject exportMultiPolygon(const QVariantMap &multiPolygonMap)
+{
+    QJsonObject parsedMultiPolygon;
+
+    QString keyType = QStringLiteral("type");
+    QString keyCoord = QStringLiteral("coordinates");
+    QString valueMultiPolygon = QStringLiteral("MultiPolygon");
+
+    QJsonValue polyCoordinates;
+
+    QJsonArray parsedArrayPolygon;
+    QList<QList<QGeoCoordinate>> obtainedPolyCoordinates;
+
+    QVariant multiPolygonVariant = multiPolygonMap.value(valueMultiPolygon);
+    QVariantList multiPolygonList = multiPolygonVariant.value<QVariantList>();
+
+    QJsonValue typeValue = valueMultiPolygon;
+    int polyHoles = 0;
+    int currentHole;
+
+    for (const QVariant &singlePoly: multiPolygonList ) { // Start parsing èolygon list
+        obtainedPolyCoordinates << singlePoly.value<QGeoPolygon>().path(); // Extract external polygon path
+        polyHoles = singlePoly.value<QGeoPolygon>().holesCount();
+
+        if (polyHoles) //Check if the polygon has holes
+            for (currentHole = 0 ; currentHole<polyHoles; currentHole++)
+                obtainedPolyCoordinates << singlePoly.value<QGeoPolygon>().holePath(currentHole);
+        polyCoordinates = exportPolygonCoordinates(obtainedPolyCoordinates); //Generates QJsonDocument compatible value
+        parsedArrayPolygon.append(polyCoordinates); // Adds one level of nesting in coordinates
+        obtainedPolyCoordinates.clear(); // Clears the temporary polygon linear ring storage
+    }
+    QJsonValue parsed = parsedArrayPolygon;
+
+    parsedMultiPolygon.insert(keyType, typeValue);
+    parsedMultiPolygon.insert(keyCoord, parsed);
+    return parsedMultiPolygon;
+}
+
+static QJsonObject exportGeometry(const QVariantMap &geometryMap);
+
+static QJsonObject exportGeometryCollection(const QVariantMap &geometryCollection)
+{
+    QString keyType = QStringLiteral("type");
+    QString keyGeometries = QStringLiteral("geometries");
+    QString valueGeometryCollection = QStringLiteral("GeometryCollection");
+
+    QJsonObject parsed;
+    QJsonObject parsedGeometry;
+    QVariantList geometriesList;
+
+    QJsonValue valueGeometries;
+    QJsonArray parsedGeometries;
+
+    geometriesList = geometryCollection.value(valueGeometryCollection).value<QVariantList>();
+    for (const QVariant &extractedGeometry: geometriesList){
+        parsedGeometry = exportGeometry(extractedGeometry.value<QVariantMap>());
+        valueGeometries = parsedGeometry;
+        parsedGeometries.append(valueGeometries);
+    }
+    valueGeometries = parsedGeometries;
+    QJsonValue valueType = valueGeometryCollection;
+
+    parsed.insert(keyType, valueType);
+    parsed.insert(keyGeometries, valueGeometries);
+    return parsed;
+}
+
+static QJsonObject exportGeometry(const QVariantMap &geometryMap)
+{
+    QJsonObject newObject;
+    QJsonDocument newDocument;
+    if (geometryMap.contains(QStringLiteral("Point"))) // check if the map contains the key Point
+        newObject = exportPoint(geometryMap);
+    if (geometryMap.contains(QStringLiteral("MultiPoint"))) // check if the map contains the key MultiPoint
+        newObject = exportMultiPoint(geometryMap);
+    if (geometryMap.contains(QStringLiteral("LineString")))
+        newObject = exportLineString(geometryMap);
+    if (geometryMap.contains(QStringLiteral("MultiLineString")))
+        newObject = exportMultiLineString(geometryMap);
+        newDocument.setObject(newObject);
+    if (geometryMap.contains(QStringLiteral("Polygon")))
+        newObject = exportPolygon(geometryMap);
+    if (geometryMap.contains(QStringLiteral("MultiPolygon")))
+        newObject = exportMultiPolygon(geometryMap);
+    if (geometryMap.contains(QStringLiteral("GeometryCollection")))
+        newObject = exportGeometryCollection(geometryMap);
+    return newObject;
+}
+
+static QJsonObject exportFeature(const QVariantMap &feature)
+{
+    QString keyType = QStringLiteral("type");
+    QString keyFeature = QStringLiteral("geometry");
+    QString keyProp = QStringLiteral("properties");
+    QString keyId = QStringLiteral("id");
+    QString valueFeat = QStringLiteral("Feature");
+
+    QJsonObject parsedFeature;
+    QJsonObject exportedFeature;
+    QJsonObject exportedProp;
+    QJsonObject valueProp;
+
+    QVariantMap featureMap;
+    QVariantMap feat;
+
+    QJsonValue valueFeature;
+    QJsonValue valueProperties;
+    QJsonValue valueId;
+
+    featureMap = feature.value(valueFeat).value<QVariantMap>();
+    QJsonValue valueType = valueFeat;
+    feat = featureMap.value(keyFeature).value<QVariantMap>();
+    exportedFeature = exportGeometry(feat);
+    valueFeature = exportedFeature;
+
+    feat = featureMap.value(keyProp).value<QVariantMap>();
+
+    parsedFeature.insert(keyType, valueType);
+    parsedFeature.insert(keyFeature, valueFeature);
+
+    valueProp = featureMap.value(keyProp).value<QVariant>().toJsonObject();
+    valueProperties = valueProp;
+    parsedFeature.insert(keyProp, valueProperties);
+
+    valueId = featureMap.value(keyId).value<QVariant>().toJsonValue();
+    parsedFeature.insert(keyId, valueId);
+    return parsedFeature;
+}
+
+static QJsonObject exportFeatureCollection(const QVariantMap &featureCollection)
+{
+    QString keyType = QStringLiteral("type");
+    QString keyFeature = QStringLiteral("features");
+    QString valueFeat = QStringLiteral("FeatureCollection");
+
+    QJsonObject parsedFeatureCollection;
+    QJsonObject exportedFeature;
+
+    QVariantMap featureMap;
+    QVariantMap featfeat;
+
+    QJsonValue valueType;
+    QJsonArray array;
+
+    QVariant extractedFeatureVariant = featureCollection.value(valueFeat);
+    QVariantList extractedFeaturVariantList = extractedFeatureVariant.value<QVariantList>();
+    QJsonValue valueFeature = valueFeat;
+
+
+
+    for (const QVariant &singleVariantFeature: extractedFeaturVariantList) {
+            featureMap = singleVariantFeature.value<QVariantMap>();
+            exportedFeature = exportFeature(featureMap);
+            valueFeature = exportedFeature;
+            array.append(valueFeature);
+    }
+    valueFeature = array;
+    parsedFeatureCollection.insert(keyType, valueFeat);
+    parsedFeatureCollection.insert(keyFeature, valueFeature);
+    return parsedFeatureCollection;
+}
+
+// Columnar import and export, working on the JSON values without creating QGeoCoordinate objects
+
+static void importStorePosition(QGeoJsonGeometryStore *store, const QJsonValue &position)
+{
+    const QJsonArray array = position.toArray();
+    const double x = array.size() > 0 ? array.at(0).toDouble() : qQNaN();
+    const double y = array.size() > 1 ? array.at(1).toDouble() : qQNaN();
+    if (array.size() > 2)
+        store->addPosition(x, y, array.at(2).toDouble());
+    else
+        store->addPosition(x, y);
+}
+
+static void importStoreRing(QGeoJsonGeometryStore *store, const QJsonValue &ring)
+{
+    store->addRing();
+    const QJsonArray positions = ring.toArray();
+    for (const QJsonValue &position: positions)
+        importStorePosition(store, position);
+}
+
+static void importStoreGeometry(QGeoJsonGeometryStore *store, const QJsonObject &geometry)
+{
+    const QString type = geometry.value(QStringLiteral("type")).toString();
+    int i = QGeoJsonGeometryStore::Point;
+    for (; i < QGeoJsonGeometryStore::GeometryCollection; ++i) {
+        if (type == QLatin1String(geoJsonTypeNames[i]))
+            break;
+    }
+
+    const QJsonArray coordinates = geometry.value(QStringLiteral("coordinates")).toArray();
+    switch (i) {
+    case QGeoJsonGeometryStore::Point:
+        store->addGeometry(QGeoJsonGeometryStore::Point);
+        store->addPart();
+        store->addRing();
+        importStorePosition(store, coordinates);
+        break;
+    case QGeoJsonGeometryStore::MultiPoint:
+        store->addGeometry(QGeoJsonGeometryStore::MultiPoint);
+        for (const QJsonValue &position: coordinates) {
+            store->addPart();
+            store->addRing();
+            importStorePosition(store, position);
+        }
+        break;
+    case QGeoJsonGeometryStore::LineString:
+        store->addGeometry(QGeoJsonGeometryStore::LineString);
+        store->addPart();
+        importStoreRing(store, coordinates);
+        break;
+    case QGeoJsonGeometryStore::MultiLineString:
+        store->addGeometry(QGeoJsonGeometryStore::MultiLineString);
+        for (const QJsonValue &path: coordinates) {
+            store->addPart();
+            importStoreRing(store, path);
+        }
+        break;
+    case QGeoJsonGeometryStore::Polygon:
+        store->addGeometry(QGeoJsonGeometryStore::Polygon);
+        store->addPart();
+        for (const QJsonValue &ring: coordinates)
+            importStoreRing(store, ring);
+        break;
+    case QGeoJsonGeometryStore::MultiPolygon:
+        store->addGeometry(QGeoJsonGeometryStore::MultiPolygon);
+        for (const QJsonValue &polygon: coordinates) {
+            store->addPart();
+            const QJsonArray rings = polygon.toArray();
+            for (const QJsonValue &ring: rings)
+                importStoreRing(store, ring);
+        }
+        break;
+    default: // importGeometry() falls back to GeometryCollection for unknown types
+    {
+        const QJsonArray geometries = geometry.value(QStringLiteral("geometries")).toArray();
+        store->addGeometry(QGeoJsonGeometryStore::GeometryCollection, geometries.size());
+        for (const QJsonValue &member: geometries)
+            importStoreGeometry(store, member.toObject());
+        break;
+    }
+    }
+}
+
+static void importStoreFeature(QGeoJsonGeometryStore *store, const QJsonObject &feature)
+{
+    const int geometry = store->geometryCount();
+    importStoreGeometry(store, feature.value(QStringLiteral("geometry")).toObject());
+    store->addFeature(geometry,
+                      feature.value(QStringLiteral("properties")).toVariant(),
+                      feature.value(QStringLiteral("id")).toVariant());
+}
+
+static QJsonArray exportStorePosition(const QGeoJsonGeometryStore::CoordinateView &view, int i)
+{
+    QJsonArray array = {view.x[i], view.y[i]};
+    if (view.z && !qIsNaN(view.z[i]))
+        array.append(view.z[i]);
+    return array;
+}
+
+static QJsonArray exportStoreRing(const QGeoJsonGeometryStore::CoordinateView &view)
+{
+    QJsonArray array;
+    for (int i = 0; i < view.size; ++i)
+        array.append(exportStorePosition(view, i));
+    return array;
+}
+
+static QJsonArray exportStoreRings(const QGeoJsonGeometryStore &store, int geometry, int part)
+{
+    QJsonArray array;
+    const int rings = store.ringCount(geometry, part);
+    for (int ring = 0; ring < rings; ++ring)
+        array.append(exportStoreRing(store.ring(geometry, part, ring)));
+    return array;
+}
+
+static QJsonObject exportStoreGeometry(const QGeoJsonGeometryStore &store, int *geometry)
+{
+    const int g = (*geometry)++;
+    const QGeoJsonGeometryStore::GeometryType type = store.geometryType(g);
+    const int parts = store.partCount(g);
+
+    QJsonObject parsedGeometry;
+    parsedGeometry.insert(QStringLiteral("type"), QString::fromLatin1(geoJsonTypeNames[type]));
+
+    QJsonArray coordinates;
+    switch (type) {
+    case QGeoJsonGeometryStore::Point:
+        parsedGeometry.insert(QStringLiteral("coordinates"), exportStorePosition(store.ring(g, 0, 0), 0));
+        return parsedGeometry;
+    case QGeoJsonGeometryStore::MultiPoint:
+        for (int part = 0; part < parts; ++part)
+            coordinates.append(exportStorePosition(store.ring(g, part, 0), 0));
+        break;
+    case QGeoJsonGeometryStore::LineString:
+        coordinates = exportStoreRing(store.ring(g, 0, 0));
+        break;
+    case QGeoJsonGeometryStore::MultiLineString:
+        for (int part = 0; part < parts; ++part)
+            coordinates.append(exportStoreRing(store.ring(g, part, 0)));
+        break;
+    case QGeoJsonGeometryStore::Polygon:
+        coordinates = exportStoreRings(store, g, 0);
+        break;
+    case QGeoJsonGeometryStore::MultiPolygon:
+        for (int part = 0; part < parts; ++part)
+            coordinates.append(exportStoreRings(store, g, part));
+        break;
+    case QGeoJsonGeometryStore::GeometryCollection:
+    {
+        QJsonArray geometries;
+        const int members = store.childCount(g);
+        for (int i = 0; i < members; ++i)
+            geometries.append(exportStoreGeometry(store, geometry));
+        parsedGeometry.insert(QStringLiteral("geometries"), geometries);
+        return parsedGeometry;
+    }
+    }
+    parsedGeometry.insert(QStringLiteral("coordinates"), coordinates);
+    return parsedGeometry;
+}
+
+static QJsonObject exportStoreFeature(const QGeoJsonGeometryStore &store, int feature)
+{
+    QJsonObject parsedFeature;
+    int geometry = store.featureGeometry(feature);
+    parsedFeature.insert(QStringLiteral("type"), QStringLiteral("Feature"));
+    parsedFeature.insert(QStringLiteral("geometry"), exportStoreGeometry(store, &geometry));
+    parsedFeature.insert(QStringLiteral("properties"), store.featureProperties(feature).toJsonObject());
+    parsedFeature.insert(QStringLiteral("id"), store.featureId(feature).toJsonValue());
+    return parsedFeature;
+}
+
+// Statistics, compiled out with QGEOJSON_NO_STATS
+
+#ifndef QGEOJSON_NO_STATS
+
+Q_LOGGING_CATEGORY(lcGeoJson, "qt.positioning.geojson")
+
+static void countGeometry(QGeoJsonStats *stats, const QVariantMap &geometryMap)
+{
+    QVariantMap::const_iterator iter;
+    for (iter = geometryMap.begin(); iter != geometryMap.end(); ++iter) {
+        const QString &key = iter.key();
+        if (key == QStringLiteral("Point")) {
+            ++stats->geometryCounts[QGeoJsonGeometryStore::Point];
+            ++stats->vertexCount;
+        } else if (key == QStringLiteral("LineString")) {
+            ++stats->geometryCounts[QGeoJsonGeometryStore::LineString];
+            stats->vertexCount += iter.value().value<QGeoPath>().size();
+        } else if (key == QStringLiteral("Polygon") || key == QStringLiteral("MultiPolygon")) {
+            QVariantList polygons;
+            if (key == QStringLiteral("Polygon")) {
+                ++stats->geometryCounts[QGeoJsonGeometryStore::Polygon];
+                polygons.append(iter.value());
+            } else {
+                ++stats->geometryCounts[QGeoJsonGeometryStore::MultiPolygon];
+                polygons = iter.value().value<QVariantList>();
+            }
+            for (const QVariant &polygonVariant: qAsConst(polygons)) {
+                const QGeoPolygon polygon = polygonVariant.value<QGeoPolygon>();
+                stats->ringCount += 1 + polygon.holesCount();
+                stats->vertexCount += polygon.size();
+                for (int i = 0; i < polygon.holesCount(); ++i)
+                    stats->vertexCount += polygon.holePath(i).size();
+            }
+        } else if (key == QStringLiteral("MultiPoint")) {
+            ++stats->geometryCounts[QGeoJsonGeometryStore::MultiPoint];
+            stats->vertexCount += iter.value().value<QVariantList>().size();
+        } else if (key == QStringLiteral("MultiLineString")) {
+            ++stats->geometryCounts[QGeoJsonGeometryStore::MultiLineString];
+            for (const QVariant &path: iter.value().value<QVariantList>())
+                stats->vertexCount += path.value<QGeoPath>().size();
+        } else if (key == QStringLiteral("GeometryCollection")) {
+            ++stats->geometryCounts[QGeoJsonGeometryStore::GeometryCollection];
+            for (const QVariant &geometry: iter.value().value<QVariantList>())
+                countGeometry(stats, geometry.value<QVariantMap>());
+        }
+    }
+}
+
+static void countFeature(QGeoJsonStats *stats, const QVariantMap &feature)
+{
+    ++stats->featureCount;
+    countGeometry(stats, feature.value(QStringLiteral("geometry")).value<QVariantMap>());
+}
+
+class GeoJsonStatsRecorder
+{
+public:
+    explicit GeoJsonStatsRecorder(QGeoJsonStats *stats)
+        : m_stats(stats)
+    {
+        if (m_stats) {
+            m_stats->reset();
+            m_timer.start();
+        }
+    }
+
+    ~GeoJsonStatsRecorder()
+    {
+        if (m_stats)
+            qCDebug(lcGeoJson) << *m_stats;
+    }
+
+    void addTime(qint64 QGeoJsonStats::*phase)
+    {
+        if (!m_stats)
+            return;
+        m_stats->*phase += m_timer.nsecsElapsed();
+        m_timer.start();
+    }
+
+    void addBytesIn(qint64 size)
+    {
+        if (m_stats)
+            m_stats->bytesIn += size;
+    }
+
+    void addBytesOut(qint64 size)
+    {
+        if (m_stats)
+            m_stats->bytesOut += size;
+    }
+
+    // walks an imported, or to be exported, map; not accounted to any phase
+    void count(const QVariantMap &geojsonMap)
+    {
+        if (!m_stats)
+            return;
+        if (geojsonMap.contains(QStringLiteral("FeatureCollection"))) {
+            for (const QVariant &feature: geojsonMap.value(QStringLiteral("FeatureCollection")).value<QVariantList>())
+                countFeature(m_stats, feature.value<QVariantMap>().value(QStringLiteral("Feature")).value<QVariantMap>());
+        } else if (geojsonMap.contains(QStringLiteral("Feature"))) {
+            countFeature(m_stats, geojsonMap.value(QStringLiteral("Feature")).value<QVariantMap>());
+        } else {
+            countGeometry(m_stats, geojsonMap);
+        }
+        m_timer.start();
+    }
+
+private:
+    QGeoJsonStats *m_stats;
+    QElapsedTimer m_timer;
+};
+
+#else
+
+class GeoJsonStatsRecorder
+{
+public:
+    explicit GeoJsonStatsRecorder(QGeoJsonStats *) {}
+
+    void addTime(qint64 QGeoJsonStats::*) {}
+    void addBytesIn(qint64) {}
+    void addBytesOut(qint64) {}
+    void count(const QVariantMap &) {}
+};
+
+#endif // QGEOJSON_NO_STATS
+
+/*! \class QGeoJsonStats
+    \inmodule Qt.labs.location
+    \ingroup json
+    \since WIP
+
+    \brief The QGeoJsonStats structure reports where the time of an import or export goes.
+
+    Pass a pointer to a QGeoJsonStats in QGeoJson::ImportOptions::stats or
+    QGeoJson::ExportOptions::stats to have it reset and filled by the call. Times are wall
+    times in nanoseconds, per phase: parsing the text, QJsonObject::toVariantMap(), conversion
+    between JSON values and QGeoShape objects, and serialization of the exported document.
+    The counts describe the imported map, or the map exported. When a summary is also wanted
+    in the log, enable debug output for the "qt.positioning.geojson" logging category.
+
+    When QGEOJSON_NO_STATS is defined, no statistics are collected and the structure is left
+    untouched.
+*/
+
+void QGeoJsonStats::reset()
+{
+    parseTime = 0;
+    variantTime = 0;
+    conversionTime = 0;
+    serializationTime = 0;
+    featureCount = 0;
+    for (int &count: geometryCounts)
+        count = 0;
+    ringCount = 0;
+    vertexCount = 0;
+    bytesIn = 0;
+    bytesOut = 0;
+}
+
+#ifndef QT_NO_DEBUG_STREAM
+QDebug operator<<(QDebug debug, const QGeoJsonStats &stats)
+{
+    QDebugStateSaver saver(debug);
+    debug.nospace() << "QGeoJsonStats(parse " << stats.parseTime / 1000 << "us, variant "
+                    << stats.variantTime / 1000 << "us, conversion " << stats.conversionTime / 1000
+                    << "us, serialization " << stats.serializationTime / 1000 << "us, "
+                    << stats.featureCount << " features,";
+    for (int i = 0; i < 7; ++i)
+        debug << ' ' << stats.geometryCounts[i] << ' ' << geoJsonTypeNames[i] << ',';
+    debug << ' ' << stats.ringCount << " rings, " << stats.vertexCount << " vertices, "
+          << stats.bytesIn << " bytes in, " << stats.bytesOut << " bytes out)";
+    return debug;
+}
+#endif
+
+// Memory accounting: heap bytes of the Qt 5 containers and shapes of the importGeoJson()
+// layout on a 64-bit platform, each allocation having a 16-byte malloc header and being
+// rounded up to 16 bytes. Values held inside a QVariant or a container slot cost nothing more.
+
+static const qint64 ListHeaderBytes = 16; // QListData::Data, before the slots
+static const qint64 MapHeaderBytes = 56; // QMapData
+static const qint64 MapNodeBytes = 48; // QMapNode<QString, QVariant>
+static const qint64 ArrayHeaderBytes = 24; // QArrayData of QString and QByteArray
+static const qint64 SharedVariantBytes = 16; // QVariant::PrivateShared holding a QGeoShape
+static const qint64 CoordinatePrivateBytes = 32;
+static const qint64 CirclePrivateBytes = 56;
+static const qint64 PathPrivateBytes = 96;
+static const qint64 PolygonPrivateBytes = 120;
+
+static inline qint64 allocationBytes(qint64 size)
+{
+    return (size + 16 + 15) & ~qint64(15);
+}
+
+static inline qint64 stringBytes(int length)
+{
+    return length ? allocationBytes(ArrayHeaderBytes + 2 * (qint64(length) + 1)) : 0;
+}
+
+static inline qint64 mapNodeBytes(const QString &key)
+{
+    return allocationBytes(MapNodeBytes) + stringBytes(key.size());
+}
+
+// QVariant is a large type for QList, every element has its own allocation
+static inline qint64 variantListStructureBytes(int size)
+{
+    return size ? allocationBytes(ListHeaderBytes + 8 * qint64(size)) + size * allocationBytes(16) : 0;
+}
+
+static inline qint64 coordinateListBytes(int size)
+{
+    return size ? allocationBytes(ListHeaderBytes + 8 * qint64(size)) + size * allocationBytes(CoordinatePrivateBytes) : 0;
+}
+
+static inline qint64 circleBytes()
+{
+    return allocationBytes(SharedVariantBytes) + allocationBytes(CirclePrivateBytes)
+            + allocationBytes(CoordinatePrivateBytes);
+}
+
+static inline qint64 pathBytes(int size)
+{
+    return allocationBytes(SharedVariantBytes) + allocationBytes(PathPrivateBytes) + coordinateListBytes(size);
+}
+
+// the perimeter and the holes are added separately, with coordinateListBytes()
+static inline qint64 polygonShapeBytes(int holeCount)
+{
+    return allocationBytes(SharedVariantBytes) + allocationBytes(PolygonPrivateBytes)
+            + (holeCount ? allocationBytes(ListHeaderBytes + 8 * qint64(holeCount)) : 0);
+}
+
+static qint64 variantBytes(const QVariant &value);
+
+static qint64 variantMapBytes(const QVariantMap &map)
+{
+    if (map.isEmpty())
+        return 0;
+    qint64 bytes = allocationBytes(MapHeaderBytes);
+    for (QVariantMap::const_iterator iter = map.constBegin(); iter != map.constEnd(); ++iter)
+        bytes += mapNodeBytes(iter.key()) + variantBytes(iter.value());
+    return bytes;
+}
+
+static qint64 variantBytes(const QVariant &value)
+{
+    const int type = value.userType();
+    if (type == QMetaType::QString)
+        return stringBytes(value.toString().size());
+    if (type == QMetaType::QByteArray)
+        return allocationBytes(ArrayHeaderBytes + value.toByteArray().size() + 1);
+    if (type == QMetaType::QVariantMap)
+        return variantMapBytes(value.toMap());
+    if (type == QMetaType::QVariantList) {
+        const QVariantList list = value.toList();
+        qint64 bytes = variantListStructureBytes(list.size());
+        for (const QVariant &element: list)
+            bytes += variantBytes(element);
+        return bytes;
+    }
+    if (type == qMetaTypeId<QGeoCircle>())
+        return circleBytes();
+    if (type == qMetaTypeId<QGeoPath>())
+        return pathBytes(value.value<QGeoPath>().size());
+    if (type == qMetaTypeId<QGeoPolygon>()) {
+        const QGeoPolygon polygon = value.value<QGeoPolygon>();
+        qint64 bytes = polygonShapeBytes(polygon.holesCount()) + coordinateListBytes(polygon.path().size());
+        for (int i = 0; i < polygon.holesCount(); ++i)
+            bytes += coordinateListBytes(polygon.holePath(i).size());
+        return bytes;
+    }
+    return 0;
+}
+
+static void addFeatureUsage(QGeoJsonMemoryUsage *usage, const QVariantMap &feature)
+{
+    usage->overheadBytes += allocationBytes(MapHeaderBytes);
+    for (QVariantMap::const_iterator iter = feature.constBegin(); iter != feature.constEnd(); ++iter) {
+        usage->overheadBytes += mapNodeBytes(iter.key());
+        if (iter.key() == QLatin1String("geometry"))
+            usage->geometryBytes += variantBytes(iter.value());
+        else
+            usage->propertyBytes += variantBytes(iter.value());
+    }
+}
+
+static void addDocumentUsage(QGeoJsonMemoryUsage *usage, const QVariantMap &geojsonMap)
+{
+    if (geojsonMap.isEmpty())
+        return;
+    usage->overheadBytes += allocationBytes(MapHeaderBytes);
+    for (QVariantMap::const_iterator iter = geojsonMap.constBegin(); iter != geojsonMap.constEnd(); ++iter) {
+        const QString &key = iter.key();
+        usage->overheadBytes += mapNodeBytes(key);
+        if (key == QLatin1String("FeatureCollection")) {
+            const QVariantList features = iter.value().toList();
+            usage->overheadBytes += variantListStructureBytes(features.size());
+            for (const QVariant &feature: features)
+                addDocumentUsage(usage, feature.toMap()); // a map with a single "Feature" key
+        } else if (key == QLatin1String("Feature")) {
+            addFeatureUsage(usage, iter.value().toMap());
+        } else if (key == QLatin1String("bbox")) {
+            usage->overheadBytes += variantBytes(iter.value());
+        } else {
+            usage->geometryBytes += variantBytes(iter.value());
+        }
+    }
+}
+
+// What storeGeometryMap() would allocate for the geometry, without building it
+static qint64 estimateStoreGeometryValue(const QGeoJsonGeometryStore &store, int *geometry);
+
+static qint64 estimateStoreGeometryMap(const QGeoJsonGeometryStore &store, int *geometry)
+{
+    const QGeoJsonGeometryStore::GeometryType type = store.geometryType(*geometry);
+    return allocationBytes(MapHeaderBytes) + allocationBytes(MapNodeBytes)
+            + stringBytes(int(qstrlen(geoJsonTypeNames[type]))) + estimateStoreGeometryValue(store, geometry);
+}
+
+static qint64 estimateStorePolygon(const QGeoJsonGeometryStore &store, int geometry, int part)
+{
+    const int rings = store.ringCount(geometry, part);
+    qint64 bytes = polygonShapeBytes(qMax(rings - 1, 0));
+    for (int r = 0; r < rings; ++r)
+        bytes += coordinateListBytes(store.ring(geometry, part, r).size);
+    return bytes;
+}
+
+static qint64 estimateStoreGeometryValue(const QGeoJsonGeometryStore &store, int *geometry)
+{
+    const int g = (*geometry)++;
+    const int parts = store.partCount(g);
+    qint64 bytes = 0;
+    switch (store.geometryType(g)) {
+    case QGeoJsonGeometryStore::Point:
+        return circleBytes();
+    case QGeoJsonGeometryStore::MultiPoint:
+        return variantListStructureBytes(parts) + parts * circleBytes();
+    case QGeoJsonGeometryStore::LineString:
+        return pathBytes(parts ? store.ring(g, 0, 0).size : 0);
+    case QGeoJsonGeometryStore::MultiLineString:
+        bytes = variantListStructureBytes(parts);
+        for (int part = 0; part < parts; ++part)
+            bytes += pathBytes(store.ring(g, part, 0).size);
+        return bytes;
+    case QGeoJsonGeometryStore::Polygon:
+        return parts ? estimateStorePolygon(store, g, 0) : polygonShapeBytes(0);
+    case QGeoJsonGeometryStore::MultiPolygon:
+        bytes = variantListStructureBytes(parts);
+        for (int part = 0; part < parts; ++part)
+            bytes += estimateStorePolygon(store, g, part);
+        return bytes;
+    case QGeoJsonGeometryStore::GeometryCollection:
+    {
+        const int count = store.childCount(g);
+        bytes = variantListStructureBytes(count);
+        for (int i = 0; i < count; ++i)
+            bytes += estimateStoreGeometryMap(store, geometry);
+        return bytes;
+    }
+    }
+    return bytes;
+}
+
+static void addStoreFeatureEstimate(QGeoJsonMemoryUsage *usage, const QGeoJsonGeometryStore &store, int feature)
+{
+    const QVariant id = store.featureId(feature);
+    usage->overheadBytes += allocationBytes(MapHeaderBytes) + mapNodeBytes(QStringLiteral("geometry"))
+            + mapNodeBytes(QStringLiteral("properties"));
+    if (id != QVariant::Invalid)
+        usage->overheadBytes += mapNodeBytes(QStringLiteral("id"));
+
+    int geometry = store.featureGeometry(feature);
+    if (geometry >= 0)
+        usage->geometryBytes += estimateStoreGeometryMap(store, &geometry);
+    usage->propertyBytes += variantBytes(store.featureProperties(feature)) + variantBytes(id);
+}
+
+// Shared by the workers of an import, which stop once the imported features exceed it
+class GeoJsonMemoryBudget
+{
+public:
+    explicit GeoJsonMemoryBudget(qint64 budget)
+        : m_budget(budget), m_used(0) {}
+
+    qint64 budget() const { return m_budget; }
+    bool isExceeded() const { return m_used.load() > m_budget; }
+
+    // false once the budget is exceeded
+    bool consume(qint64 bytes) { return m_used.fetchAndAddRelaxed(bytes) + bytes <= m_budget; }
+
+private:
+    const qint64 m_budget;
+    QAtomicInteger<qint64> m_used;
+};
+
+/*
+    Charges the budget with the bytes of value, less those of its parts already charged,
+    which are the bytes added to m_budgetCharged since it was charged. Shapes are charged as
+    their coordinates are parsed, the elements of the "features" and "geometries" lists as
+    they are completed, and the rest of the document at its end, so that an import stops at
+    the first value that exceeds the budget.
+*/
+bool GeoJsonTextParser::chargeBudget(const QVariant &value, qint64 charged)
+{
+    const qint64 bytes = variantBytes(value) - (m_budgetCharged - charged);
+    m_budgetCharged += bytes;
+    if (m_budget->consume(bytes))
+        return true;
+    m_budgetExceeded = true;
+    m_errorPos = m_pos;
+    return false;
+}
+
+// the element and its slot in the list
+bool GeoJsonTextParser::chargeListElement(const QVariant &element, qint64 charged)
+{
+    const qint64 bytes = variantBytes(element) + 8 + allocationBytes(16) - (m_budgetCharged - charged);
+    m_budgetCharged += bytes;
+    if (m_budget->consume(bytes))
+        return true;
+    m_budgetExceeded = true;
+    m_errorPos = m_pos;
+    return false;
+}
+
+static void setBudgetError(const QGeoJson::ImportOptions &options)
+{
+    if (options.errorString) {
+        *options.errorString = QStringLiteral("The imported document exceeds the memory budget of %1 bytes")
+                .arg(options.memoryBudget);
+    }
+}
+
+#ifndef QT_NO_DEBUG_STREAM
+QDebug operator<<(QDebug debug, const QGeoJsonMemoryUsage &usage)
+{
+    QDebugStateSaver saver(debug);
+    debug.nospace() << "QGeoJsonMemoryUsage(" << usage.totalBytes() << " bytes: geometry "
+                    << usage.geometryBytes << ", properties " << usage.propertyBytes << ", overhead "
+                    << usage.overheadBytes << ')';
+    return debug;
+}
+#endif
+
+// Typed import and export, dispatching on QGeoJsonObject::Type
+
+static QGeoCoordinate importJsonPosition(const QJsonValue &position)
+{
+    const QJsonArray array = position.toArray();
+    QGeoCoordinate parsedCoordinates;
+    if (array.size() > 0)
+        parsedCoordinates.setLatitude(array.at(0).toDouble());
+    if (array.size() > 1)
+        parsedCoordinates.setLongitude(array.at(1).toDouble());
+    if (array.size() > 2)
+        parsedCoordinates.setAltitude(array.at(2).toDouble());
+    return parsedCoordinates;
+}
+
+static QList<QGeoCoordinate> importJsonPositions(const QJsonValue &positions)
+{
+    const QJsonArray array = positions.toArray();
+    QList<QGeoCoordinate> parsedCoordinatesLine;
+    parsedCoordinatesLine.reserve(array.size());
+    for (const QJsonValue &position: array)
+        parsedCoordinatesLine.append(importJsonPosition(position));
+    return parsedCoordinatesLine;
+}
+
+static QList<QList<QGeoCoordinate>> importJsonRings(const QJsonValue &rings)
+{
+    QList<QList<QGeoCoordinate>> parsedCoordinatesPoly;
+    for (const QJsonValue &ring: rings.toArray())
+        parsedCoordinatesPoly.append(importJsonPositions(ring));
+    return parsedCoordinatesPoly;
+}
+
+static QGeoJsonObject importTypedGeometry(const QJsonObject &geometry)
+{
+    // unknown types are imported as GeometryCollection, as importGeometry() does
+    const QString type = geometry.value(QStringLiteral("type")).toString();
+    int i = QGeoJsonObject::Point;
+    for (; i < QGeoJsonObject::GeometryCollection; ++i) {
+        if (type == QLatin1String(geoJsonTypeNames[i]))
+            break;
+    }
+
+    QGeoJsonObject parsedGeometry(static_cast<QGeoJsonObject::Type>(i));
+    const QJsonValue coordinates = geometry.value(QStringLiteral("coordinates"));
+    switch (i) {
+    case QGeoJsonObject::Point:
+    {
+        QGeoCircle parsedPoint;
+        parsedPoint.setCenter(importJsonPosition(coordinates));
+        parsedGeometry.appendShape(parsedPoint);
+        break;
+    }
+    case QGeoJsonObject::MultiPoint:
+        for (const QGeoCoordinate &center: importJsonPositions(coordinates)) {
+            QGeoCircle parsedPoint;
+            parsedPoint.setCenter(center);
+            parsedGeometry.appendShape(parsedPoint);
+        }
+        break;
+    case QGeoJsonObject::LineString:
+    {
+        QGeoPath parsedLineString;
+        parsedLineString.setPath(importJsonPositions(coordinates));
+        parsedGeometry.appendShape(parsedLineString);
+        break;
+    }
+    case QGeoJsonObject::MultiLineString:
+        for (const QList<QGeoCoordinate> &path: importJsonRings(coordinates)) {
+            QGeoPath parsedLineString;
+            parsedLineString.setPath(path);
+            parsedGeometry.appendShape(parsedLineString);
+        }
+        break;
+    case QGeoJsonObject::Polygon:
+        parsedGeometry.appendShape(importPolygonPerimeters(importJsonRings(coordinates)));
+        break;
+    case QGeoJsonObject::MultiPolygon:
+    {
+        QList<QList<QList<QGeoCoordinate>>> polygons;
+        for (const QJsonValue &polygon: coordinates.toArray())
+            polygons.append(importJsonRings(polygon));
+        for (const QVariant &polygon: importMultiPolygonCoordinates(polygons))
+            parsedGeometry.appendShape(polygon.value<QGeoPolygon>());
+        break;
+    }
+    case QGeoJsonObject::GeometryCollection:
+        for (const QJsonValue &member: geometry.value(QStringLiteral("geometries")).toArray())
+            parsedGeometry.append(importTypedGeometry(member.toObject()));
+        break;
+    }
+    return parsedGeometry;
+}
+
+static QGeoJsonObject importTypedFeature(const QJsonObject &feature)
+{
+    QGeoJsonObject parsedFeature(QGeoJsonObject::Feature);
+    parsedFeature.setGeometry(importTypedGeometry(feature.value(QStringLiteral("geometry")).toObject()));
+    parsedFeature.setProperties(feature.value(QStringLiteral("properties")).toVariant());
+    parsedFeature.setId(feature.value(QStringLiteral("id")).toVariant());
+    return parsedFeature;
+}
+
+static QJsonValue exportTypedRings(const QGeoPolygon &polygon)
+{
+    QList<QList<QGeoCoordinate>> rings;
+    rings << polygon.path();
+    for (int i = 0; i < polygon.holesCount(); ++i)
+        rings << polygon.holePath(i);
+    return exportPolygonCoordinates(rings);
+}
+
+static QJsonObject exportTypedObject(const QGeoJsonObject &object)
+{
+    QJsonObject parsedObject;
+    if (object.type() == QGeoJsonObject::Null)
+        return parsedObject;
+    parsedObject.insert(QStringLiteral("type"), QString::fromLatin1(geoJsonTypeNames[object.type()]));
+
+    const int shapeCount = object.shapes().size();
+    QJsonArray array;
+    switch (object.type()) {
+    case QGeoJsonObject::Point:
+        parsedObject.insert(QStringLiteral("coordinates"), exportPointCoordinates(object.point().center()));
+        break;
+    case QGeoJsonObject::LineString:
+        parsedObject.insert(QStringLiteral("coordinates"), exportLineStringCoordinates(object.lineString().path()));
+        break;
+    case QGeoJsonObject::Polygon:
+        parsedObject.insert(QStringLiteral("coordinates"), exportTypedRings(object.polygon()));
+        break;
+    case QGeoJsonObject::MultiPoint:
+        for (int i = 0; i < shapeCount; ++i)
+            array.append(exportPointCoordinates(object.point(i).center()));
+        parsedObject.insert(QStringLiteral("coordinates"), array);
+        break;
+    case QGeoJsonObject::MultiLineString:
+        for (int i = 0; i < shapeCount; ++i)
+            array.append(exportLineStringCoordinates(object.lineString(i).path()));
+        parsedObject.insert(QStringLiteral("coordinates"), array);
+        break;
+    case QGeoJsonObject::MultiPolygon:
+        for (int i = 0; i < shapeCount; ++i)
+            array.append(exportTypedRings(object.polygon(i)));
+        parsedObject.insert(QStringLiteral("coordinates"), array);
+        break;
+    case QGeoJsonObject::GeometryCollection:
+        for (const QGeoJsonObject &member: object.children())
+            array.append(exportTypedObject(member));
+        parsedObject.insert(QStringLiteral("geometries"), array);
+        break;
+    case QGeoJsonObject::Feature:
+        parsedObject.insert(QStringLiteral("geometry"), exportTypedObject(object.geometry()));
+        parsedObject.insert(QStringLiteral("properties"), object.properties().toJsonObject());
+        parsedObject.insert(QStringLiteral("id"), object.id().toJsonValue());
+        break;
+    case QGeoJsonObject::FeatureCollection:
+        for (const QGeoJsonObject &feature: object.children())
+            array.append(exportTypedObject(feature));
+        parsedObject.insert(QStringLiteral("features"), array);
+        break;
+    case QGeoJsonObject::Null:
+        break;
+    }
+    return parsedObject;
+}
+
+// Bounding extents, in the latitude/longitude fields the importer fills
+
+struct GeoJsonExtent
+{
+    GeoJsonExtent()
+        : minLatitude(qInf()), minLongitude(qInf()), maxLatitude(-qInf()), maxLongitude(-qInf()) {}
+
+    bool isEmpty() const { return minLatitude > maxLatitude; }
+
+    bool intersects(const GeoJsonExtent &other) const
+    {
+        return minLatitude <= other.maxLatitude && maxLatitude >= other.minLatitude
+                && minLongitude <= other.maxLongitude && maxLongitude >= other.minLongitude;
+    }
+
+    void add(double latitude, double longitude)
+    {
+        if (qIsNaN(latitude) || qIsNaN(longitude))
+            return;
+        minLatitude = qMin(minLatitude, latitude);
+        minLongitude = qMin(minLongitude, longitude);
+        maxLatitude = qMax(maxLatitude, latitude);
+        maxLongitude = qMax(maxLongitude, longitude);
+    }
+
+    void add(const QGeoCoordinate &coordinate)
+    {
+        add(coordinate.latitude(), coordinate.longitude());
+    }
+
+    void add(const QList<QGeoCoordinate> &path)
+    {
+        for (const QGeoCoordinate &coordinate: path)
+            add(coordinate);
+    }
+
+    double minLatitude;
+    double minLongitude;
+    double maxLatitude;
+    double maxLongitude;
+};
+
+// ImportOptions::filter in the fields of GeoJsonExtent: the longitudes of the rectangle are
+// compared with the first member of the positions, kept in the latitude fields, and its
+// latitudes with the second one. A rectangle crossing the antimeridian, whose left edge is
+// east of its right edge, is split in two ranges of longitudes.
+class GeoJsonRegionFilter
+{
+public:
+    explicit GeoJsonRegionFilter(const QGeoRectangle &rectangle)
+        : m_rangeCount(0)
+    {
+        if (!rectangle.isValid())
+            return; // default-constructed, no filtering
+        const double west = rectangle.topLeft().longitude();
+        const double east = rectangle.bottomRight().longitude();
+        const double south = rectangle.bottomRight().latitude();
+        const double north = rectangle.topLeft().latitude();
+        if (west <= east) {
+            addRange(west, east, south, north);
+        } else {
+            addRange(west, 180, south, north);
+            addRange(-180, east, south, north);
+        }
+    }
+
+    bool isEmpty() const { return m_rangeCount == 0; }
+
+    bool intersects(const GeoJsonExtent &extent) const
+    {
+        for (int i = 0; i < m_rangeCount; ++i) {
+            if (m_ranges[i].intersects(extent))
+                return true;
+        }
+        return false;
+    }
+
+private:
+    void addRange(double west, double east, double south, double north)
+    {
+        GeoJsonExtent &range = m_ranges[m_rangeCount++];
+        range.add(west, south);
+        range.add(east, north);
+    }
+
+    GeoJsonExtent m_ranges[2];
+    int m_rangeCount;
+};
+
+// Coordinate-only extent of a feature, from its "bbox" member when present
+
+static void extendJsonCoordinatesExtent(GeoJsonExtent *extent, const QJsonArray &coordinates)
+{
+    if (coordinates.isEmpty())
+        return;
+    if (coordinates.at(0).isDouble()) {
+        extent->add(coordinates.at(0).toDouble(), coordinates.size() > 1 ? coordinates.at(1).toDouble() : qQNaN());
+        return;
+    }
+    for (const QJsonValue &nested: coordinates)
+        extendJsonCoordinatesExtent(extent, nested.toArray());
+}
+
+static void extendJsonGeometryExtent(GeoJsonExtent *extent, const QJsonObject &geometry)
+{
+    const QJsonValue geometries = geometry.value(QStringLiteral("geometries"));
+    if (geometries.isArray()) {
+        for (const QJsonValue &member: geometries.toArray())
+            extendJsonGeometryExtent(extent, member.toObject());
+        return;
+    }
+    extendJsonCoordinatesExtent(extent, geometry.value(QStringLiteral("coordinates")).toArray());
+}
+
+static GeoJsonExtent jsonFeatureExtent(const QJsonObject &feature)
+{
+    GeoJsonExtent extent;
+    const QJsonArray bbox = feature.value(QStringLiteral("bbox")).toArray();
+    if (bbox.size() >= 4 && bbox.size() % 2 == 0) {
+        const int dimensions = bbox.size() / 2;
+        extent.add(bbox.at(0).toDouble(), bbox.at(1).toDouble());
+        extent.add(bbox.at(dimensions).toDouble(), bbox.at(dimensions + 1).toDouble());
+        return extent;
+    }
+    extendJsonGeometryExtent(&extent, feature.value(QStringLiteral("geometry")).toObject());
+    return extent;
+}
+
+/*
+    The same extent read from the text, for GeoJsonTextParser::setFilter(): the numbers of
+    the "bbox" and of the coordinates are converted, everything else is only checked. The
+    last occurrence of a member is the one used, as in a QJsonObject.
+*/
+bool GeoJsonTextParser::skipFilteredFeature(bool *skipped)
+{
+    const char *begin = m_pos;
+    GeoJsonExtent extent;
+    if (!scanFeatureExtent(&extent))
+        return false;
+    *skipped = extent.isEmpty() || !m_filter->intersects(extent);
+    if (!*skipped)
+        m_pos = begin; // read again to be imported
+    return true;
+}
+
+bool GeoJsonTextParser::scanFeatureExtent(GeoJsonExtent *extent)
+{
+    if (m_pos >= m_end || *m_pos != '{')
+        return skipValue(); // no coordinates
+    if (++m_depth > MaxDepth)
+        return setError(QJsonParseError::DeepNesting);
+    ++m_pos;
+    skipWhitespace();
+
+    if (m_pos < m_end && *m_pos == '}') {
+        ++m_pos;
+        --m_depth;
+        return true;
+    }
+
+    GeoJsonExtent bboxExtent;
+    GeoJsonExtent geometryExtent;
+    bool hasBbox = false;
+    forever {
+        skipWhitespace();
+        if (m_pos >= m_end || *m_pos != '"')
+            return setError(QJsonParseError::UnterminatedObject);
+        const char *keyBegin;
+        const char *keyEnd;
+        bool escaped;
+        if (!scanString(&keyBegin, &keyEnd, &escaped))
+            return false;
+        skipWhitespace();
+        if (m_pos >= m_end || *m_pos != ':')
+            return setError(QJsonParseError::MissingNameSeparator);
+        ++m_pos;
+        skipWhitespace();
+        switch (memberFromKey(keyBegin, keyEnd, escaped)) {
+        case BboxMember:
+        {
+            QVariant bboxValue;
+            if (!parseValue(&bboxValue))
+                return false;
+            // as jsonFeatureExtent(), values which are not numbers count as 0
+            const QVariantList bbox = bboxValue.type() == QVariant::List ? bboxValue.toList() : QVariantList();
+            hasBbox = bbox.size() >= 4 && bbox.size() % 2 == 0;
+            if (hasBbox) {
+                auto number = [&bbox](int i) {
+                    return bbox.at(i).type() == QVariant::Double ? bbox.at(i).toDouble() : 0.0;
+                };
+                const int dimensions = bbox.size() / 2;
+                bboxExtent = GeoJsonExtent();
+                bboxExtent.add(number(0), number(1));
+                bboxExtent.add(number(dimensions), number(dimensions + 1));
+            }
+            break;
+        }
+        case GeometryMember:
+            geometryExtent = GeoJsonExtent();
+            if (!scanGeometryExtent(&geometryExtent))
+                return false;
+            break;
+        default:
+            if (!skipValue())
+                return false;
+            break;
+        }
+        skipWhitespace();
+        if (m_pos >= m_end)
+            return setError(QJsonParseError::UnterminatedObject);
+        const char c = *m_pos++;
+        if (c == '}')
+            break;
+        if (c != ',')
+            return setError(QJsonParseError::MissingValueSeparator);
+    }
+    --m_depth;
+    *extent = hasBbox ? bboxExtent : geometryExtent;
+    return true;
+}
+
+// As extendJsonGeometryExtent(): the members of "geometries" when it is an array, otherwise "coordinates"
+bool GeoJsonTextParser::scanGeometryExtent(GeoJsonExtent *extent)
+{
+    if (m_pos >= m_end || *m_pos != '{')
+        return skipValue();
+    if (++m_depth > MaxDepth)
+        return setError(QJsonParseError::DeepNesting);
+    ++m_pos;
+    skipWhitespace();
+
+    if (m_pos < m_end && *m_pos == '}') {
+        ++m_pos;
+        --m_depth;
+        return true;
+    }
+
+    GeoJsonExtent geometriesExtent;
+    GeoJsonExtent coordinatesExtent;
+    bool hasGeometries = false;
+    forever {
+        skipWhitespace();
+        if (m_pos >= m_end || *m_pos != '"')
+            return setError(QJsonParseError::UnterminatedObject);
+        const char *keyBegin;
+        const char *keyEnd;
+        bool escaped;
+        if (!scanString(&keyBegin, &keyEnd, &escaped))
+            return false;
+        skipWhitespace();
+        if (m_pos >= m_end || *m_pos != ':')
+            return setError(QJsonParseError::MissingNameSeparator);
+        ++m_pos;
+        skipWhitespace();
+        switch (memberFromKey(keyBegin, keyEnd, escaped)) {
+        case GeometriesMember:
+            geometriesExtent = GeoJsonExtent();
+            hasGeometries = m_pos < m_end && *m_pos == '[';
+            if (!(hasGeometries ? scanGeometryListExtent(&geometriesExtent) : skipValue()))
+                return false;
+            break;
+        case CoordinatesMember:
+            coordinatesExtent = GeoJsonExtent();
+            if (!scanCoordinatesExtent(&coordinatesExtent))
+                return false;
+            break;
+        default:
+            if (!skipValue())
+                return false;
+            break;
+        }
+        skipWhitespace();
+        if (m_pos >= m_end)
+            return setError(QJsonParseError::UnterminatedObject);
+        const char c = *m_pos++;
+        if (c == '}')
+            break;
+        if (c != ',')
+            return setError(QJsonParseError::MissingValueSeparator);
+    }
+    --m_depth;
+
+    const GeoJsonExtent &members = hasGeometries ? geometriesExtent : coordinatesExtent;
+    if (!members.isEmpty()) {
+        extent->add(members.minLatitude, members.minLongitude);
+        extent->add(members.maxLatitude, members.maxLongitude);
+    }
+    return true;
+}
+
+bool GeoJsonTextParser::scanGeometryListExtent(GeoJsonExtent *extent)
+{
+    if (++m_depth > MaxDepth)
+        return setError(QJsonParseError::DeepNesting);
+    ++m_pos; // '['
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == ']') {
+        ++m_pos;
+        --m_depth;
+        return true;
+    }
+
+    forever {
+        skipWhitespace();
+        if (!scanGeometryExtent(extent))
+            return false;
+        skipWhitespace();
+        if (m_pos >= m_end)
+            return setError(QJsonParseError::UnterminatedArray);
+        const char c = *m_pos++;
+        if (c == ']')
+            break;
+        if (c != ',')
+            return setError(QJsonParseError::MissingValueSeparator);
+    }
+    --m_depth;
+    return true;
+}
+
+// As extendJsonCoordinatesExtent(): an array starting with a number is a position
+bool GeoJsonTextParser::scanCoordinatesExtent(GeoJsonExtent *extent)
+{
+    if (m_pos >= m_end || *m_pos != '[')
+        return skipValue();
+    if (++m_depth > MaxDepth)
+        return setError(QJsonParseError::DeepNesting);
+    ++m_pos;
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == ']') {
+        ++m_pos;
+        --m_depth;
+        return true;
+    }
+
+    auto isNumber = [this]() {
+        return m_pos < m_end && (*m_pos == '-' || (*m_pos >= '0' && *m_pos <= '9'));
+    };
+    const bool isPosition = isNumber();
+    double values[2] = { qQNaN(), qQNaN() };
+    for (int i = 0; ; ++i) {
+        skipWhitespace();
+        if (!isPosition) {
+            if (!scanCoordinatesExtent(extent))
+                return false;
+        } else if (i < 2 && isNumber()) {
+            if (!parseNumber(&values[i]))
+                return setError(QJsonParseError::IllegalNumber);
+        } else {
+            if (i < 2)
+                values[i] = 0; // as QJsonValue::toDouble()
+            if (!skipValue())
+                return false;
+        }
+        skipWhitespace();
+        if (m_pos >= m_end)
+            return setError(QJsonParseError::UnterminatedArray);
+        const char c = *m_pos++;
+        if (c == ']')
+            break;
+        if (c != ',')
+            return setError(QJsonParseError::MissingValueSeparator);
+    }
+    --m_depth;
+    if (isPosition)
+        extent->add(values[0], values[1]);
+    return true;
+}
+
+// Parallel import of the features of a FeatureCollection
+
+class FeatureImportTask : public QRunnable
+{
+public:
+    FeatureImportTask(const QJsonArray &features, int begin, int end, const GeoJsonRegionFilter &filter,
+                      const GeoJsonSimplifier &simplifier, GeoJsonMemoryBudget *budget, QVariantList *result)
+        : m_features(features), m_begin(begin), m_end(end), m_filter(filter), m_simplifier(simplifier),
+          m_budget(budget), m_result(result)
+    {
+    }
+
+    void run() override
+    {
+        const QString keyFeature = QStringLiteral("Feature");
+        const bool filtered = !m_filter.isEmpty();
+        QVariantMap importedMap;
+        m_result->reserve(m_end - m_begin);
+        for (int i = m_begin; i < m_end; ++i) {
+            if (m_budget && m_budget->isExceeded())
+                return;
+            const QJsonObject feature = m_features.at(i).toObject();
+            if (filtered) {
+                const GeoJsonExtent extent = jsonFeatureExtent(feature);
+                if (extent.isEmpty() || !m_filter.intersects(extent))
+                    continue;
+            }
+            const QVariantMap parsedFeature = importFeature(feature.toVariantMap(), &m_simplifier);
+            importedMap.insert(keyFeature, parsedFeature);
+            if (m_budget) {
+                // the map of the element and its slot in the "FeatureCollection" list
+                QGeoJsonMemoryUsage usage;
+                addDocumentUsage(&usage, importedMap);
+                if (!m_budget->consume(usage.totalBytes() + 8 + allocationBytes(16)))
+                    return;
+            }
+            m_result->append(importedMap);
+        }
+    }
+
+private:
+    const QJsonArray m_features;
+    const int m_begin;
+    const int m_end;
+    const GeoJsonRegionFilter m_filter;
+    const GeoJsonSimplifier m_simplifier;
+    GeoJsonMemoryBudget *m_budget;
+    QVariantList *m_result;
+};
+
+static bool isFeatureCollectionType(const QJsonValue &typeValue)
+{
+    // importGeoJson() falls back to FeatureCollection for any unknown type
+    const QString type = typeValue.toString();
+    for (int i = 0; i < 8; ++i) {
+        if (type == QLatin1String(geoJsonTypeNames[i]))
+            return false;
+    }
+    return true;
+}
+
+static QVariantList importFeatureCollectionParallel(const QJsonArray &features, int threadCount, const GeoJsonRegionFilter &filter,
+                                                    const GeoJsonSimplifier &simplifier, GeoJsonMemoryBudget *budget)
+{
+    if (threadCount <= 1) {
+        QVariantList parsedFeatureCollection;
+        FeatureImportTask(features, 0, features.size(), filter, simplifier, budget, &parsedFeatureCollection).run();
+        return parsedFeatureCollection;
+    }
+
+    // A few chunks per thread keep the workers busy when feature sizes are uneven
+    const int chunkCount = qMin(features.size(), threadCount * 4);
+    QVector<QVariantList> chunks(chunkCount);
+    QVariantList *results = chunks.data();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threadCount);
+    for (int i = 0; i < chunkCount; ++i) {
+        const int begin = int(qint64(features.size()) * i / chunkCount);
+        const int end = int(qint64(features.size()) * (i + 1) / chunkCount);
+        pool.start(new FeatureImportTask(features, begin, end, filter, simplifier, budget, results + i));
+    }
+    pool.waitForDone();
+
+    QVariantList parsedFeatureCollection;
+    parsedFeatureCollection.reserve(features.size());
+    for (const QVariantList &chunk: qAsConst(chunks))
+        parsedFeatureCollection.append(chunk);
+    return parsedFeatureCollection;
+}
+
+// Text export with a fixed number of decimals for the coordinates
+
+static const double decimalScales[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+};
+
+static void appendCoordinateText(QByteArray *text, double value, int precision)
+{
+    if (!qIsFinite(value)) {
+        text->append("null"); // as QJsonDocument writes NaN and infinities
+        return;
+    }
+    if (precision < 0) {
+        // Qt's shortest representation that reads back to the same double
+        text->append(QByteArray::number(value, 'g', QLocale::FloatingPointShortest));
+        return;
+    }
+    precision = qMin(precision, 15);
+    const double scaled = value * decimalScales[precision];
+    if (qAbs(scaled) >= 9007199254740992.0) { // 2^53, the digits no longer fit a double exactly
+        QByteArray number = QByteArray::number(value, 'f', precision);
+        if (number.contains('.')) {
+            int size = number.size();
+            while (number.at(size - 1) == '0')
+                --size;
+            if (number.at(size - 1) == '.')
+                --size;
+            number.truncate(size);
+        }
+        text->append(number);
+        return;
+    }
+
+    // Print the rounded integer value * 10^precision, placing the decimal point by hand.
+    // qRound64() adds 0.5, which is itself rounded to even above 2^52: 4512345678901237 would
+    // become ...238. llround() rounds half away from zero as well, but exactly.
+    const qint64 rounded = qint64(std::llround(scaled));
+    quint64 magnitude = rounded < 0 ? quint64(-rounded) : quint64(rounded);
+    char buffer[24];
+    char *end = buffer + sizeof(buffer);
+    char *digit = end;
+    int decimals = precision;
+    while (decimals > 0 && magnitude % 10 == 0) {
+        magnitude /= 10;
+        --decimals;
+    }
+    for (int i = 0; i < decimals; ++i) {
+        *--digit = char('0' + magnitude % 10);
+        magnitude /= 10;
+    }
+    if (decimals > 0)
+        *--digit = '.';
+    do {
+        *--digit = char('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (rounded < 0)
+        *--digit = '-';
+    text->append(digit, int(end - digit));
+}
+
+static void appendPositionText(QByteArray *text, const QGeoCoordinate &coordinate, int precision)
+{
+    text->append('[');
+    appendCoordinateText(text, coordinate.latitude(), precision);
+    text->append(',');
+    appendCoordinateText(text, coordinate.longitude(), precision);
+    if (!qIsNaN(coordinate.altitude())) {
+        text->append(',');
+        appendCoordinateText(text, coordinate.altitude(), precision);
+    }
+    text->append(']');
+}
+
+static void appendPositionsText(QByteArray *text, const QList<QGeoCoordinate> &coordinates, int precision)
+{
+    text->append('[');
+    for (int i = 0; i < coordinates.size(); ++i) {
+        if (i)
+            text->append(',');
+        appendPositionText(text, coordinates.at(i), precision);
+    }
+    text->append(']');
+}
+
+static void appendRingsText(QByteArray *text, const QGeoPolygon &polygon, int precision)
+{
+    text->append('[');
+    appendPositionsText(text, polygon.path(), precision);
+    for (int i = 0; i < polygon.holesCount(); ++i) {
+        text->append(',');
+        appendPositionsText(text, polygon.holePath(i), precision);
+    }
+    text->append(']');
+}
+
+static void appendJsonValueText(QByteArray *text, const QJsonValue &value)
+{
+    if (value.isObject()) {
+        text->append(QJsonDocument(value.toObject()).toJson(QJsonDocument::Compact));
+        return;
+    }
+    // QJsonDocument only serializes objects and arrays, strip the array around the value
+    const QByteArray array = QJsonDocument(QJsonArray({value})).toJson(QJsonDocument::Compact);
+    text->append(array.constData() + 1, array.size() - 2);
+}
+
+// Writes the text of exportGeometry(), with the keys in the sorted order of QJsonDocument
+static void appendGeometryText(QByteArray *text, const QVariantMap &geometryMap, int precision)
+{
+    const char *type = nullptr;
+    if (geometryMap.contains(QStringLiteral("GeometryCollection"))) {
+        const QVariantList geometries = geometryMap.value(QStringLiteral("GeometryCollection")).value<QVariantList>();
+        text->append("{\"geometries\":[");
+        for (int i = 0; i < geometries.size(); ++i) {
+            if (i)
+                text->append(',');
+            appendGeometryText(text, geometries.at(i).value<QVariantMap>(), precision);
+        }
+        text->append(']');
+        type = "GeometryCollection";
+    } else if (geometryMap.contains(QStringLiteral("MultiPolygon"))) {
+        const QVariantList polygons = geometryMap.value(QStringLiteral("MultiPolygon")).value<QVariantList>();
+        text->append("{\"coordinates\":[");
+        for (int i = 0; i < polygons.size(); ++i) {
+            if (i)
+                text->append(',');
+            appendRingsText(text, polygons.at(i).value<QGeoPolygon>(), precision);
+        }
+        text->append(']');
+        type = "MultiPolygon";
+    } else if (geometryMap.contains(QStringLiteral("Polygon"))) {
+        text->append("{\"coordinates\":");
+        appendRingsText(text, geometryMap.value(QStringLiteral("Polygon")).value<QGeoPolygon>(), precision);
+        type = "Polygon";
+    } else if (geometryMap.contains(QStringLiteral("MultiLineString"))) {
+        const QVariantList paths = geometryMap.value(QStringLiteral("MultiLineString")).value<QVariantList>();
+        text->append("{\"coordinates\":[");
+        for (int i = 0; i < paths.size(); ++i) {
+            if (i)
+                text->append(',');
+            appendPositionsText(text, paths.at(i).value<QGeoPath>().path(), precision);
+        }
+        text->append(']');
+        type = "MultiLineString";
+    } else if (geometryMap.contains(QStringLiteral("LineString"))) {
+        text->append("{\"coordinates\":");
+        appendPositionsText(text, geometryMap.value(QStringLiteral("LineString")).value<QGeoPath>().path(), precision);
+        type = "LineString";
+    } else if (geometryMap.contains(QStringLiteral("MultiPoint"))) {
+        const QVariantList circles = geometryMap.value(QStringLiteral("MultiPoint")).value<QVariantList>();
+        text->append("{\"coordinates\":[");
+        for (int i = 0; i < circles.size(); ++i) {
+            if (i)
+                text->append(',');
+            appendPositionText(text, circles.at(i).value<QGeoCircle>().center(), precision);
+        }
+        text->append(']');
+        type = "MultiPoint";
+    } else if (geometryMap.contains(QStringLiteral("Point"))) {
+        text->append("{\"coordinates\":");
+        appendPositionText(text, geometryMap.value(QStringLiteral("Point")).value<QGeoCircle>().center(), precision);
+        type = "Point";
+    }
+
+    if (!type) {
+        text->append("{}");
+        return;
+    }
+    text->append(",\"type\":\"");
+    text->append(type);
+    text->append("\"}");
+}
+
+// Writes the text of exportFeature(), taking the properties from row of table when not null
+static void appendFeatureText(QByteArray *text, const QVariantMap &feature, int precision,
+                              const QGeoJsonPropertyTable *table = nullptr, int row = 0)
+{
+    const QVariantMap featureMap = feature.value(QStringLiteral("Feature")).value<QVariantMap>();
+    text->append("{\"geometry\":");
+    appendGeometryText(text, featureMap.value(QStringLiteral("geometry")).value<QVariantMap>(), precision);
+    text->append(",\"id\":");
+    appendJsonValueText(text, featureMap.value(QStringLiteral("id")).toJsonValue());
+    text->append(",\"properties\":");
+    if (table && row < table->rowCount())
+        table->appendPropertiesJson(text, row);
+    else
+        appendJsonValueText(text, featureMap.value(QStringLiteral("properties")).toJsonObject());
+    text->append(",\"type\":\"Feature\"}");
+}
+
+// Writes the text of exportGeoJson()
+static void appendGeoJsonText(QByteArray *text, const QVariantMap &geojsonMap, int precision,
+                              const QGeoJsonPropertyTable *table = nullptr)
+{
+    if (geojsonMap.contains(QStringLiteral("FeatureCollection"))) {
+        const QVariantList features = geojsonMap.value(QStringLiteral("FeatureCollection")).value<QVariantList>();
+        text->append("{\"features\":[");
+        for (int i = 0; i < features.size(); ++i) {
+            if (i)
+                text->append(',');
+            appendFeatureText(text, features.at(i).value<QVariantMap>(), precision, table, i);
+        }
+        text->append("],\"type\":\"FeatureCollection\"}");
+    } else if (geojsonMap.contains(QStringLiteral("Feature"))) {
+        appendFeatureText(text, geojsonMap, precision, table, 0);
+    } else {
+        appendGeometryText(text, geojsonMap, precision);
+    }
+}
+
+// Parallel export of the features of a FeatureCollection, serialized per worker
+
+static QByteArray exportFeatureText(const QVariantMap &feature, int precision)
+{
+    if (precision < 0)
+        return QJsonDocument(exportFeature(feature)).toJson(QJsonDocument::Compact);
+    QByteArray text;
+    appendFeatureText(&text, feature, precision);
+    return text;
+}
+
+class FeatureExportTask : public QRunnable
+{
+public:
+    FeatureExportTask(const QVariantList &features, int begin, int end, int precision,
+                      const QGeoJsonPropertyTable *table, QByteArray *result)
+        : m_features(features), m_begin(begin), m_end(end), m_precision(precision), m_table(table),
+          m_result(result)
+    {
+    }
+
+    void run() override
+    {
+        for (int i = m_begin; i < m_end; ++i) {
+            if (i != m_begin)
+                m_result->append(',');
+            if (m_table)
+                appendFeatureText(m_result, m_features.at(i).value<QVariantMap>(), m_precision, m_table, i);
+            else
+                m_result->append(exportFeatureText(m_features.at(i).value<QVariantMap>(), m_precision));
+        }
+    }
+
+private:
+    const QVariantList m_features;
+    const int m_begin;
+    const int m_end;
+    const int m_precision;
+    const QGeoJsonPropertyTable *m_table; // only read by the workers
+    QByteArray *m_result;
+};
+
+static QByteArray exportFeatureCollectionParallel(const QVariantList &features, int threadCount, int precision,
+                                                  const QGeoJsonPropertyTable *table = nullptr)
+{
+    const int chunkCount = qMin(features.size(), threadCount * 4);
+    QVector<QByteArray> chunks(chunkCount);
+    QByteArray *results = chunks.data();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threadCount);
+    for (int i = 0; i < chunkCount; ++i) {
+        const int begin = int(qint64(features.size()) * i / chunkCount);
+        const int end = int(qint64(features.size()) * (i + 1) / chunkCount);
+        pool.start(new FeatureExportTask(features, begin, end, precision, table, results + i));
+    }
+    pool.waitForDone();
+
+    // Same text as the compact serialization of exportFeatureCollection(), whose keys are sorted
+    int size = 0;
+    for (const QByteArray &chunk: qAsConst(chunks))
+        size += chunk.size() + 1;
+    QByteArray text;
+    text.reserve(size + 64);
+    text.append("{\"features\":[");
+    for (int i = 0; i < chunkCount; ++i) {
+        if (i)
+            text.append(',');
+        text.append(chunks.at(i));
+    }
+    text.append("],\"type\":\"FeatureCollection\"}");
+    return text;
+}
+
+static QVariantMap importGeoJsonMap(const QVariantMap &standardMap, const GeoJsonSimplifier *simplifier = nullptr)
+{
+    QString geoType[] = {
+        QStringLiteral("Point"),
+        QStringLiteral("MultiPoint"),
+        QStringLiteral("LineString"),
+        QStringLiteral("MultiLineString"),
+        QStringLiteral("Polygon"),
+        QStringLiteral("MultiPolygon"),
+        QStringLiteral("GeometryCollection"),
+        QStringLiteral("Feature"),
+        QStringLiteral("FeatureCollection")
+    };
+
+    enum geoTypeSwitch {
+        Point,
+        MultiPoint,
+        LineString,
+        MultiLineString,
+        Polygon,
+        MultiPolygon,
+        GeometryCollection,
+        Feature,
+        FeatureCollection
+    };
+
+    // Checking wether the JSON object has a "type" member
+
+    QString keyType = QStringLiteral("type");
+
+    QVariant keyVariant = standardMap.value(keyType);
+        if (keyVariant == QVariant::Invalid) {
+             // [x] Type check failed
+        }
+    QString valueType = keyVariant.value<QString>();
+    int len = sizeof(geoType)/sizeof(*geoType);
+
+    int i = 0; // index of the iteration where the value of type has been veryfied
+
+    // Checking whether the "type" member has a GeoJSON admitted value
+
+    for (i=0; i<len-1; i++) {
+        if (valueType == geoType[i])
+            break;
+        else if (i==len-1) {}
+    }
+
+    QVariantMap parsedGeoJsonMap;
+    switch (i) {
+    case Point:
+    {
+        QString keyMap = QStringLiteral("Point");
+        QGeoCircle circle = importPoint(standardMap);
+        QVariant valueMap = QVariant::fromValue(circle);
+
+        parsedGeoJsonMap.insert(keyMap, valueMap);
+        break;
+    }
+    case MultiPoint:
+    {
+        QString keyMap = QStringLiteral("MultiPoint"); // creating the key for the first element of the QVariantMap that will be returned
+        QVariantList multiCircle = importMultiPoint(standardMap);
+        QVariant valueMap = QVariant::fromValue(multiCircle); // wraps up the multiCircle item in a QVariant
+        QList <QGeoCircle> testlist;
+
+        parsedGeoJsonMap.insert(keyMap, valueMap);
+        break;
+    }
+    case LineString:
+    {
+        QString keyMap = QStringLiteral("LineString");
+        QGeoPath lineString = importLineString(standardMap, simplifier);
+        QVariant valueMap = QVariant::fromValue(lineString);
+
+        parsedGeoJsonMap.insert(keyMap, valueMap);
+        break;
+    }
+    case MultiLineString:
+    {
+        QString keyMap = QStringLiteral("MultiLineString");
+        QVariantList multiLineString = importMultiLineString(standardMap, simplifier);
+        QVariant valueMap = QVariant::fromValue(multiLineString);
+
+        parsedGeoJsonMap.insert(keyMap, valueMap);
+        break;
+    }
+    case Polygon:
+    {
+        QString keyMap = QStringLiteral("Polygon");
+        QGeoPolygon poly = importPolygon(standardMap, simplifier);
+        QVariant valueMap = QVariant::fromValue(poly);
+        parsedGeoJsonMap.insert(keyMap, valueMap);
+
+        break;
+    }
+    case MultiPolygon:
+    {
+        QString keyMap = QStringLiteral("MultiPolygon");
+        QVariantList multiPoly = importMultiPolygon(standardMap, simplifier);
+        QVariant valueMap = QVariant::fromValue(multiPoly);
+
+        parsedGeoJsonMap.insert(keyMap, valueMap);
+        break;
+    }
+    case GeometryCollection: // list of GeoJson geometry objects
+    {
+        QString keyMap = QStringLiteral("GeometryCollection");
+        QVariantList multiGeo = importGeometryCollection(standardMap, simplifier);
+        QVariant valueMap = QVariant::fromValue(multiGeo);
+
+        parsedGeoJsonMap.insert(keyMap, valueMap);
+        break;
+    }
+    case Feature: // single GeoJson geometry object with properties
+    {
+        QString keyMap = QStringLiteral("Feature");
+        QVariantMap feat = importFeature(standardMap, simplifier);
+        QVariant valueMap = QVariant::fromValue(feat);
+
+        parsedGeoJsonMap.insert(keyMap, valueMap);
+        break;
+    }
+    case FeatureCollection: // heterogeneous list of GeoJSON geometries with properties
+    {
+        QString keyMap = QStringLiteral("FeatureCollection");
+        QVariantList featCollection = importFeatureCollection(standardMap, simplifier);
+        QVariant valueMap = QVariant::fromValue(featCollection);
+
+        parsedGeoJsonMap.insert(keyMap, valueMap);
+        break;
+    }
+    }
+
+    // searching for the bbox member, if found, copy it to the output QVariantMap
+    QString keyMap = QStringLiteral("bbox");
+    QVariant bboxValue = standardMap.value(keyMap);
+    if (bboxValue != QVariant::Invalid) {
+        parsedGeoJsonMap.insert(keyMap, bboxValue);
+    }
+    return parsedGeoJsonMap;
+}
+
+QVariantMap QGeoJson::importGeoJson(const QJsonDocument &importDoc)
+{
+    QJsonObject object = importDoc.object(); // Read json object from imported doc
+    QVariantMap standardMap = object.toVariantMap(); // extraced map using Qt's API
+    return importGeoJsonMap(standardMap);
+}
+
+// Takes the "properties" member out of a {"Feature": featureMap} map. The map is detached
+// from the caller's copy first, so that the feature map is not copied on write.
+static QVariant takeFeatureProperties(QVariantMap *feature)
+{
+    QVariantMap featureMap = feature->take(QStringLiteral("Feature")).value<QVariantMap>();
+    const QVariant properties = featureMap.take(QStringLiteral("properties"));
+    feature->insert(QStringLiteral("Feature"), featureMap);
+    return properties;
+}
+
+// Moves the properties of the imported features into table, one row per feature
+static void moveFeatureProperties(QVariantMap *geojsonMap, QGeoJsonPropertyTable *table)
+{
+    table->clear();
+    if (geojsonMap->contains(QStringLiteral("FeatureCollection"))) {
+        QVariantList features = geojsonMap->take(QStringLiteral("FeatureCollection")).value<QVariantList>();
+        table->reserve(features.size());
+        for (int i = 0; i < features.size(); ++i) {
+            QVariantMap feature = features.at(i).value<QVariantMap>();
+            features[i] = QVariant();
+            table->appendRow(takeFeatureProperties(&feature));
+            features[i] = feature;
+        }
+        geojsonMap->insert(QStringLiteral("FeatureCollection"), features);
+    } else if (geojsonMap->contains(QStringLiteral("Feature"))) {
+        table->appendRow(takeFeatureProperties(geojsonMap));
+    }
+}
+
+static QVariantMap importGeoJsonDocument(const QJsonDocument &geojsonDoc, const QGeoJson::ImportOptions &options,
+                                         GeoJsonStatsRecorder *recorder)
+{
+    const int threadCount = options.threadCount > 0 ? options.threadCount : QThread::idealThreadCount();
+    const GeoJsonRegionFilter filter(options.filter);
+    const GeoJsonSimplifier simplifier(options.simplification, options.simplifyTolerance);
+    const QJsonObject object = geojsonDoc.object();
+    const QJsonArray features = object.value(QStringLiteral("features")).toArray();
+    // a budgeted FeatureCollection goes through the workers, so each feature is accounted for
+    // as it is converted instead of in a pass over the whole document
+    if ((filter.isEmpty() && options.memoryBudget <= 0
+         && (threadCount <= 1 || features.size() < 2))
+            || !isFeatureCollectionType(object.value(QStringLiteral("type")))) {
+        const QVariantMap standardMap = object.toVariantMap();
+        recorder->addTime(&QGeoJsonStats::variantTime);
+        const QVariantMap parsedGeoJsonMap = importGeoJsonMap(standardMap, &simplifier);
+        recorder->addTime(&QGeoJsonStats::conversionTime);
+        if (options.memoryBudget > 0 && QGeoJson::memoryUsage(parsedGeoJsonMap).totalBytes() > options.memoryBudget) {
+            setBudgetError(options);
+            return QVariantMap();
+        }
+        return parsedGeoJsonMap;
+    }
+
+    // the workers convert each feature to a QVariantMap themselves, the time goes to conversionTime
+    GeoJsonMemoryBudget budget(options.memoryBudget);
+    budget.consume(allocationBytes(MapHeaderBytes) + mapNodeBytes(QStringLiteral("FeatureCollection")));
+    QVariantMap parsedGeoJsonMap;
+    parsedGeoJsonMap.insert(QStringLiteral("FeatureCollection"),
+                            importFeatureCollectionParallel(features, qMin(threadCount, features.size()), filter,
+                                                            simplifier, options.memoryBudget > 0 ? &budget : nullptr));
+    if (options.memoryBudget > 0 && budget.isExceeded()) {
+        recorder->addTime(&QGeoJsonStats::conversionTime);
+        setBudgetError(options);
+        return QVariantMap();
+    }
+
+    QVariant bboxValue = object.value(QStringLiteral("bbox")).toVariant();
+    if (bboxValue != QVariant::Invalid)
+        parsedGeoJsonMap.insert(QStringLiteral("bbox"), bboxValue);
+    recorder->addTime(&QGeoJsonStats::conversionTime);
+    return parsedGeoJsonMap;
+}
+
+/*!
+    Imports \a geojsonDoc like importGeoJson(const QJsonDocument &), according to \a options.
+
+    When ImportOptions::threadCount is not 1 and the document is a FeatureCollection, its
+    features are split in chunks converted concurrently on a dedicated thread pool, and the
+    results are reassembled in the original order. Each worker converts its own features from
+    the QJsonArray, including the QVariantMap conversion, so the returned map is the same as
+    the one of the serial import.
+
+    When ImportOptions::filter is a valid rectangle, the features of a FeatureCollection are
+    first tested against it with a pass over their JSON coordinates, or against their own
+    "bbox" member when present, and only those whose extent intersects the rectangle are
+    imported. The other features, and those without coordinates, are left out of the
+    returned list, so their geometries are never built. The test is conservative: a feature
+    whose extent overlaps the rectangle is kept even if none of its coordinates lies inside
+    it. The rectangle is geographic: its longitudes are compared with the first member of
+    the GeoJSON positions and its latitudes with the second one. A rectangle crossing the
+    antimeridian, whose top left longitude is greater than its bottom right one, selects the
+    features on either side of it. The filter only selects among the features of a
+    FeatureCollection: a single Feature, or a geometry, is imported whole whatever its
+    extent.
+
+    When ImportOptions::simplification is set and ImportOptions::simplifyTolerance is positive,
+    the positions of the paths and polygon rings are simplified as each geometry is imported,
+    before its QGeoPath or QGeoPolygon is built, with the Douglas-Peucker algorithm using the
+    tolerance as the maximum distance of a removed position, or with the Visvalingam-Whyatt
+    algorithm using its square as the minimum area of a kept one. Distances are measured in
+    degrees. The first and last positions are always kept, so rings stay closed, and a ring
+    that would end up with fewer than four positions is imported unsimplified. Points and
+    MultiPoints are unchanged.
+
+    When ImportOptions::memoryBudget is positive, the bytes retained by the imported features
+    are added up, as memoryUsage() counts them, while the features of a FeatureCollection are
+    converted. Once the total exceeds the budget the workers stop, the features converted so
+    far are released, an empty map is returned and, when ImportOptions::errorString is not
+    null, it is set to the reason. Other documents are measured once converted; the direct
+    import of a text, see importGeoJson(const QByteArray &, const ImportOptions &,
+    QJsonParseError *), charges them as they are parsed instead. The budget does not include
+    the QJsonDocument itself, nor the transient memory of the conversion;
+    estimateMemoryUsage() can be used to refuse a text before importing it.
+
+    When ImportOptions::propertyTable is not null, the table is cleared and the "properties"
+    member of each imported feature is moved to it, one row per feature in the order of the
+    "FeatureCollection" list, or a single row for a Feature document. The feature maps are
+    returned without their "properties" member. Features sharing the same keys then share
+    the key strings, and their values are stored in the columns of the table instead of in a
+    map per feature. The memory budget is checked before the properties are moved.
+
+    When ImportOptions::stats is not null, the QGeoJsonStats it points to is reset and filled
+    for this call.
+*/
+QVariantMap QGeoJson::importGeoJson(const QJsonDocument &geojsonDoc, const ImportOptions &options)
+{
+    if (options.errorString)
+        options.errorString->clear();
+    GeoJsonStatsRecorder recorder(options.stats);
+    QVariantMap parsedGeoJsonMap = importGeoJsonDocument(geojsonDoc, options, &recorder);
+    if (options.propertyTable) {
+        moveFeatureProperties(&parsedGeoJsonMap, options.propertyTable);
+        recorder.addTime(&QGeoJsonStats::conversionTime);
+    }
+    recorder.count(parsedGeoJsonMap);
+    return parsedGeoJsonMap;
+}
+
+/*!
+    Imports the GeoJSON document contained in the UTF-8 encoded \a geojsonText.
+
+    The text is parsed directly into the QVariantMap returned, without building a
+    QJsonDocument or an intermediate QVariantMap of the whole document first; coordinates are
+    decoded into QGeoCoordinate values as they are read. The result is the same as the one of
+    importGeoJson(QJsonDocument::fromJson(geojsonText)).
+
+    If \a error is not null, it reports the outcome of parsing. An unparsable document is
+    imported like an empty JSON object.
+*/
+QVariantMap QGeoJson::importGeoJson(const QByteArray &geojsonText, QJsonParseError *error)
+{
+    GeoJsonTextParser parser(geojsonText.constData(), geojsonText.constData() + geojsonText.size());
+    const QVariantMap parsedGeoJsonMap = parser.parseDocument();
+    if (error) {
+        error->error = parser.error();
+        error->offset = parser.errorOffset();
+    }
+    return parsedGeoJsonMap;
+}
+
+/*!
+    Imports the UTF-8 encoded \a geojsonText according to \a options.
+
+    With the default thread count the text is imported directly, like
+    importGeoJson(const QByteArray &, QJsonParseError *) does, simplifying the geometries as
+    they are parsed when requested; otherwise it is parsed into a QJsonDocument first and
+    imported like importGeoJson(const QJsonDocument &, const ImportOptions &). If \a error
+    is not null, it reports the outcome of parsing.
+
+    On the direct path, ImportOptions::filter selects the features as they are read: the
+    extent of each feature is taken from its "bbox" member, or from a scan of its
+    coordinates that converts the numbers without building any shape. Only the features
+    intersecting the rectangle are then parsed again and imported. The result is the same
+    as through a QJsonDocument, single Features and geometries being imported whole.
+
+    On the direct path, a positive ImportOptions::memoryBudget is charged while the text is
+    parsed, whatever the type of the document: each shape once its coordinates are read, and
+    each feature, or each member of a GeometryCollection, once it is complete. Parsing stops
+    at the first value that exceeds the budget, so the rest of the document is never
+    converted; an empty map is returned and ImportOptions::errorString is set as with a
+    QJsonDocument. The parse error then stays QJsonParseError::NoError.
+*/
+QVariantMap QGeoJson::importGeoJson(const QByteArray &geojsonText, const ImportOptions &options, QJsonParseError *error)
+{
+    GeoJsonStatsRecorder recorder(options.stats);
+    recorder.addBytesIn(geojsonText.size());
+    QVariantMap parsedGeoJsonMap;
+    if (options.errorString)
+        options.errorString->clear();
+    if (options.threadCount == 1) {
+        const GeoJsonSimplifier simplifier(options.simplification, options.simplifyTolerance);
+        const GeoJsonRegionFilter filter(options.filter);
+        GeoJsonMemoryBudget budget(options.memoryBudget);
+        GeoJsonTextParser parser(geojsonText.constData(), geojsonText.constData() + geojsonText.size());
+        if (simplifier.isActive())
+            parser.setSimplifier(&simplifier);
+        if (!filter.isEmpty())
+            parser.setFilter(&filter);
+        if (options.memoryBudget > 0)
+            parser.setMemoryBudget(&budget);
+        parsedGeoJsonMap = parser.parseDocument();
+        if (error) {
+            error->error = parser.error();
+            error->offset = parser.errorOffset();
+        }
+        if (parser.isBudgetExceeded()) {
+            parsedGeoJsonMap = QVariantMap();
+            setBudgetError(options);
+        }
+        recorder.addTime(&QGeoJsonStats::parseTime);
+    } else {
+        const QJsonDocument geojsonDoc = QJsonDocument::fromJson(geojsonText, error);
+        recorder.addTime(&QGeoJsonStats::parseTime);
+        parsedGeoJsonMap = importGeoJsonDocument(geojsonDoc, options, &recorder);
+    }
+    if (options.propertyTable) {
+        moveFeatureProperties(&parsedGeoJsonMap, options.propertyTable);
+        recorder.addTime(&QGeoJsonStats::conversionTime);
+    }
+    recorder.count(parsedGeoJsonMap);
+    return parsedGeoJsonMap;
+}
+
+/*!
+    Imports the GeoJSON document stored in the file \a fileName.
+
+    The file is memory-mapped and parsed in place, as importGeoJson(const QByteArray &) does
+    with its argument, so no copy of the file content is held while the document is
+    converted. Files that cannot be mapped are read into memory instead.
+
+    If \a error is not null, it reports the outcome of parsing. If the file cannot be opened an
+    empty map is returned and, when \a errorString is not null, it is set to the reason.
+*/
+QVariantMap QGeoJson::importGeoJsonFile(const QString &fileName, QJsonParseError *error, QString *errorString)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorString)
+            *errorString = file.errorString();
+        return QVariantMap();
+    }
+
+    const qint64 size = file.size();
+    if (size > 0) {
+        if (const uchar *mapped = file.map(0, size)) {
+            const char *begin = reinterpret_cast<const char *>(mapped);
+            GeoJsonTextParser parser(begin, begin + size);
+            const QVariantMap parsedGeoJsonMap = parser.parseDocument();
+            if (error) {
+                error->error = parser.error();
+                error->offset = parser.errorOffset();
+            }
+            file.unmap(const_cast<uchar *>(mapped));
+            return parsedGeoJsonMap;
+        }
+    }
+    return importGeoJson(file.readAll(), error);
+}
+
+/*!
+    Estimates the memory that importGeoJson() would retain for the UTF-8 encoded
+    \a geojsonText, without building its QVariantMap.
+
+    The text is imported into a QGeoJsonGeometryStore, whose columns take a fraction of the
+    memory of the map, and the shapes, coordinate lists, maps and lists the importer would
+    create for it are counted. The "properties" and "id" values are decoded one feature at a
+    time to be measured. The result is the one memoryUsage() returns for the imported map,
+    except that the holes MultiPolygon members share with the previous members are counted
+    once.
+
+    If \a error is not null, it reports the outcome of parsing.
+*/
+QGeoJsonMemoryUsage QGeoJson::estimateMemoryUsage(const QByteArray &geojsonText, QJsonParseError *error)
+{
+    const QGeoJsonGeometryStore store = importGeometryStore(geojsonText, error);
+    QGeoJsonMemoryUsage usage;
+    usage.overheadBytes += allocationBytes(MapHeaderBytes);
+    switch (store.documentType()) {
+    case QGeoJsonGeometryStore::GeometryDocument:
+        if (store.geometryCount()) {
+            int geometry = 0;
+            usage.overheadBytes += mapNodeBytes(QString::fromLatin1(geoJsonTypeNames[store.geometryType(0)]));
+            usage.geometryBytes += estimateStoreGeometryValue(store, &geometry);
+        }
+        break;
+    case QGeoJsonGeometryStore::FeatureDocument:
+        usage.overheadBytes += mapNodeBytes(QStringLiteral("Feature"));
+        if (store.featureCount())
+            addStoreFeatureEstimate(&usage, store, 0);
+        break;
+    case QGeoJsonGeometryStore::FeatureCollectionDocument:
+        usage.overheadBytes += mapNodeBytes(QStringLiteral("FeatureCollection"))
+                + variantListStructureBytes(store.featureCount());
+        for (int i = 0; i < store.featureCount(); ++i) {
+            usage.overheadBytes += allocationBytes(MapHeaderBytes) + mapNodeBytes(QStringLiteral("Feature"));
+            addStoreFeatureEstimate(&usage, store, i);
+        }
+        break;
+    }
+    if (store.boundingBox() != QVariant::Invalid)
+        usage.overheadBytes += mapNodeBytes(QStringLiteral("bbox")) + variantBytes(store.boundingBox());
+    return usage;
+}
+
+/*!
+    Returns the heap memory retained by \a geojsonMap, a map in the layout of importGeoJson(),
+    split between the geometries, the "properties" and "id" values of the features, and the
+    maps and lists holding them.
+
+    The sizes are those of the Qt 5 containers, shapes and coordinates on a 64-bit platform,
+    with the header and rounding of a typical allocator; data shared between values of the
+    map is counted for each of them. The figures are approximations meant for comparisons
+    and budgets, not an exact account of the allocator.
+*/
+QGeoJsonMemoryUsage QGeoJson::memoryUsage(const QVariantMap &geojsonMap)
+{
+    QGeoJsonMemoryUsage usage;
+    addDocumentUsage(&usage, geojsonMap);
+    return usage;
+}
+
+QJsonDocument QGeoJson::exportGeoJson(const QVariantMap &exportMap)
+{
+    QJsonObject newObject;
+    QJsonDocument newDocument;
+    if (exportMap.contains(QStringLiteral("Point"))) // check if the map contains the key Point
+        newObject = exportPoint(exportMap);
+    if (exportMap.contains(QStringLiteral("MultiPoint")))
+        newObject = exportMultiPoint(exportMap);
+    if (exportMap.contains(QStringLiteral("LineString")))
+        newObject = exportLineString(exportMap);
+    if (exportMap.contains(QStringLiteral("MultiLineString")))
+        newObject = exportMultiLineString(exportMap);
+    if (exportMap.contains(QStringLiteral("Polygon")))
+        newObject = exportPolygon(exportMap);
+    if (exportMap.contains(QStringLiteral("MultiPolygon")))
+        newObject = exportMultiPolygon(exportMap);
+    if (exportMap.contains(QStringLiteral("GeometryCollection")))
+        newObject = exportGeometry(exportMap);
+    if (exportMap.contains(QStringLiteral("Feature")))
+        newObject = exportFeature(exportMap);
+    if (exportMap.contains(QStringLiteral("FeatureCollection")))
+        newObject = exportFeatureCollection(exportMap);
+    newDocument.setObject(newObject);
+    return newDocument;
+}
+
+/*!
+    Exports \a geojsonMap like exportGeoJson(), and returns the compact UTF-8 serialization of
+    the document, as QJsonDocument::toJson(QJsonDocument::Compact) would.
+
+    When ExportOptions::threadCount is not 1 and the map holds a FeatureCollection, chunks of
+    features are exported and serialized concurrently, and the resulting text fragments are
+    concatenated in order. The bytes returned are the same as for a serial export.
+
+    When ExportOptions::coordinatePrecision is 0 or more, every latitude, longitude and altitude
+    is rounded to that many decimal places, trailing zeros are dropped, and the text is written
+    directly from the map, without building a QJsonObject. Six decimals are about 0.1 m, seven
+    about 1 cm. The default of -1 writes the shortest text that reads back to the same double.
+
+    When ExportOptions::propertyTable is not null, the "properties" member of each feature is
+    written from the row of the table at the position of the feature in the
+    "FeatureCollection" list, or from row 0 for a Feature document, as imported with
+    ImportOptions::propertyTable. The keys are written from the text the table escaped once
+    per schema, and the text is written directly from the map whatever the precision.
+    Features past the last row of the table use their own "properties" member.
+
+    When ExportOptions::stats is not null, the QGeoJsonStats it points to is reset and filled
+    for this call.
+*/
+QByteArray QGeoJson::exportGeoJsonText(const QVariantMap &geojsonMap, const ExportOptions &options)
+{
+    GeoJsonStatsRecorder recorder(options.stats);
+    recorder.count(geojsonMap);
+    const int threadCount = options.threadCount > 0 ? options.threadCount : QThread::idealThreadCount();
+    const QVariantList features = geojsonMap.value(QStringLiteral("FeatureCollection")).value<QVariantList>();
+    QByteArray geojsonText;
+    if ((options.coordinatePrecision >= 0 || options.propertyTable) && (threadCount <= 1 || features.size() < 2)) {
+        // no QJsonObject in between
+        appendGeoJsonText(&geojsonText, geojsonMap, options.coordinatePrecision, options.propertyTable);
+        recorder.addTime(&QGeoJsonStats::conversionTime);
+    } else if (threadCount <= 1 || features.size() < 2) {
+        const QJsonDocument geojsonDoc = exportGeoJson(geojsonMap);
+        recorder.addTime(&QGeoJsonStats::conversionTime);
+        geojsonText = geojsonDoc.toJson(QJsonDocument::Compact);
+        recorder.addTime(&QGeoJsonStats::serializationTime);
+    } else {
+        // serialized by the workers
+        geojsonText = exportFeatureCollectionParallel(features, threadCount, options.coordinatePrecision,
+                                                      options.propertyTable);
+        recorder.addTime(&QGeoJsonStats::conversionTime);
+    }
+    recorder.addBytesOut(geojsonText.size());
+    return geojsonText;
+}
+
+/*!
+    Imports \a geojsonDoc into a columnar QGeoJsonGeometryStore instead of the QVariantMap
+    returned by importGeoJson(). Positions are copied straight from the JSON values into the
+    coordinate arrays of the store, no QGeoCoordinate is created.
+*/
+QGeoJsonGeometryStore QGeoJson::importGeometryStore(const QJsonDocument &geojsonDoc)
+{
+    QGeoJsonGeometryStore store;
+    const QJsonObject object = geojsonDoc.object();
+    const QString type = object.value(QStringLiteral("type")).toString();
+
+    bool isGeometry = false;
+    for (int i = QGeoJsonGeometryStore::Point; i <= QGeoJsonGeometryStore::GeometryCollection; ++i)
+        isGeometry |= type == QLatin1String(geoJsonTypeNames[i]);
+
+    if (isGeometry) {
+        store.setDocumentType(QGeoJsonGeometryStore::GeometryDocument);
+        importStoreGeometry(&store, object);
+    } else if (type == QLatin1String("Feature")) {
+        store.setDocumentType(QGeoJsonGeometryStore::FeatureDocument);
+        importStoreFeature(&store, object);
+    } else { // importGeoJson() falls back to FeatureCollection for unknown types
+        store.setDocumentType(QGeoJsonGeometryStore::FeatureCollectionDocument);
+        const QJsonArray features = object.value(QStringLiteral("features")).toArray();
+        for (const QJsonValue &feature: features)
+            importStoreFeature(&store, feature.toObject());
+    }
+
+    if (object.contains(QStringLiteral("bbox")))
+        store.setBoundingBox(object.value(QStringLiteral("bbox")).toVariant());
+    store.squeeze();
+    return store;
+}
+
+/*!
+    Imports the UTF-8 encoded \a geojsonText into a columnar QGeoJsonGeometryStore.
+
+    The text is parsed directly into the arrays of the store, without a QJsonDocument, in a
+    single pass: every number is checked and converted once, whatever the order of the
+    members of the objects. The
+    "properties" and "id" members of the features are not decoded either: their JSON text
+    is appended to a single buffer of the store and converted when
+    QGeoJsonGeometryStore::featureProperties() or featureId() are called. The whole
+    document therefore lives in a dozen contiguous allocations, independently of the number
+    of features, which are all released together with the store.
+
+    If \a error is not null, it reports the outcome of parsing. An unparsable document gives
+    an empty store.
+*/
+QGeoJsonGeometryStore QGeoJson::importGeometryStore(const QByteArray &geojsonText, QJsonParseError *error)
+{
+    QGeoJsonGeometryStore store;
+    GeoJsonTextParser parser(geojsonText.constData(), geojsonText.constData() + geojsonText.size());
+    if (!parser.parseStore(&store))
+        store = QGeoJsonGeometryStore();
+    if (error) {
+        error->error = parser.error();
+        error->offset = parser.errorOffset();
+    }
+    store.squeeze();
+    return store;
+}
+
+/*!
+    Scans the UTF-8 encoded \a geojsonText and returns a QGeoJsonLazyDocument, which keeps a
+    shallow copy of the text and decodes the members of the features when they are asked for.
+
+    The scan only validates the text and records where the "geometry", "properties" and "id"
+    members of every feature start and end. The numbers of the coordinates are checked
+    against the JSON grammar without being converted; only the "bbox" of the document is
+    read. A geometry is then decoded, with the same parser as importGeoJson(), the first time
+    QGeoJsonLazyDocument::featureGeometry() is called for its feature, and cached. Reading
+    the properties of all the features of a document therefore costs a fraction of a full
+    import.
+
+    If \a error is not null, it reports the outcome of parsing. An unparsable document gives
+    an empty FeatureCollection, as importGeoJson() does.
+*/
+QGeoJsonLazyDocument QGeoJson::importLazy(const QByteArray &geojsonText, QJsonParseError *error)
+{
+    return QGeoJsonLazyDocument::scan(geojsonText, std::function<bool(int)>(), error);
+}
+
+// importLazy(), reporting the bytes scanned to progress, which cancels the scan by returning false
+QGeoJsonLazyDocument QGeoJsonLazyDocument::scan(const QByteArray &geojsonText, const std::function<bool(int)> &progress,
+                                                QJsonParseError *error)
+{
+    QGeoJsonLazyDocument document;
+    GeoJsonTextParser parser(geojsonText.constData(), geojsonText.constData() + geojsonText.size());
+    parser.setScanProgress(progress);
+    if (parser.scanFeatures(&document.m_documentType, &document.m_ranges, &document.m_bbox)) {
+        document.m_text = geojsonText;
+        document.m_geometries.resize(document.m_ranges.size() / 6);
+    } else {
+        document = QGeoJsonLazyDocument();
+    }
+    if (error) {
+        error->error = parser.error();
+        error->offset = parser.errorOffset();
+    }
+    return document;
+}
+
+/*!
+    Exports \a store to a GeoJSON document. The document is the same exportGeoJson() produces
+    for the equivalent QVariantMap, coordinates are read from the arrays of the store without
+    creating QGeoCoordinate objects.
+*/
+QJsonDocument QGeoJson::exportGeometryStore(const QGeoJsonGeometryStore &store)
+{
+    QJsonObject newObject;
+    switch (store.documentType()) {
+    case QGeoJsonGeometryStore::GeometryDocument:
+        if (store.geometryCount()) {
+            int geometry = 0;
+            newObject = exportStoreGeometry(store, &geometry);
+        }
+        break;
+    case QGeoJsonGeometryStore::FeatureDocument:
+        if (store.featureCount())
+            newObject = exportStoreFeature(store, 0);
+        break;
+    case QGeoJsonGeometryStore::FeatureCollectionDocument:
+    {
+        QJsonArray features;
+        for (int i = 0; i < store.featureCount(); ++i)
+            features.append(exportStoreFeature(store, i));
+        newObject.insert(QStringLiteral("type"), QStringLiteral("FeatureCollection"));
+        newObject.insert(QStringLiteral("features"), features);
+        break;
+    }
+    }
+    return QJsonDocument(newObject);
+}
+
+// Binary snapshots of a QGeoJsonGeometryStore
+//
+// A snapshot file is the header below, followed by the arrays of the store in the byte order
+// of the machine that saved it, each one starting on an 8-byte boundary. The "properties"
+// and "id" members of the features are kept as JSON text, as addFeatureJson() does.
+
+enum GeoJsonSnapshotSection {
+    SnapshotX,
+    SnapshotY,
+    SnapshotZ,
+    SnapshotRingOffsets,
+    SnapshotPartOffsets,
+    SnapshotGeometryOffsets,
+    SnapshotGeometryTypes,
+    SnapshotGeometryChildren,
+    SnapshotFeatureGeometries,
+    SnapshotFeatureJsonOffsets,
+    SnapshotFeatureJson,
+    SnapshotBoundingBox,
+    SnapshotSectionCount
+};
+
+struct GeoJsonSnapshotHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 byteOrderMark; // 0x01020304 when read with the byte order of the file
+    quint32 documentType;
+    quint32 reserved;
+    quint64 fileSize;
+    quint64 dataChecksum; // of everything after the header
+    quint64 headerChecksum; // of the header, this member set to 0
+    struct {
+        quint64 offset;
+        quint64 size; // in bytes, not counting the padding
+    } sections[SnapshotSectionCount];
+};
+
+static const char snapshotMagic[8] = { 'Q', 'G', 'J', 'S', 'N', 'A', 'P', '\0' };
+static const quint32 snapshotVersion = 1;
+static const quint32 snapshotByteOrderMark = 0x01020304;
+static const quint64 snapshotChecksumSeed = Q_UINT64_C(14695981039346656037);
+
+// FNV-1a on 64-bit words with an extra shift, a partial last word is padded with zeros
+static quint64 snapshotChecksum(quint64 hash, const void *data, qint64 size)
+{
+    const uchar *bytes = static_cast<const uchar *>(data);
+    for (qint64 i = 0; i < size; i += 8) {
+        quint64 word = 0;
+        memcpy(&word, bytes + i, size_t(qMin<qint64>(8, size - i)));
+        hash = (hash ^ word) * Q_UINT64_C(1099511628211);
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+// An offset array with its end sentinel: from 0 to end, never decreasing
+static bool isSnapshotOffsetArray(const int *offsets, quint64 count, quint64 end)
+{
+    if (!count)
+        return true;
+    if (offsets[0] != 0)
+        return false;
+    for (quint64 i = 1; i < count; ++i) {
+        if (offsets[i] < offsets[i - 1])
+            return false;
+    }
+    return quint64(offsets[count - 1]) == end;
+}
+
+// Geometries in pre-order: each GeometryCollection is followed by the subtrees of its members
+static bool isSnapshotGeometryTree(const uchar *types, const int *children, int count)
+{
+    QVector<int> ends(count); // of the subtree of each geometry
+    for (int i = count - 1; i >= 0; --i) {
+        if (types[i] > QGeoJsonGeometryStore::GeometryCollection)
+            return false;
+        int next = i + 1;
+        if (types[i] == QGeoJsonGeometryStore::GeometryCollection) {
+            if (children[i] < 0 || children[i] > count - next)
+                return false;
+            for (int child = 0; child < children[i]; ++child) {
+                if (next >= count)
+                    return false;
+                next = ends.at(next);
+            }
+        }
+        ends[i] = next;
+    }
+    return true;
+}
+
+// The parts and rings the importers give each type, which storeGeometryMap() relies on: one
+// part for Point, LineString and Polygon, one ring per part of the points and paths, and one
+// position per ring of the points
+static bool isSnapshotGeometryParts(const uchar *types, const int *geometryOffsets, const int *partOffsets,
+                                    const int *ringOffsets, int count)
+{
+    for (int g = 0; g < count; ++g) {
+        const int type = types[g];
+        const int partBegin = geometryOffsets[g];
+        const int partEnd = geometryOffsets[g + 1];
+        if ((type == QGeoJsonGeometryStore::Point || type == QGeoJsonGeometryStore::LineString
+                || type == QGeoJsonGeometryStore::Polygon) && partEnd - partBegin != 1) {
+            return false;
+        }
+        if (type > QGeoJsonGeometryStore::MultiLineString)
+            continue;
+        for (int p = partBegin; p < partEnd; ++p) {
+            if (partOffsets[p + 1] - partOffsets[p] != 1)
+                return false;
+            const int r = partOffsets[p];
+            if ((type == QGeoJsonGeometryStore::Point || type == QGeoJsonGeometryStore::MultiPoint)
+                    && ringOffsets[r + 1] - ringOffsets[r] != 1) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void appendJsonVariantText(QByteArray *text, const QVariant &value)
+{
+    if (value != QVariant::Invalid) // a missing member is left empty
+        appendJsonValueText(text, QJsonValue::fromVariant(value));
+}
+
+/*!
+    Saves \a store to the file \a fileName as a binary snapshot, to be opened again with
+    loadSnapshot(). The file holds the coordinate and offset arrays of the store as they are
+    in memory, the geometry types, the "properties" and "id" members of the features as
+    JSON text, behind a versioned header with checksums.
+
+    The file is replaced atomically. Returns false, and sets \a errorString when it is not
+    null, if the file cannot be written.
+*/
+bool QGeoJson::saveSnapshot(const QGeoJsonGeometryStore &store, const QString &fileName, QString *errorString)
+{
+    // Features added with addFeature() are converted to the text kept by addFeatureJson()
+    QByteArray featureJson = store.m_featureJson;
+    QVector<int> featureJsonOffsets = store.m_featureJsonOffsets;
+    if (featureJsonOffsets.isEmpty() && store.featureCount()) {
+        featureJsonOffsets.append(0);
+        for (int i = 0; i < store.featureCount(); ++i) {
+            appendJsonVariantText(&featureJson, store.m_featureProperties.at(i));
+            featureJsonOffsets.append(featureJson.size());
+            appendJsonVariantText(&featureJson, store.m_featureIds.at(i));
+            featureJsonOffsets.append(featureJson.size());
+        }
+    }
+    QByteArray bbox;
+    appendJsonVariantText(&bbox, store.boundingBox());
+
+    const void *sectionData[SnapshotSectionCount] = {
+        store.m_x.constData(),
+        store.m_y.constData(),
+        store.m_z.constData(),
+        store.m_ringOffsets.constData(),
+        store.m_partOffsets.constData(),
+        store.m_geometryOffsets.constData(),
+        store.m_geometryTypes.constData(),
+        store.m_geometryChildren.constData(),
+        store.m_featureGeometries.constData(),
+        featureJsonOffsets.constData(),
+        featureJson.constData(),
+        bbox.constData()
+    };
+    const qint64 sectionSizes[SnapshotSectionCount] = {
+        qint64(store.m_x.size()) * qint64(sizeof(double)),
+        qint64(store.m_y.size()) * qint64(sizeof(double)),
+        qint64(store.m_z.size()) * qint64(sizeof(double)),
+        qint64(store.m_ringOffsets.size()) * qint64(sizeof(int)),
+        qint64(store.m_partOffsets.size()) * qint64(sizeof(int)),
+        qint64(store.m_geometryOffsets.size()) * qint64(sizeof(int)),
+        qint64(store.m_geometryTypes.size()),
+        qint64(store.m_geometryChildren.size()) * qint64(sizeof(int)),
+        qint64(store.m_featureGeometries.size()) * qint64(sizeof(int)),
+        qint64(featureJsonOffsets.size()) * qint64(sizeof(int)),
+        qint64(featureJson.size()),
+        qint64(bbox.size())
+    };
+
+    GeoJsonSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+    header.version = snapshotVersion;
+    header.byteOrderMark = snapshotByteOrderMark;
+    header.documentType = store.documentType();
+    quint64 offset = sizeof(header);
+    quint64 dataChecksum = snapshotChecksumSeed;
+    for (int i = 0; i < SnapshotSectionCount; ++i) {
+        header.sections[i].offset = offset;
+        header.sections[i].size = quint64(sectionSizes[i]);
+        offset += (quint64(sectionSizes[i]) + 7) & ~Q_UINT64_C(7);
+        dataChecksum = snapshotChecksum(dataChecksum, sectionData[i], sectionSizes[i]);
+    }
+    header.fileSize = offset;
+    header.dataChecksum = dataChecksum;
+    header.headerChecksum = snapshotChecksum(snapshotChecksumSeed, &header, sizeof(header));
+
+    QSaveFile file(fileName);
+    bool written = file.open(QIODevice::WriteOnly)
+            && file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header));
+    static const char padding[8] = {};
+    for (int i = 0; written && i < SnapshotSectionCount; ++i) {
+        const qint64 paddingSize = -sectionSizes[i] & 7;
+        written = file.write(static_cast<const char *>(sectionData[i]), sectionSizes[i]) == sectionSizes[i]
+                && file.write(padding, paddingSize) == paddingSize;
+    }
+    if (!written || !file.commit()) {
+        if (errorString)
+            *errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+/*!
+    Opens the snapshot saved by saveSnapshot() in the file \a fileName.
+
+    The file is memory-mapped, and the returned QGeoJsonSnapshot reads the geometries and
+    features straight from the mapping when they are asked for: opening a snapshot checks its
+    header and walks its offset arrays, a few bytes per ring, part and geometry, without
+    reading the coordinates. Files that cannot be mapped are read into memory instead.
+    QGeoJsonSnapshot::verifyChecksum() checks the rest of the file.
+
+    If the file cannot be opened, or is not a snapshot of this version and byte order, a null
+    snapshot is returned and, when \a errorString is not null, it is set to the reason.
+*/
+QGeoJsonSnapshot QGeoJson::loadSnapshot(const QString &fileName, QString *errorString)
+{
+    QGeoJsonSnapshot snapshot;
+    QSharedPointer<QFile> file(new QFile(fileName));
+    if (!file->open(QIODevice::ReadOnly)) {
+        if (errorString)
+            *errorString = file->errorString();
+        return snapshot;
+    }
+
+    const qint64 size = file->size();
+    const uchar *mapped = size > 0 ? file->map(0, size) : nullptr;
+    if (mapped) {
+        snapshot.m_file = file; // unmapped when the last copy of the snapshot is destroyed
+    } else {
+        snapshot.m_data = file->readAll();
+        mapped = reinterpret_cast<const uchar *>(snapshot.m_data.constData());
+    }
+    if (!snapshot.setData(mapped, snapshot.m_file ? size : snapshot.m_data.size(), errorString))
+        return QGeoJsonSnapshot();
+    return snapshot;
+}
+
+/*!
+    Imports \a geojsonDoc into a typed QGeoJsonObject tree instead of a QVariantMap.
+
+    The content is the same as the one returned by importGeoJson(), and
+    QGeoJsonObject::toVariantMap() converts between the two; but the type of every object is
+    an enum value rather than a map key, and geometries hold their QGeoShape objects directly,
+    so no QVariant is created for coordinates, geometries or features.
+*/
+QGeoJsonObject QGeoJson::importTyped(const QJsonDocument &geojsonDoc)
+{
+    // unknown types are imported as FeatureCollection, as importGeoJson() does
+    const QJsonObject object = geojsonDoc.object();
+    const QString type = object.value(QStringLiteral("type")).toString();
+    int i = QGeoJsonObject::Point;
+    for (; i < QGeoJsonObject::FeatureCollection; ++i) {
+        if (type == QLatin1String(geoJsonTypeNames[i]))
+            break;
+    }
+
+    QGeoJsonObject parsedObject;
+    switch (i) {
+    case QGeoJsonObject::Feature:
+        parsedObject = importTypedFeature(object);
+        break;
+    case QGeoJsonObject::FeatureCollection:
+    {
+        parsedObject = QGeoJsonObject(QGeoJsonObject::FeatureCollection);
+        for (const QJsonValue &feature: object.value(QStringLiteral("features")).toArray())
+            parsedObject.append(importTypedFeature(feature.toObject()));
+        break;
+    }
+    default:
+        parsedObject = importTypedGeometry(object);
+        break;
+    }
+
+    const QVariant bboxValue = object.value(QStringLiteral("bbox")).toVariant();
+    if (bboxValue != QVariant::Invalid)
+        parsedObject.setBoundingBox(bboxValue);
+    return parsedObject;
+}
+
+/*!
+    Exports \a geojsonObject, producing the same document as exportGeoJson() does for
+    \a geojsonObject.toVariantMap().
+*/
+QJsonDocument QGeoJson::exportTyped(const QGeoJsonObject &geojsonObject)
+{
+    return QJsonDocument(exportTypedObject(geojsonObject));
+}
+
+// CBOR import and export, with the positions packed in RFC 8746 typed arrays
+
+enum GeoJsonCborTag : quint64 {
+    CborMultiDimensionalArrayTag = 40, // [[rows, columns], elements], row-major
+    CborFloat64BigEndianArrayTag = 82,
+    CborFloat64LittleEndianArrayTag = 86
+};
+
+// The values of a typed array of doubles, or of an array of numbers
+static QVector<double> importCborNumbers(const QCborValue &value)
+{
+    QVector<double> numbers;
+    if (value.isTag()) {
+        const quint64 tag = quint64(value.tag());
+        if (tag != CborFloat64LittleEndianArrayTag && tag != CborFloat64BigEndianArrayTag)
+            return numbers;
+        const QByteArray bytes = value.taggedValue().toByteArray();
+        numbers.resize(bytes.size() / 8);
+        for (int i = 0; i < numbers.size(); ++i) {
+            const char *element = bytes.constData() + 8 * i;
+            const quint64 bits = tag == CborFloat64LittleEndianArrayTag ? qFromLittleEndian<quint64>(element)
+                                                                        : qFromBigEndian<quint64>(element);
+            memcpy(&numbers[i], &bits, sizeof(bits));
+        }
+        return numbers;
+    }
+    const QCborArray array = value.toArray();
+    numbers.reserve(array.size());
+    for (const QCborValue &number: array)
+        numbers.append(number.toDouble(qQNaN()));
+    return numbers;
+}
+
+static QGeoCoordinate importCborCoordinate(const double *values, int size)
+{
+    QGeoCoordinate parsedCoordinates;
+    if (size > 0)
+        parsedCoordinates.setLatitude(values[0]);
+    if (size > 1)
+        parsedCoordinates.setLongitude(values[1]);
+    if (size > 2)
+        parsedCoordinates.setAltitude(values[2]);
+    return parsedCoordinates;
+}
+
+static QGeoCoordinate importCborPosition(const QCborValue &position)
+{
+    const QVector<double> numbers = importCborNumbers(position);
+    return importCborCoordinate(numbers.constData(), numbers.size());
+}
+
+static QList<QGeoCoordinate> importCborPositions(const QCborValue &positions)
+{
+    QList<QGeoCoordinate> parsedCoordinatesLine;
+    if (positions.isTag() && quint64(positions.tag()) == CborMultiDimensionalArrayTag) {
+        const QCborArray array = positions.taggedValue().toArray();
+        const int dimension = int(array.at(0).toArray().at(1).toInteger());
+        const QVector<double> numbers = importCborNumbers(array.at(1));
+        if (dimension < 1)
+            return parsedCoordinatesLine;
+        const int count = numbers.size() / dimension;
+        parsedCoordinatesLine.reserve(count);
+        for (int i = 0; i < count; ++i)
+            parsedCoordinatesLine.append(importCborCoordinate(numbers.constData() + i * dimension, dimension));
+        return parsedCoordinatesLine;
+    }
+    const QCborArray array = positions.toArray();
+    parsedCoordinatesLine.reserve(array.size());
+    for (const QCborValue &position: array)
+        parsedCoordinatesLine.append(importCborPosition(position));
+    return parsedCoordinatesLine;
+}
+
+static QList<QList<QGeoCoordinate>> importCborRings(const QCborValue &rings)
+{
+    QList<QList<QGeoCoordinate>> parsedCoordinatesPoly;
+    for (const QCborValue &ring: rings.toArray())
+        parsedCoordinatesPoly.append(importCborPositions(ring));
+    return parsedCoordinatesPoly;
+}
+
+static QVariantMap importCborGeometry(const QCborMap &geometry)
+{
+    // unknown types are imported as GeometryCollection, as importGeometry() does
+    const QString type = geometry.value(QStringLiteral("type")).toString();
+    int i = QGeoJsonGeometryStore::Point;
+    for (; i < QGeoJsonGeometryStore::GeometryCollection; ++i) {
+        if (type == QLatin1String(geoJsonTypeNames[i]))
+            break;
+    }
+
+    const QCborValue coordinates = geometry.value(QStringLiteral("coordinates"));
+    QVariant geoValue;
+    switch (i) {
+    case QGeoJsonGeometryStore::Point:
+    {
+        QGeoCircle parsedPoint;
+        parsedPoint.setCenter(importCborPosition(coordinates));
+        geoValue = QVariant::fromValue(parsedPoint);
+        break;
+    }
+    case QGeoJsonGeometryStore::MultiPoint:
+        geoValue = QVariant::fromValue(importMultiPointCoordinates(importCborPositions(coordinates)));
+        break;
+    case QGeoJsonGeometryStore::LineString:
+    {
+        QGeoPath parsedLineString;
+        parsedLineString.setPath(importCborPositions(coordinates));
+        geoValue = QVariant::fromValue(parsedLineString);
+        break;
+    }
+    case QGeoJsonGeometryStore::MultiLineString:
+        geoValue = QVariant::fromValue(importMultiLineStringCoordinates(importCborRings(coordinates)));
+        break;
+    case QGeoJsonGeometryStore::Polygon:
+        geoValue = QVariant::fromValue(importPolygonPerimeters(importCborRings(coordinates)));
+        break;
+    case QGeoJsonGeometryStore::MultiPolygon:
+    {
+        QList<QList<QList<QGeoCoordinate>>> polygons;
+        for (const QCborValue &polygon: coordinates.toArray())
+            polygons.append(importCborRings(polygon));
+        geoValue = QVariant::fromValue(importMultiPolygonCoordinates(polygons));
+        break;
+    }
+    case QGeoJsonGeometryStore::GeometryCollection:
+    {
+        QVariantList members;
+        for (const QCborValue &member: geometry.value(QStringLiteral("geometries")).toArray())
+            members.append(importCborGeometry(member.toMap()));
+        geoValue = QVariant::fromValue(members);
+        break;
+    }
+    }
+
+    QVariantMap parsedGeoJsonMap;
+    parsedGeoJsonMap.insert(QString::fromLatin1(geoJsonTypeNames[i]), geoValue);
+    return parsedGeoJsonMap;
+}
+
+static QVariantMap importCborFeature(const QCborMap &feature)
+{
+    QVariantMap parsedFeature;
+    parsedFeature.insert(QStringLiteral("geometry"), importCborGeometry(feature.value(QStringLiteral("geometry")).toMap()));
+    parsedFeature.insert(QStringLiteral("properties"), feature.value(QStringLiteral("properties")).toVariant());
+    const QVariant id = feature.value(QStringLiteral("id")).toVariant();
+    if (id != QVariant::Invalid)
+        parsedFeature.insert(QStringLiteral("id"), id);
+    return parsedFeature;
+}
+
+// A typed array of doubles, in little endian order
+static QCborValue exportCborNumbers(const double *values, int size)
+{
+    QByteArray bytes;
+    bytes.resize(8 * size);
+    for (int i = 0; i < size; ++i) {
+        quint64 bits;
+        memcpy(&bits, values + i, sizeof(bits));
+        qToLittleEndian<quint64>(bits, bytes.data() + 8 * i);
+    }
+    return QCborValue(QCborTag(CborFloat64LittleEndianArrayTag), bytes);
+}
+
+static QCborValue exportCborPosition(const QGeoCoordinate &coordinate)
+{
+    const double values[3] = { coordinate.latitude(), coordinate.longitude(), coordinate.altitude() };
+    return exportCborNumbers(values, qIsNaN(values[2]) ? 2 : 3);
+}
+
+// A rows x dimension array, the altitude column only being there if a position has one
+static QCborValue exportCborPositions(const QList<QGeoCoordinate> &coordinates)
+{
+    int dimension = 2;
+    for (const QGeoCoordinate &coordinate: coordinates) {
+        if (!qIsNaN(coordinate.altitude())) {
+            dimension = 3;
+            break;
+        }
+    }
+
+    QVector<double> values;
+    values.reserve(coordinates.size() * dimension);
+    for (const QGeoCoordinate &coordinate: coordinates) {
+        values.append(coordinate.latitude());
+        values.append(coordinate.longitude());
+        if (dimension == 3)
+            values.append(coordinate.altitude());
+    }
+    const QCborArray shape = { qint64(coordinates.size()), qint64(dimension) };
+    const QCborArray array = { shape, exportCborNumbers(values.constData(), values.size()) };
+    return QCborValue(QCborTag(CborMultiDimensionalArrayTag), array);
+}
+
+static QCborValue exportCborRings(const QGeoPolygon &polygon)
+{
+    QCborArray rings;
+    rings.append(exportCborPositions(polygon.path()));
+    for (int i = 0; i < polygon.holesCount(); ++i)
+        rings.append(exportCborPositions(polygon.holePath(i)));
+    return rings;
+}
+
+// Same members as exportGeometry(), the last geometry key found in the map wins
+static QCborMap exportCborGeometry(const QVariantMap &geometryMap)
+{
+    QCborMap parsedGeometry;
+    int i = QGeoJsonGeometryStore::GeometryCollection;
+    for (; i >= QGeoJsonGeometryStore::Point; --i) {
+        if (geometryMap.contains(QLatin1String(geoJsonTypeNames[i])))
+            break;
+    }
+    if (i < QGeoJsonGeometryStore::Point)
+        return parsedGeometry;
+
+    const QVariant geoValue = geometryMap.value(QLatin1String(geoJsonTypeNames[i]));
+    QCborArray array;
+    parsedGeometry.insert(QStringLiteral("type"), QLatin1String(geoJsonTypeNames[i]));
+    switch (i) {
+    case QGeoJsonGeometryStore::Point:
+        parsedGeometry.insert(QStringLiteral("coordinates"), exportCborPosition(geoValue.value<QGeoCircle>().center()));
+        break;
+    case QGeoJsonGeometryStore::MultiPoint:
+    {
+        QList<QGeoCoordinate> centers;
+        for (const QVariant &circle: geoValue.value<QVariantList>())
+            centers.append(circle.value<QGeoCircle>().center());
+        parsedGeometry.insert(QStringLiteral("coordinates"), exportCborPositions(centers));
+        break;
+    }
+    case QGeoJsonGeometryStore::LineString:
+        parsedGeometry.insert(QStringLiteral("coordinates"), exportCborPositions(geoValue.value<QGeoPath>().path()));
+        break;
+    case QGeoJsonGeometryStore::MultiLineString:
+        for (const QVariant &path: geoValue.value<QVariantList>())
+            array.append(exportCborPositions(path.value<QGeoPath>().path()));
+        parsedGeometry.insert(QStringLiteral("coordinates"), array);
+        break;
+    case QGeoJsonGeometryStore::Polygon:
+        parsedGeometry.insert(QStringLiteral("coordinates"), exportCborRings(geoValue.value<QGeoPolygon>()));
+        break;
+    case QGeoJsonGeometryStore::MultiPolygon:
+        for (const QVariant &polygon: geoValue.value<QVariantList>())
+            array.append(exportCborRings(polygon.value<QGeoPolygon>()));
+        parsedGeometry.insert(QStringLiteral("coordinates"), array);
+        break;
+    case QGeoJsonGeometryStore::GeometryCollection:
+        for (const QVariant &member: geoValue.value<QVariantList>())
+            array.append(exportCborGeometry(member.value<QVariantMap>()));
+        parsedGeometry.insert(QStringLiteral("geometries"), array);
+        break;
+    }
+    return parsedGeometry;
+}
+
+// Same members as exportFeature(): "properties" is always a map, "id" null when missing
+static QCborMap exportCborFeature(const QVariantMap &feature)
+{
+    const QVariantMap featureMap = feature.value(QStringLiteral("Feature")).value<QVariantMap>();
+    const QVariant id = featureMap.value(QStringLiteral("id"));
+    QCborMap parsedFeature;
+    parsedFeature.insert(QStringLiteral("type"), QLatin1String("Feature"));
+    parsedFeature.insert(QStringLiteral("geometry"), exportCborGeometry(featureMap.value(QStringLiteral("geometry")).value<QVariantMap>()));
+    parsedFeature.insert(QStringLiteral("properties"), QCborMap::fromVariantMap(featureMap.value(QStringLiteral("properties")).toMap()));
+    parsedFeature.insert(QStringLiteral("id"), id != QVariant::Invalid ? QCborValue::fromVariant(id) : QCborValue(nullptr));
+    return parsedFeature;
+}
+
+/*!
+    Imports the GeoJSON object \a geojsonValue, decoded from CBOR, into a QVariantMap with the
+    same layout as the one returned by importGeoJson(const QJsonDocument &).
+
+    The CBOR value has the members of the GeoJSON object model, "type", "coordinates",
+    "geometries", "features", "properties", "id" and "bbox". A position, and a list of
+    positions, can be a packed RFC 8746 typed array of doubles: a float64 typed array (tag 86
+    or 82) for a single position, a row-major multi-dimensional array (tag 40) of them for a
+    list, as exportGeoJsonCbor() writes. Arrays of numbers are accepted too.
+*/
+QVariantMap QGeoJson::importGeoJsonCbor(const QCborValue &geojsonValue)
+{
+    // unknown types are imported as FeatureCollection, as importGeoJson() does
+    const QCborMap object = geojsonValue.toMap();
+    const QString type = object.value(QStringLiteral("type")).toString();
+    int i = QGeoJsonObject::Point;
+    for (; i < QGeoJsonObject::FeatureCollection; ++i) {
+        if (type == QLatin1String(geoJsonTypeNames[i]))
+            break;
+    }
+
+    QVariantMap parsedGeoJsonMap;
+    switch (i) {
+    case QGeoJsonObject::Feature:
+        parsedGeoJsonMap.insert(QStringLiteral("Feature"), importCborFeature(object));
+        break;
+    case QGeoJsonObject::FeatureCollection:
+    {
+        const QString keyFeature = QStringLiteral("Feature");
+        QVariantList features;
+        QVariantMap importedMap;
+        for (const QCborValue &feature: object.value(QStringLiteral("features")).toArray()) {
+            importedMap.insert(keyFeature, importCborFeature(feature.toMap()));
+            features.append(importedMap);
+        }
+        parsedGeoJsonMap.insert(QStringLiteral("FeatureCollection"), features);
+        break;
+    }
+    default:
+        parsedGeoJsonMap = importCborGeometry(object);
+        break;
+    }
+
+    const QVariant bboxValue = object.value(QStringLiteral("bbox")).toVariant();
+    if (bboxValue != QVariant::Invalid)
+        parsedGeoJsonMap.insert(QStringLiteral("bbox"), bboxValue);
+    return parsedGeoJsonMap;
+}
+
+/*!
+    Decodes \a geojsonCbor and imports it as importGeoJsonCbor(const QCborValue &) does.
+    If \a error is not null, it reports the outcome of decoding.
+*/
+QVariantMap QGeoJson::importGeoJsonCbor(const QByteArray &geojsonCbor, QCborParserError *error)
+{
+    return importGeoJsonCbor(QCborValue::fromCbor(geojsonCbor, error));
+}
+
+/*!
+    Exports \a geojsonMap as a CBOR value, with the members exportGeoJson() writes in the
+    JSON document and the positions packed in RFC 8746 typed arrays of little endian doubles.
+    Call QCborValue::toCbor() on the result to get the encoded bytes.
+*/
+QCborValue QGeoJson::exportGeoJsonCbor(const QVariantMap &geojsonMap)
+{
+    if (geojsonMap.contains(QStringLiteral("FeatureCollection"))) {
+        QCborArray features;
+        for (const QVariant &feature: geojsonMap.value(QStringLiteral("FeatureCollection")).value<QVariantList>())
+            features.append(exportCborFeature(feature.value<QVariantMap>()));
+        QCborMap parsedFeatureCollection;
+        parsedFeatureCollection.insert(QStringLiteral("type"), QLatin1String("FeatureCollection"));
+        parsedFeatureCollection.insert(QStringLiteral("features"), features);
+        return parsedFeatureCollection;
+    }
+    if (geojsonMap.contains(QStringLiteral("Feature")))
+        return exportCborFeature(geojsonMap);
+    return exportCborGeometry(geojsonMap);
+}
+
+// Read side shared by QGeoJsonGeometryStore and QGeoJsonSnapshot, which have the same interface
+
+template <typename Store>
+static QGeoCircle storeToGeoCircle(const Store &store, int geometry, int part)
+{
+    QGeoCircle parsedPoint;
+    if (store.ringCount(geometry, part) > 0) {
+        const QGeoJsonGeometryStore::CoordinateView view = store.ring(geometry, part, 0);
+        if (view.size > 0)
+            parsedPoint.setCenter(view.coordinate(0));
+    }
+    return parsedPoint;
+}
+
+template <typename Store>
+static QGeoPath storeToGeoPath(const Store &store, int geometry, int part)
+{
+    QGeoPath parsedLineString;
+    if (store.ringCount(geometry, part) > 0)
+        parsedLineString.setPath(store.ring(geometry, part, 0).toList());
+    return parsedLineString;
+}
+
+template <typename Store>
+static QGeoPolygon storeToGeoPolygon(const Store &store, int geometry, int part)
+{
+    QList<QList<QGeoCoordinate>> perimeters;
+    const int rings = store.ringCount(geometry, part);
+    for (int r = 0; r < rings; ++r)
+        perimeters.append(store.ring(geometry, part, r).toList());
+    return importPolygonPerimeters(perimeters);
+}
+
+template <typename Store>
+static QVariantMap storeGeometryMap(const Store &store, int *geometry)
+{
+    const int g = (*geometry)++;
+    const QGeoJsonGeometryStore::GeometryType type = store.geometryType(g);
+    const int parts = store.partCount(g);
+
+    QVariant geoValue;
+    switch (type) {
+    case QGeoJsonGeometryStore::Point:
+        geoValue = QVariant::fromValue(storeToGeoCircle(store, g, 0));
+        break;
+    case QGeoJsonGeometryStore::MultiPoint:
+    {
+        QList<QGeoCoordinate> centers;
+        for (int part = 0; part < parts; ++part)
+            centers.append(store.ring(g, part, 0).coordinate(0));
+        geoValue = QVariant::fromValue(importMultiPointCoordinates(centers));
+        break;
+    }
+    case QGeoJsonGeometryStore::LineString:
+        geoValue = QVariant::fromValue(storeToGeoPath(store, g, 0));
+        break;
+    case QGeoJsonGeometryStore::MultiLineString:
+    {
+        QList<QList<QGeoCoordinate>> paths;
+        for (int part = 0; part < parts; ++part)
+            paths.append(store.ring(g, part, 0).toList());
+        geoValue = QVariant::fromValue(importMultiLineStringCoordinates(paths));
+        break;
+    }
+    case QGeoJsonGeometryStore::Polygon:
+        geoValue = QVariant::fromValue(storeToGeoPolygon(store, g, 0));
+        break;
+    case QGeoJsonGeometryStore::MultiPolygon:
+    {
+        QList<QList<QList<QGeoCoordinate>>> polygons;
+        for (int part = 0; part < parts; ++part) {
+            QList<QList<QGeoCoordinate>> perimeters;
+            const int rings = store.ringCount(g, part);
+            for (int r = 0; r < rings; ++r)
+                perimeters.append(store.ring(g, part, r).toList());
+            polygons.append(perimeters);
+        }
+        geoValue = QVariant::fromValue(importMultiPolygonCoordinates(polygons));
+        break;
+    }
+    case QGeoJsonGeometryStore::GeometryCollection:
+    {
+        QVariantList members;
+        const int count = store.childCount(g);
+        for (int i = 0; i < count; ++i)
+            members.append(storeGeometryMap(store, geometry));
+        geoValue = QVariant::fromValue(members);
+        break;
+    }
+    }
+
+    QVariantMap parsedGeoJsonMap;
+    parsedGeoJsonMap.insert(QString::fromLatin1(geoJsonTypeNames[type]), geoValue);
+    return parsedGeoJsonMap;
+}
+
+template <typename Store>
+static QVariantMap storeFeatureMap(const Store &store, int feature)
+{
+    QVariantMap parsedFeature;
+    int geometry = store.featureGeometry(feature);
+    parsedFeature.insert(QStringLiteral("geometry"), storeGeometryMap(store, &geometry));
+    parsedFeature.insert(QStringLiteral("properties"), store.featureProperties(feature));
+    const QVariant id = store.featureId(feature);
+    if (id != QVariant::Invalid)
+        parsedFeature.insert(QStringLiteral("id"), id);
+    return parsedFeature;
+}
+
+template <typename Store>
+static QVariantMap storeToVariantMap(const Store &store)
+{
+    QVariantMap parsedGeoJsonMap;
+    if (store.documentType() == QGeoJsonGeometryStore::GeometryDocument) {
+        int geometry = 0;
+        if (store.geometryCount())
+            parsedGeoJsonMap = storeGeometryMap(store, &geometry);
+    } else if (store.documentType() == QGeoJsonGeometryStore::FeatureDocument) {
+        if (store.featureCount())
+            parsedGeoJsonMap.insert(QStringLiteral("Feature"), storeFeatureMap(store, 0));
+    } else {
+        const QString keyFeature = QStringLiteral("Feature");
+        QVariantList features;
+        QVariantMap importedMap;
+        for (int i = 0; i < store.featureCount(); ++i) {
+            importedMap.insert(keyFeature, storeFeatureMap(store, i));
+            features.append(importedMap);
+        }
+        parsedGeoJsonMap.insert(QStringLiteral("FeatureCollection"), features);
+    }
+
+    if (store.boundingBox() != QVariant::Invalid)
+        parsedGeoJsonMap.insert(QStringLiteral("bbox"), store.boundingBox());
+    return parsedGeoJsonMap;
+}
+
+/*! \class QGeoJsonGeometryStore
+    \inmodule Qt.labs.location
+    \ingroup json
+    \since WIP
+
+    \brief The QGeoJsonGeometryStore class holds the geometries of a GeoJSON document in flat arrays.
+
+    All positions of the document are stored in three contiguous arrays of doubles: x and y
+    for the first two values of every GeoJSON position and z, only allocated if some position
+    has an altitude. Three offset arrays group them: positions into rings, rings into parts and
+    parts into geometries. A part is a member of a multipart geometry, or the geometry itself
+    for the single types; a ring is a linear sequence of positions, one per point, path, or
+    polygon perimeter. GeometryCollections own no parts, their members follow them in the
+    geometry list. Features reference the geometry they own, and keep their "properties" and
+    "id" members as QVariants, or as JSON text in a single buffer when added with
+    addFeatureJson().
+
+    CoordinateView gives zero-copy access to a ring, while toGeoCircle(), toGeoPath(),
+    toGeoPolygon() and toVariantMap() build the Qt Location types on demand. As with
+    QGeoJson::importGeoJson(), x is stored as latitude and y as longitude in the
+    QGeoCoordinate objects created.
+*/
+
+QGeoCoordinate QGeoJsonGeometryStore::CoordinateView::coordinate(int i) const
+{
+    QGeoCoordinate parsedCoordinates;
+    parsedCoordinates.setLatitude(x[i]);
+    parsedCoordinates.setLongitude(y[i]);
+    if (z)
+        parsedCoordinates.setAltitude(z[i]);
+    return parsedCoordinates;
+}
+
+QList<QGeoCoordinate> QGeoJsonGeometryStore::CoordinateView::toList() const
+{
+    QList<QGeoCoordinate> coordinates;
+    coordinates.reserve(size);
+    for (int i = 0; i < size; ++i)
+        coordinates.append(coordinate(i));
+    return coordinates;
+}
+
+QGeoJsonGeometryStore::QGeoJsonGeometryStore()
+    : m_documentType(GeometryDocument)
+{
+    m_ringOffsets.append(0);
+    m_partOffsets.append(0);
+    m_geometryOffsets.append(0);
+}
+
+/*!
+    Appends a geometry of the given \a type and returns its index. A GeometryCollection must
+    be followed by its \a childCount members.
+*/
+int QGeoJsonGeometryStore::addGeometry(GeometryType type, int childCount)
+{
+    m_geometryTypes.append(quint8(type));
+    m_geometryChildren.append(childCount);
+    m_geometryOffsets.append(m_geometryOffsets.last());
+    return m_geometryTypes.size() - 1;
+}
+
+void QGeoJsonGeometryStore::addPart()
+{
+    m_partOffsets.append(m_partOffsets.last());
+    ++m_geometryOffsets.last();
+}
+
+void QGeoJsonGeometryStore::addRing()
+{
+    m_ringOffsets.append(m_ringOffsets.last());
+    ++m_partOffsets.last();
+}
+
+void QGeoJsonGeometryStore::addPosition(double x, double y)
+{
+    m_x.append(x);
+    m_y.append(y);
+    if (!m_z.isEmpty())
+        m_z.append(qQNaN());
+    ++m_ringOffsets.last();
+}
+
+void QGeoJsonGeometryStore::addPosition(double x, double y, double z)
+{
+    if (m_z.isEmpty() && !m_x.isEmpty())
+        m_z.fill(qQNaN(), m_x.size()); // first altitude of the store
+    m_x.append(x);
+    m_y.append(y);
+    m_z.append(z);
+    ++m_ringOffsets.last();
+}
+
+void QGeoJsonGeometryStore::addFeature(int geometry, const QVariant &properties, const QVariant &id)
+{
+    Q_ASSERT(m_featureJsonOffsets.isEmpty());
+    m_featureGeometries.append(geometry);
+    m_featureProperties.append(properties);
+    m_featureIds.append(id);
+}
+
+/*!
+    Adds a feature owning \a geometry whose "properties" and "id" members are given as JSON
+    text, \a propertiesLength bytes at \a properties and \a idLength bytes at \a id; a
+    length of 0 stands for a missing member. The text is copied into the store, and only
+    decoded by featureProperties() and featureId().
+
+    A store keeps all its features either as QVariants or as JSON text: addFeature() and
+    addFeatureJson() cannot be mixed.
+*/
+void QGeoJsonGeometryStore::addFeatureJson(int geometry, const char *properties, int propertiesLength,
+                                           const char *id, int idLength)
+{
+    Q_ASSERT(m_featureProperties.isEmpty());
+    if (m_featureJsonOffsets.isEmpty())
+        m_featureJsonOffsets.append(0);
+    m_featureGeometries.append(geometry);
+    m_featureJson.append(properties, propertiesLength);
+    m_featureJsonOffsets.append(m_featureJson.size());
+    m_featureJson.append(id, idLength);
+    m_featureJsonOffsets.append(m_featureJson.size());
+}
+
+/*!
+    Inserts a GeometryCollection at index \a geometry, made of the \a childCount geometries
+    already added from that index on, and returns its index. This lets a collection be added
+    once its members are known; no feature may refer to the geometries moved.
+*/
+int QGeoJsonGeometryStore::insertGeometryCollection(int geometry, int childCount)
+{
+    // a collection has no part, it starts where the next geometry does
+    m_geometryTypes.insert(geometry, quint8(GeometryCollection));
+    m_geometryChildren.insert(geometry, childCount);
+    m_geometryOffsets.insert(geometry, m_geometryOffsets.at(geometry));
+    return geometry;
+}
+
+/*!
+    Removes the geometries from index \a geometryCount on, with their parts, rings and
+    positions, and the features from index \a featureCount on.
+*/
+void QGeoJsonGeometryStore::truncate(int geometryCount, int featureCount)
+{
+    const int partCount = m_geometryOffsets.at(geometryCount);
+    const int ringCount = m_partOffsets.at(partCount);
+    const int positionCount = m_ringOffsets.at(ringCount);
+    m_geometryTypes.resize(geometryCount);
+    m_geometryChildren.resize(geometryCount);
+    m_geometryOffsets.resize(geometryCount + 1);
+    m_partOffsets.resize(partCount + 1);
+    m_ringOffsets.resize(ringCount + 1);
+    m_x.resize(positionCount);
+    m_y.resize(positionCount);
+    if (!m_z.isEmpty())
+        m_z.resize(positionCount);
+
+    m_featureGeometries.resize(featureCount);
+    while (m_featureProperties.size() > featureCount) {
+        m_featureProperties.removeLast();
+        m_featureIds.removeLast();
+    }
+    if (!m_featureJsonOffsets.isEmpty()) {
+        m_featureJsonOffsets.resize(2 * featureCount + 1);
+        m_featureJson.resize(m_featureJsonOffsets.last());
+    }
+}
+
+/*!
+    Releases the memory reserved by the arrays while the store was being built.
+*/
+void QGeoJsonGeometryStore::squeeze()
+{
+    m_x.squeeze();
+    m_y.squeeze();
+    m_z.squeeze();
+    m_ringOffsets.squeeze();
+    m_partOffsets.squeeze();
+    m_geometryOffsets.squeeze();
+    m_geometryTypes.squeeze();
+    m_geometryChildren.squeeze();
+    m_featureGeometries.squeeze();
+    m_featureJson.squeeze();
+    m_featureJsonOffsets.squeeze();
+}
+
+QVariant QGeoJsonGeometryStore::featureProperties(int feature) const
+{
+    if (m_featureJsonOffsets.isEmpty())
+        return m_featureProperties.at(feature);
+    return featureJsonValue(2 * feature);
+}
+
+QVariant QGeoJsonGeometryStore::featureId(int feature) const
+{
+    if (m_featureJsonOffsets.isEmpty())
+        return m_featureIds.at(feature);
+    return featureJsonValue(2 * feature + 1);
+}
+
+QVariant QGeoJsonGeometryStore::featureJsonValue(int slot) const
+{
+    const int begin = m_featureJsonOffsets.at(slot);
+    const int end = m_featureJsonOffsets.at(slot + 1);
+    if (begin == end)
+        return QVariant();
+    GeoJsonTextParser parser(m_featureJson.constData() + begin, m_featureJson.constData() + end);
+    return parser.parseJsonValue();
+}
+
+int QGeoJsonGeometryStore::partCount(int geometry) const
+{
+    return m_geometryOffsets.at(geometry + 1) - m_geometryOffsets.at(geometry);
+}
+
+int QGeoJsonGeometryStore::ringCount(int geometry, int part) const
+{
+    const int p = m_geometryOffsets.at(geometry) + part;
+    return m_partOffsets.at(p + 1) - m_partOffsets.at(p);
+}
+
+QGeoJsonGeometryStore::CoordinateView QGeoJsonGeometryStore::ring(int geometry, int part, int ring) const
+{
+    const int r = m_partOffsets.at(m_geometryOffsets.at(geometry) + part) + ring;
+    const int start = m_ringOffsets.at(r);
+
+    CoordinateView view;
+    view.x = m_x.constData() + start;
+    view.y = m_y.constData() + start;
+    view.z = m_z.isEmpty() ? nullptr : m_z.constData() + start;
+    view.size = m_ringOffsets.at(r + 1) - start;
+    return view;
+}
+
+QGeoCircle QGeoJsonGeometryStore::toGeoCircle(int geometry, int part) const
+{
+    return storeToGeoCircle(*this, geometry, part);
+}
+
+QGeoPath QGeoJsonGeometryStore::toGeoPath(int geometry, int part) const
+{
+    return storeToGeoPath(*this, geometry, part);
+}
+
+QGeoPolygon QGeoJsonGeometryStore::toGeoPolygon(int geometry, int part) const
+{
+    return storeToGeoPolygon(*this, geometry, part);
+}
+
+/*!
+    Returns the content of the store in the QVariantMap layout of QGeoJson::importGeoJson().
+*/
+QVariantMap QGeoJsonGeometryStore::toVariantMap() const
+{
+    return storeToVariantMap(*this);
+}
+
+/*! \class QGeoJsonSnapshot
+    \inmodule Qt.labs.location
+    \ingroup json
+    \since WIP
+
+    \brief The QGeoJsonSnapshot class reads a QGeoJsonGeometryStore from a memory-mapped snapshot file.
+
+    QGeoJson::loadSnapshot() returns a QGeoJsonSnapshot for the file written by
+    QGeoJson::saveSnapshot(). It has the read interface of QGeoJsonGeometryStore, and points
+    into the mapped file: CoordinateView and the offset arrays are used where they lie,
+    "properties" and "id" are decoded from their JSON text on each call. toVariantMap()
+    returns the same map as the store that was saved, so exporting it with
+    QGeoJson::exportGeoJson() gives the same GeoJSON. toGeometryStore() copies the content
+    into a store that can be modified.
+
+    The header, the sizes of the arrays, the offsets, the geometry types and collections, and
+    the parts and rings of each geometry type are checked when the snapshot is opened, so
+    that reading it never goes past the mapped file. The coordinates and the "properties" and "id" text are only covered by
+    verifyChecksum(), which reads the whole file: call it before trusting the values of a
+    file that may have been corrupted.
+
+    Copies of a QGeoJsonSnapshot share the mapping, which is released with the last copy.
+*/
+
+QGeoJsonSnapshot::QGeoJsonSnapshot()
+    : m_base(nullptr), m_size(0),
+      m_x(nullptr), m_y(nullptr), m_z(nullptr),
+      m_ringOffsets(nullptr), m_partOffsets(nullptr), m_geometryOffsets(nullptr),
+      m_geometryTypes(nullptr), m_geometryChildren(nullptr),
+      m_featureGeometries(nullptr), m_featureJsonOffsets(nullptr), m_featureJson(nullptr),
+      m_vertexCount(0), m_geometryCount(0), m_featureCount(0),
+      m_documentType(QGeoJsonGeometryStore::GeometryDocument)
+{
+}
+
+bool QGeoJsonSnapshot::setData(const uchar *data, qint64 size, QString *errorString)
+{
+    QString error;
+    const GeoJsonSnapshotHeader *header = reinterpret_cast<const GeoJsonSnapshotHeader *>(data);
+    if (size < qint64(sizeof(GeoJsonSnapshotHeader)) || memcmp(header->magic, snapshotMagic, sizeof(snapshotMagic)))
+        error = QStringLiteral("Not a GeoJSON snapshot");
+    else if (header->version != snapshotVersion)
+        error = QStringLiteral("Unsupported snapshot version %1").arg(header->version);
+    else if (header->byteOrderMark != snapshotByteOrderMark)
+        error = QStringLiteral("Snapshot saved with another byte order");
+    else if (quintptr(data) % 8)
+        error = QStringLiteral("Snapshot data is not aligned");
+
+    if (error.isEmpty()) {
+        GeoJsonSnapshotHeader unchecked = *header;
+        unchecked.headerChecksum = 0;
+        if (snapshotChecksum(snapshotChecksumSeed, &unchecked, sizeof(unchecked)) != header->headerChecksum)
+            error = QStringLiteral("Corrupted snapshot header");
+        else if (header->fileSize > quint64(size))
+            error = QStringLiteral("Truncated snapshot");
+        else if (header->documentType > QGeoJsonGeometryStore::FeatureCollectionDocument)
+            error = QStringLiteral("Corrupted snapshot header");
+    }
+
+    static const quint64 elementSizes[SnapshotSectionCount] = {
+        sizeof(double), sizeof(double), sizeof(double), sizeof(int), sizeof(int), sizeof(int),
+        1, sizeof(int), sizeof(int), sizeof(int), 1, 1
+    };
+    quint64 counts[SnapshotSectionCount] = {};
+    for (int i = 0; error.isEmpty() && i < SnapshotSectionCount; ++i) {
+        const quint64 offset = header->sections[i].offset;
+        const quint64 bytes = header->sections[i].size;
+        if (offset % 8 || offset < sizeof(GeoJsonSnapshotHeader) || offset > header->fileSize
+                || bytes > header->fileSize - offset || bytes % elementSizes[i]
+                || bytes / elementSizes[i] >= quint64(std::numeric_limits<int>::max())) {
+            error = QStringLiteral("Corrupted snapshot header");
+        }
+        counts[i] = bytes / elementSizes[i];
+    }
+
+    // The arrays must have the sizes of a store
+    if (error.isEmpty()) {
+        const quint64 features = counts[SnapshotFeatureGeometries];
+        if (counts[SnapshotY] != counts[SnapshotX]
+                || (counts[SnapshotZ] && counts[SnapshotZ] != counts[SnapshotX])
+                || counts[SnapshotRingOffsets] < 1 || counts[SnapshotPartOffsets] < 1
+                || counts[SnapshotGeometryOffsets] != counts[SnapshotGeometryTypes] + 1
+                || counts[SnapshotGeometryChildren] != counts[SnapshotGeometryTypes]
+                || counts[SnapshotFeatureJsonOffsets] != (features ? 2 * features + 1 : 0)) {
+            error = QStringLiteral("Corrupted snapshot header");
+        }
+    }
+
+    // The readers index the arrays with the offsets and follow the collections without any
+    // check, so these are validated once here; the coordinates and the JSON text are not
+    // read, they are covered by verifyChecksum()
+    if (error.isEmpty()) {
+        const int *ringOffsets = reinterpret_cast<const int *>(data + header->sections[SnapshotRingOffsets].offset);
+        const int *partOffsets = reinterpret_cast<const int *>(data + header->sections[SnapshotPartOffsets].offset);
+        const int *geometryOffsets = reinterpret_cast<const int *>(data + header->sections[SnapshotGeometryOffsets].offset);
+        const uchar *geometryTypes = data + header->sections[SnapshotGeometryTypes].offset;
+        const int *geometryChildren = reinterpret_cast<const int *>(data + header->sections[SnapshotGeometryChildren].offset);
+        const int *featureGeometries = reinterpret_cast<const int *>(data + header->sections[SnapshotFeatureGeometries].offset);
+        const int *featureJsonOffsets = reinterpret_cast<const int *>(data + header->sections[SnapshotFeatureJsonOffsets].offset);
+        const int geometryCount = int(counts[SnapshotGeometryTypes]);
+        bool valid = isSnapshotOffsetArray(ringOffsets, counts[SnapshotRingOffsets], counts[SnapshotX])
+                && isSnapshotOffsetArray(partOffsets, counts[SnapshotPartOffsets], counts[SnapshotRingOffsets] - 1)
+                && isSnapshotOffsetArray(geometryOffsets, counts[SnapshotGeometryOffsets], counts[SnapshotPartOffsets] - 1)
+                && isSnapshotOffsetArray(featureJsonOffsets, counts[SnapshotFeatureJsonOffsets], counts[SnapshotFeatureJson])
+                && isSnapshotGeometryTree(geometryTypes, geometryChildren, geometryCount)
+                && isSnapshotGeometryParts(geometryTypes, geometryOffsets, partOffsets, ringOffsets, geometryCount);
+        for (quint64 i = 0; valid && i < counts[SnapshotFeatureGeometries]; ++i)
+            valid = featureGeometries[i] >= 0 && featureGeometries[i] < geometryCount;
+        if (!valid)
+            error = QStringLiteral("Corrupted snapshot data");
+    }
+
+    if (!error.isEmpty()) {
+        if (errorString)
+            *errorString = error;
+        return false;
+    }
+
+    m_base = data;
+    m_size = qint64(header->fileSize);
+    m_x = reinterpret_cast<const double *>(data + header->sections[SnapshotX].offset);
+    m_y = reinterpret_cast<const double *>(data + header->sections[SnapshotY].offset);
+    m_z = counts[SnapshotZ] ? reinterpret_cast<const double *>(data + header->sections[SnapshotZ].offset) : nullptr;
+    m_ringOffsets = reinterpret_cast<const int *>(data + header->sections[SnapshotRingOffsets].offset);
+    m_partOffsets = reinterpret_cast<const int *>(data + header->sections[SnapshotPartOffsets].offset);
+    m_geometryOffsets = reinterpret_cast<const int *>(data + header->sections[SnapshotGeometryOffsets].offset);
+    m_geometryTypes = data + header->sections[SnapshotGeometryTypes].offset;
+    m_geometryChildren = reinterpret_cast<const int *>(data + header->sections[SnapshotGeometryChildren].offset);
+    m_featureGeometries = reinterpret_cast<const int *>(data + header->sections[SnapshotFeatureGeometries].offset);
+    m_featureJsonOffsets = reinterpret_cast<const int *>(data + header->sections[SnapshotFeatureJsonOffsets].offset);
+    m_featureJson = reinterpret_cast<const char *>(data + header->sections[SnapshotFeatureJson].offset);
+    m_vertexCount = int(counts[SnapshotX]);
+    m_geometryCount = int(counts[SnapshotGeometryTypes]);
+    m_featureCount = int(counts[SnapshotFeatureGeometries]);
+    m_documentType = QGeoJsonGeometryStore::DocumentType(header->documentType);
+
+    const char *bbox = reinterpret_cast<const char *>(data + header->sections[SnapshotBoundingBox].offset);
+    if (counts[SnapshotBoundingBox]) {
+        GeoJsonTextParser parser(bbox, bbox + counts[SnapshotBoundingBox]);
+        m_bbox = parser.parseJsonValue();
+    }
+    return true;
+}
+
+/*!
+    Reads the whole snapshot and returns true if its content matches the checksum saved
+    with it.
+*/
+bool QGeoJsonSnapshot::verifyChecksum() const
+{
+    if (!m_base)
+        return false;
+    const GeoJsonSnapshotHeader *header = reinterpret_cast<const GeoJsonSnapshotHeader *>(m_base);
+    const qint64 headerSize = sizeof(GeoJsonSnapshotHeader);
+    return snapshotChecksum(snapshotChecksumSeed, m_base + headerSize, m_size - headerSize) == header->dataChecksum;
+}
+
+QGeoJsonGeometryStore::GeometryType QGeoJsonSnapshot::geometryType(int geometry) const
+{
+    Q_ASSERT(geometry >= 0 && geometry < m_geometryCount);
+    return QGeoJsonGeometryStore::GeometryType(m_geometryTypes[geometry]);
+}
+
+int QGeoJsonSnapshot::childCount(int geometry) const
+{
+    Q_ASSERT(geometry >= 0 && geometry < m_geometryCount);
+    return m_geometryChildren[geometry];
+}
+
+int QGeoJsonSnapshot::partCount(int geometry) const
+{
+    Q_ASSERT(geometry >= 0 && geometry < m_geometryCount);
+    return m_geometryOffsets[geometry + 1] - m_geometryOffsets[geometry];
+}
+
+int QGeoJsonSnapshot::ringCount(int geometry, int part) const
+{
+    const int p = m_geometryOffsets[geometry] + part;
+    return m_partOffsets[p + 1] - m_partOffsets[p];
+}
+
+QGeoJsonGeometryStore::CoordinateView QGeoJsonSnapshot::ring(int geometry, int part, int ring) const
+{
+    const int r = m_partOffsets[m_geometryOffsets[geometry] + part] + ring;
+    const int start = m_ringOffsets[r];
+
+    QGeoJsonGeometryStore::CoordinateView view;
+    view.x = m_x + start;
+    view.y = m_y + start;
+    view.z = m_z ? m_z + start : nullptr;
+    view.size = m_ringOffsets[r + 1] - start;
+    return view;
+}
+
+int QGeoJsonSnapshot::featureGeometry(int feature) const
+{
+    Q_ASSERT(feature >= 0 && feature < m_featureCount);
+    return m_featureGeometries[feature];
+}
+
+QVariant QGeoJsonSnapshot::featureProperties(int feature) const
+{
+    Q_ASSERT(feature >= 0 && feature < m_featureCount);
+    return featureJsonValue(2 * feature);
+}
+
+QVariant QGeoJsonSnapshot::featureId(int feature) const
+{
+    Q_ASSERT(feature >= 0 && feature < m_featureCount);
+    return featureJsonValue(2 * feature + 1);
+}
+
+QVariant QGeoJsonSnapshot::featureJsonValue(int slot) const
+{
+    const int begin = m_featureJsonOffsets[slot];
+    const int end = m_featureJsonOffsets[slot + 1];
+    if (begin == end)
+        return QVariant();
+    GeoJsonTextParser parser(m_featureJson + begin, m_featureJson + end);
+    return parser.parseJsonValue();
+}
+
+QGeoCircle QGeoJsonSnapshot::toGeoCircle(int geometry, int part) const
+{
+    return storeToGeoCircle(*this, geometry, part);
+}
+
+QGeoPath QGeoJsonSnapshot::toGeoPath(int geometry, int part) const
+{
+    return storeToGeoPath(*this, geometry, part);
+}
+
+QGeoPolygon QGeoJsonSnapshot::toGeoPolygon(int geometry, int part) const
+{
+    return storeToGeoPolygon(*this, geometry, part);
+}
+
+/*!
+    Returns the content of the snapshot in the QVariantMap layout of QGeoJson::importGeoJson(),
+    the same map as QGeoJsonGeometryStore::toVariantMap() returned for the store saved.
+*/
+QVariantMap QGeoJsonSnapshot::toVariantMap() const
+{
+    return storeToVariantMap(*this);
+}
+
+template <typename T>
+static QVector<T> snapshotVector(const T *data, int size)
+{
+    QVector<T> vector(size);
+    if (size)
+        memcpy(vector.data(), data, size_t(size) * sizeof(T));
+    return vector;
+}
+
+/*!
+    Copies the content of the snapshot into a new QGeoJsonGeometryStore, whose features keep
+    their "properties" and "id" members as JSON text.
+*/
+QGeoJsonGeometryStore QGeoJsonSnapshot::toGeometryStore() const
+{
+    QGeoJsonGeometryStore store;
+    if (!m_base)
+        return store;
+
+    const GeoJsonSnapshotHeader *header = reinterpret_cast<const GeoJsonSnapshotHeader *>(m_base);
+    const int ringOffsetCount = int(header->sections[SnapshotRingOffsets].size / sizeof(int));
+    const int partOffsetCount = int(header->sections[SnapshotPartOffsets].size / sizeof(int));
+    store.m_x = snapshotVector(m_x, m_vertexCount);
+    store.m_y = snapshotVector(m_y, m_vertexCount);
+    store.m_z = snapshotVector(m_z, m_z ? m_vertexCount : 0);
+    store.m_ringOffsets = snapshotVector(m_ringOffsets, ringOffsetCount);
+    store.m_partOffsets = snapshotVector(m_partOffsets, partOffsetCount);
+    store.m_geometryOffsets = snapshotVector(m_geometryOffsets, m_geometryCount + 1);
+    store.m_geometryTypes = snapshotVector(m_geometryTypes, m_geometryCount);
+    store.m_geometryChildren = snapshotVector(m_geometryChildren, m_geometryCount);
+    store.m_featureGeometries = snapshotVector(m_featureGeometries, m_featureCount);
+    if (m_featureCount) {
+        store.m_featureJsonOffsets = snapshotVector(m_featureJsonOffsets, 2 * m_featureCount + 1);
+        store.m_featureJson = QByteArray(m_featureJson, m_featureJsonOffsets[2 * m_featureCount]);
+    }
+    store.m_documentType = m_documentType;
+    store.m_bbox = m_bbox;
+    return store;
+}
+
+/*! \class QGeoJsonLazyDocument
+    \inmodule Qt.labs.location
+    \ingroup json
+    \since WIP
+
+    \brief The QGeoJsonLazyDocument class decodes the features of a GeoJSON text on demand.
+
+    QGeoJson::importLazy() returns a QGeoJsonLazyDocument holding the text and the byte ranges
+    of the "geometry", "properties" and "id" members of its features. featureProperties()
+    and featureId() decode their member on every call, featureGeometry() decodes the geometry
+    once, in the layout of the "geometry" value of importGeoJson(), and keeps it.
+
+    The geometry cache is filled by const functions: a document shared between threads must
+    be guarded by the caller.
+*/
+
+QGeoJsonLazyDocument::QGeoJsonLazyDocument()
+    : m_documentType(QGeoJsonGeometryStore::FeatureCollectionDocument)
+{
+}
+
+QVariant QGeoJsonLazyDocument::rangeValue(int range) const
+{
+    const int begin = m_ranges.at(2 * range);
+    const int end = m_ranges.at(2 * range + 1);
+    if (begin == end)
+        return QVariant();
+    GeoJsonTextParser parser(m_text.constData() + begin, m_text.constData() + end);
+    return parser.parseJsonValue();
+}
+
+QVariant QGeoJsonLazyDocument::featureProperties(int feature) const
+{
+    return rangeValue(3 * feature + 1);
+}
+
+QVariant QGeoJsonLazyDocument::featureId(int feature) const
+{
+    return rangeValue(3 * feature + 2);
+}
+
+QVariantMap QGeoJsonLazyDocument::featureGeometry(int feature) const
+{
+    QVariantMap &geometry = m_geometries[feature];
+    if (geometry.isEmpty()) { // a decoded geometry always has its type key
+        const int begin = m_ranges.at(6 * feature);
+        const int end = m_ranges.at(6 * feature + 1);
+        // a missing geometry is imported like an empty object
+        static const char emptyObject[] = "{}";
+        GeoJsonTextParser parser(begin == end ? emptyObject : m_text.constData() + begin,
+                                 begin == end ? emptyObject + 2 : m_text.constData() + end);
+        geometry = parser.parseGeometry();
+    }
+    return geometry;
+}
+
+/*!
+    Decodes \a feature, and returns it as a map with a single "Feature" key, like the elements
+    of the "FeatureCollection" list of QGeoJson::importGeoJson().
+*/
+QVariantMap QGeoJsonLazyDocument::feature(int feature) const
+{
+    QVariantMap parsedFeature;
+    parsedFeature.insert(QStringLiteral("geometry"), featureGeometry(feature));
+    parsedFeature.insert(QStringLiteral("properties"), featureProperties(feature));
+    const QVariant id = featureId(feature);
+    if (id != QVariant::Invalid)
+        parsedFeature.insert(QStringLiteral("id"), id);
+
+    QVariantMap importedMap;
+    importedMap.insert(QStringLiteral("Feature"), parsedFeature);
+    return importedMap;
+}
+
+/*!
+    Returns the offset in the text just past the last of the "geometry", "properties" and
+    "id" members of \a feature, or 0 when it has none of them.
+*/
+int QGeoJsonLazyDocument::featureTextEnd(int feature) const
+{
+    return qMax(m_ranges.at(6 * feature + 1), qMax(m_ranges.at(6 * feature + 3), m_ranges.at(6 * feature + 5)));
+}
+
+/*!
+    Decodes the whole document, and returns the same map as QGeoJson::importGeoJson() for
+    its text. The geometries already decoded are reused, and the others are cached.
+*/
+QVariantMap QGeoJsonLazyDocument::toVariantMap() const
+{
+    if (m_documentType == QGeoJsonGeometryStore::GeometryDocument) {
+        GeoJsonTextParser parser(m_text.constData(), m_text.constData() + m_text.size());
+        return parser.parseDocument();
+    }
+
+    QVariantList features;
+    features.reserve(featureCount());
+    for (int i = 0; i < featureCount(); ++i)
+        features.append(feature(i));
+
+    QVariantMap parsedGeoJsonMap;
+    if (m_documentType == QGeoJsonGeometryStore::FeatureDocument) {
+        if (!features.isEmpty())
+            parsedGeoJsonMap = features.first().toMap();
+    } else {
+        parsedGeoJsonMap.insert(QStringLiteral("FeatureCollection"), features);
+    }
+    if (m_bbox != QVariant::Invalid)
+        parsedGeoJsonMap.insert(QStringLiteral("bbox"), m_bbox);
+    return parsedGeoJsonMap;
+}
+
+// Asynchronous import
+
+class GeoJsonImportJob : public QRunnable
+{
+public:
+    explicit GeoJsonImportJob(const QByteArray &geojsonText)
+        : m_text(geojsonText)
+    {
+    }
+
+    QFuture<QVariantMap> start(QThreadPool *pool)
+    {
+        m_interface.setThreadPool(pool);
+        m_interface.reportStarted();
+        QFuture<QVariantMap> future = m_interface.future();
+        pool->start(this);
+        return future;
+    }
+
+    void run() override
+    {
+        if (!m_interface.isCanceled()) {
+            QVariantMap parsedGeoJsonMap;
+            if (importDocument(&parsedGeoJsonMap))
+                m_interface.reportResult(parsedGeoJsonMap);
+        }
+        m_interface.reportFinished();
+    }
+
+private:
+    static const int ProgressInterval = 64; // features between two progress reports
+
+    // The scan covers the first half of the progress range, the decoding of the features the second one
+    bool reportScanProgress(int bytes)
+    {
+        m_interface.setProgressValueAndText(int(bytes / 2), QStringLiteral("scanned %1 of %2 bytes")
+                                            .arg(bytes).arg(m_text.size()));
+        return !m_interface.isCanceled();
+    }
+
+    void reportProgress(int features, int featureCount, int bytes)
+    {
+        m_interface.setProgressValueAndText(int((qint64(m_text.size()) + bytes) / 2),
+                                            QStringLiteral("%1 of %2 features, %3 of %4 bytes")
+                                            .arg(features).arg(featureCount).arg(bytes).arg(m_text.size()));
+    }
+
+    bool importDocument(QVariantMap *parsedGeoJsonMap)
+    {
+        m_interface.setProgressRange(0, m_text.size());
+        QJsonParseError error;
+        const QGeoJsonLazyDocument document = QGeoJsonLazyDocument::scan(m_text, [this](int bytes) {
+            return reportScanProgress(bytes);
+        }, &error);
+        if (m_interface.isCanceled())
+            return false;
+        if (error.error != QJsonParseError::NoError) {
+            // not an empty document: the error goes in the progress text, with no result
+            m_interface.setProgressValueAndText(m_text.size(), QStringLiteral("parse error at offset %1: %2")
+                                                .arg(error.offset).arg(error.errorString()));
+            return false;
+        }
+        const int featureCount = document.featureCount();
+        if (document.documentType() != QGeoJsonGeometryStore::FeatureCollectionDocument) {
+            *parsedGeoJsonMap = document.toVariantMap();
+            reportProgress(featureCount, featureCount, m_text.size());
+            return true;
+        }
+
+        QVariantList features;
+        features.reserve(featureCount);
+        int bytes = 0;
+        for (int i = 0; i < featureCount; ++i) {
+            if (m_interface.isCanceled())
+                return false; // the features imported so far go with the document
+            features.append(document.feature(i));
+            bytes = qMax(bytes, document.featureTextEnd(i));
+            if ((i + 1) % ProgressInterval == 0)
+                reportProgress(i + 1, featureCount, bytes);
+        }
+        reportProgress(featureCount, featureCount, m_text.size());
+
+        parsedGeoJsonMap->insert(QStringLiteral("FeatureCollection"), features);
+        if (document.boundingBox() != QVariant::Invalid)
+            parsedGeoJsonMap->insert(QStringLiteral("bbox"), document.boundingBox());
+        return true;
+    }
+
+    const QByteArray m_text;
+    QFutureInterface<QVariantMap> m_interface;
+};
+
+/*!
+    Starts importing the UTF-8 encoded \a geojsonText on \a pool, or on
+    QThreadPool::globalInstance() when \a pool is null, and returns a QFuture for the result.
+
+    The text is first scanned for the members of its features without decoding them, then
+    the features are decoded one after the other with the parser of
+    importGeoJson(const QByteArray &), so the result is the same as the one of that call.
+    The progress range of the future is the size of the text in bytes: its first half
+    follows the scan, reported every megabyte, and its second half the decoding, reported
+    every 64 features, each in proportion to the bytes of the text covered. The progress
+    text gives the bytes scanned, then the features and bytes imported so far.
+
+    Canceling the future stops the import at the next progress report of the scan, or
+    before the next feature: the features already decoded are released and the future
+    finishes without a result.
+
+    When the text is not valid JSON the future also finishes without a result, but is not
+    canceled: its progress value is the end of the range and its progress text is
+    "parse error at offset", followed by the offset and QJsonParseError::errorString() of
+    the error found by the scan.
+*/
+QFuture<QVariantMap> QGeoJson::importGeoJsonAsync(const QByteArray &geojsonText, QThreadPool *pool)
+{
+    GeoJsonImportJob *job = new GeoJsonImportJob(geojsonText);
+    return job->start(pool ? pool : QThreadPool::globalInstance());
+}
+
+/*! \class QGeoJsonObject
+    \inmodule Qt.labs.location
+    \ingroup json
+    \since WIP
+
+    \brief The QGeoJsonObject class is a typed representation of a GeoJSON object.
+
+    A QGeoJsonObject holds the same content as the QVariantMap layout of the importer, with
+    its type as an enum. Point, LineString and Polygon objects hold a single QGeoCircle,
+    QGeoPath or QGeoPolygon in shapes(); MultiPoint, MultiLineString and MultiPolygon objects
+    hold one such shape per member. The members of a GeometryCollection and the features of a
+    FeatureCollection are in children(), and a Feature keeps its geometry as its only child.
+
+    toVariantMap() and fromVariantMap() convert to and from the QVariantMap layout, so that
+    code that needs it can still be fed.
+*/
+
+QGeoJsonObject::QGeoJsonObject()
+    : m_type(Null)
+{
+}
+
+QGeoJsonObject::QGeoJsonObject(Type type)
+    : m_type(type)
+{
+}
+
+QGeoCircle QGeoJsonObject::point(int i) const
+{
+    return QGeoCircle(m_shapes.value(i));
+}
+
+QGeoPath QGeoJsonObject::lineString(int i) const
+{
+    return QGeoPath(m_shapes.value(i));
+}
+
+QGeoPolygon QGeoJsonObject::polygon(int i) const
+{
+    return QGeoPolygon(m_shapes.value(i));
+}
+
+/*!
+    Returns the geometry of a Feature, a Null object when there is none.
+*/
+QGeoJsonObject QGeoJsonObject::geometry() const
+{
+    return m_type == Feature && !m_children.isEmpty() ? m_children.first() : QGeoJsonObject();
+}
+
+void QGeoJsonObject::setGeometry(const QGeoJsonObject &geometry)
+{
+    m_children.resize(1);
+    m_children.first() = geometry;
+}
+
+/*!
+    Returns the object in the QVariantMap layout returned by QGeoJson::importGeoJson().
+*/
+QVariantMap QGeoJsonObject::toVariantMap() const
+{
+    QVariantMap parsedGeoJsonMap;
+    if (m_type == Null)
+        return parsedGeoJsonMap;
+
+    const QString keyMap = QString::fromLatin1(geoJsonTypeNames[m_type]);
+    QVariantList list;
+    switch (m_type) {
+    case Point:
+        parsedGeoJsonMap.insert(keyMap, QVariant::fromValue(point()));
+        break;
+    case LineString:
+        parsedGeoJsonMap.insert(keyMap, QVariant::fromValue(lineString()));
+        break;
+    case Polygon:
+        parsedGeoJsonMap.insert(keyMap, QVariant::fromValue(polygon()));
+        break;
+    case MultiPoint:
+        for (int i = 0; i < m_shapes.size(); ++i)
+            list.append(QVariant::fromValue(point(i)));
+        parsedGeoJsonMap.insert(keyMap, list);
+        break;
+    case MultiLineString:
+        for (int i = 0; i < m_shapes.size(); ++i)
+            list.append(QVariant::fromValue(lineString(i)));
+        parsedGeoJsonMap.insert(keyMap, list);
+        break;
+    case MultiPolygon:
+        for (int i = 0; i < m_shapes.size(); ++i)
+            list.append(QVariant::fromValue(polygon(i)));
+        parsedGeoJsonMap.insert(keyMap, list);
+        break;
+    case GeometryCollection:
+    case FeatureCollection:
+        for (const QGeoJsonObject &child: m_children)
+            list.append(child.toVariantMap());
+        parsedGeoJsonMap.insert(keyMap, list);
+        break;
+    case Feature:
+        parsedGeoJsonMap.insert(keyMap, featureMap());
+        break;
+    case Null:
+        break;
+    }
+
+    if (m_bbox != QVariant::Invalid)
+        parsedGeoJsonMap.insert(QStringLiteral("bbox"), m_bbox);
+    return parsedGeoJsonMap;
+}
+
+/*!
+    Returns the object held by \a geojsonMap, in the QVariantMap layout returned by
+    QGeoJson::importGeoJson(). A map without any GeoJSON type key gives a Null object.
+*/
+QGeoJsonObject QGeoJsonObject::fromVariantMap(const QVariantMap &geojsonMap)
+{
+    int i = Point;
+    for (; i < Null; ++i) {
+        if (geojsonMap.contains(QString::fromLatin1(geoJsonTypeNames[i])))
+            break;
+    }
+
+    QGeoJsonObject parsedObject(static_cast<Type>(i));
+    if (i == Null)
+        return parsedObject;
+
+    const QVariant value = geojsonMap.value(QString::fromLatin1(geoJsonTypeNames[i]));
+    switch (i) {
+    case Point:
+        parsedObject.appendShape(value.value<QGeoCircle>());
+        break;
+    case LineString:
+        parsedObject.appendShape(value.value<QGeoPath>());
+        break;
+    case Polygon:
+        parsedObject.appendShape(value.value<QGeoPolygon>());
+        break;
+    case MultiPoint:
+        for (const QVariant &member: value.value<QVariantList>())
+            parsedObject.appendShape(member.value<QGeoCircle>());
+        break;
+    case MultiLineString:
+        for (const QVariant &member: value.value<QVariantList>())
+            parsedObject.appendShape(member.value<QGeoPath>());
+        break;
+    case MultiPolygon:
+        for (const QVariant &member: value.value<QVariantList>())
+            parsedObject.appendShape(member.value<QGeoPolygon>());
+        break;
+    case GeometryCollection:
+    case FeatureCollection:
+        for (const QVariant &member: value.value<QVariantList>())
+            parsedObject.append(fromVariantMap(member.value<QVariantMap>()));
+        break;
+    case Feature:
+        parsedObject = fromFeatureMap(value.value<QVariantMap>());
+        break;
+    }
+
+    const QVariant bboxValue = geojsonMap.value(QStringLiteral("bbox"));
+    if (bboxValue != QVariant::Invalid)
+        parsedObject.setBoundingBox(bboxValue);
+    return parsedObject;
+}
+
+QVariantMap QGeoJsonObject::featureMap() const
+{
+    QVariantMap parsedFeature;
+    parsedFeature.insert(QStringLiteral("geometry"), geometry().toVariantMap());
+    parsedFeature.insert(QStringLiteral("properties"), m_properties);
+    if (m_id != QVariant::Invalid)
+        parsedFeature.insert(QStringLiteral("id"), m_id);
+    return parsedFeature;
+}
+
+QGeoJsonObject QGeoJsonObject::fromFeatureMap(const QVariantMap &featureMap)
+{
+    QGeoJsonObject parsedFeature(Feature);
+    parsedFeature.setGeometry(fromVariantMap(featureMap.value(QStringLiteral("geometry")).value<QVariantMap>()));
+    parsedFeature.setProperties(featureMap.value(QStringLiteral("properties")));
+    parsedFeature.setId(featureMap.value(QStringLiteral("id")));
+    return parsedFeature;
+}
+
+/*! \class QGeoJsonReader
+    \inmodule Qt.labs.location
+    \ingroup json
+    \since WIP
+
+    \brief The QGeoJsonReader class imports the features of a GeoJSON FeatureCollection incrementally.
+
+    QGeoJsonReader scans a FeatureCollection document read from a QIODevice, or handed over in
+    chunks with addData(), and imports every element of its "features" array as soon as the
+    element has been completely received. The text preceding an element is discarded, so the
+    memory in use is bounded by the size of the largest single feature rather than by the size
+    of the document.
+
+    Each feature is parsed with the same code as QGeoJson::importGeoJson(const QByteArray &), and
+    feature() returns a QVariantMap identical to the corresponding element of the
+    "FeatureCollection" list produced by the importer: a map with a single "Feature" key.
+
+    Features can be pulled one at a time with readNextFeature(), or pushed to a handler with
+    readFeatures(). When the data available is exhausted before the end of the document,
+    error() is set to PrematureEndOfDocumentError; reading can resume after more data has
+    been added or has arrived on the device.
+
+    The structure of the top level object and of the "features" array is checked as it is
+    scanned, and the members of the top level object other than "features" are parsed and
+    skipped. A text which is not well formed JSON sets error() to NotWellFormedError, as
+    does a document whose "type" is not "FeatureCollection": as soon as a "features" array
+    is reached when the type is already known, at the end of the document otherwise.
+*/
+
+static const qint64 ReadChunkSize = 64 * 1024;
+
+QGeoJsonReader::QGeoJsonReader()
+    : m_device(nullptr)
+{
+    clear();
+}
+
+QGeoJsonReader::QGeoJsonReader(QIODevice *device)
+    : m_device(nullptr)
+{
+    setDevice(device);
+}
+
+QGeoJsonReader::QGeoJsonReader(const QByteArray &data)
+    : m_device(nullptr)
+{
+    clear();
+    addData(data);
+}
+
+QGeoJsonReader::~QGeoJsonReader()
+{
+}
+
+/*!
+    Sets the current device to \a device and resets the reader. The device must be open
+    for reading.
+*/
+void QGeoJsonReader::setDevice(QIODevice *device)
+{
+    clear();
+    m_device = device;
+}
+
+QIODevice *QGeoJsonReader::device() const
+{
+    return m_device;
+}
+
+/*!
+    Appends \a data to the text being read. Use this instead of a device when the document
+    arrives in chunks, e.g. from a network reply.
+*/
+void QGeoJsonReader::addData(const QByteArray &data)
+{
+    compactBuffer();
+    m_buffer.append(data);
+}
+
+/*!
+    Removes any device or data from the reader and resets its internal state.
+*/
+void QGeoJsonReader::clear()
+{
+    m_device = nullptr;
+    m_buffer.clear();
+    m_pos = 0;
+    m_discarded = 0;
+    m_state = DocumentStart;
+    m_currentKey.clear();
+    m_type = QString();
+    m_valueStart = -1;
+    m_stack.clear();
+    m_inString = false;
+    m_escape = false;
+    m_finished = false;
+    m_feature.clear();
+    m_error = NoError;
+    m_errorString.clear();
+}
+
+/*!
+    Reads the next element of the "features" array and imports it. Returns true if a
+    feature is available through feature(), false at the end of the document, on error, or
+    when more data is needed.
+*/
+bool QGeoJsonReader::readNextFeature()
+{
+    if (m_error == PrematureEndOfDocumentError) {
+        m_error = NoError;
+        m_errorString.clear();
+    }
+    if (m_error != NoError)
+        return false;
+
+    int start = -1;
+    int length = 0;
+    while (!scanFeature(&start, &length)) {
+        if (m_error != NoError || m_finished)
+            return false;
+        if (!fetchData()) {
+            raiseError(PrematureEndOfDocumentError, QStringLiteral("Premature end of document"));
+            return false;
+        }
+    }
+
+    // Elements which are not objects are checked and imported as the importer does
+    GeoJsonTextParser parser(m_buffer.constData() + start, m_buffer.constData() + start + length);
+    const QVariantMap featMap = parser.parseFeature();
+    if (parser.error() != QJsonParseError::NoError) {
+        QJsonParseError parseError;
+        parseError.error = parser.error();
+        parseError.offset = parser.errorOffset();
+        raiseError(NotWellFormedError, parseError.errorString());
+        return false;
+    }
+
+    m_feature.clear();
+    m_feature.insert(QStringLiteral("Feature"), featMap);
+    return true;
+}
+
+/*!
+    Returns the feature imported by the last successful call to readNextFeature().
+*/
+QVariantMap QGeoJsonReader::feature() const
+{
+    return m_feature;
+}
+
+/*!
+    Imports every remaining feature and passes it to \a handler, until the end of the
+    document or until \a handler returns false. Returns false if an error occurred.
+*/
+bool QGeoJsonReader::readFeatures(const std::function<bool(const QVariantMap &)> &handler)
+{
+    while (readNextFeature()) {
+        if (!handler(m_feature))
+            return true;
+    }
+    return m_error == NoError;
+}
+
+bool QGeoJsonReader::atEnd() const
+{
+    return m_finished || (m_error != NoError && m_error != PrematureEndOfDocumentError);
+}
+
+QGeoJsonReader::Error QGeoJsonReader::error() const
+{
+    return m_error;
+}
+
+QString QGeoJsonReader::errorString() const
+{
+    return m_errorString;
+}
+
+/*!
+    Returns the offset in bytes of the reader position from the start of the document.
+*/
+qint64 QGeoJsonReader::characterOffset() const
+{
+    return m_discarded + m_pos;
+}
+
+static inline bool isReaderWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Numbers and literals end at the first other character
+static inline bool isReaderScalarCharacter(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+            || c == '-' || c == '+' || c == '.';
+}
+
+static inline bool isReaderValueStart(char c)
+{
+    return c == '"' || c == '{' || c == '[' || c == '-' || (c >= '0' && c <= '9')
+            || c == 't' || c == 'f' || c == 'n';
+}
+
+/*
+    Walks the top level object and the "features" array, and returns the next element of
+    the array. The member names, the other member values and the elements are delimited by
+    scanValue(), then parsed; only the separators between them are checked here.
+*/
+bool QGeoJsonReader::scanFeature(int *start, int *length)
+{
+    while (m_pos < m_buffer.size()) {
+        if (m_valueStart >= 0) {
+            if (!scanValue())
+                return false;
+            const int valueStart = m_valueStart;
+            m_valueStart = -1;
+            QVariant value;
+            switch (m_state) {
+            case FirstMemberKey:
+            case MemberKey:
+                if (!parseMemberText(valueStart, &value))
+                    return false;
+                m_currentKey = value.toString();
+                m_state = MemberColon;
+                break;
+            case MemberValue:
+                if (!parseMemberText(valueStart, &value))
+                    return false;
+                if (m_currentKey == QLatin1String("type"))
+                    m_type = value.type() == QVariant::String ? value.toString() : QString();
+                m_state = MemberEnd;
+                break;
+            default: // an element, parsed by readNextFeature()
+                *start = valueStart;
+                *length = m_pos - valueStart;
+                m_state = ElementEnd;
+                return true;
+            }
+            continue;
+        }
+
+        const char c = m_buffer.at(m_pos);
+        if (isReaderWhitespace(c)) {
+            ++m_pos;
+            continue;
+        }
+
+        switch (m_state) {
+        case DocumentStart:
+            if (c != '{') {
+                raiseError(NotWellFormedError, QStringLiteral("The document is not a JSON object"));
+                return false;
+            }
+            m_state = FirstMemberKey;
+            break;
+        case FirstMemberKey:
+        case MemberKey:
+            if (c == '}' && m_state == FirstMemberKey) {
+                ++m_pos;
+                if (!finishDocument())
+                    return false;
+                continue;
+            }
+            if (c != '"') {
+                raiseError(NotWellFormedError, QStringLiteral("Expected a member name"));
+                return false;
+            }
+            m_valueStart = m_pos;
+            continue;
+        case MemberColon:
+            if (c != ':') {
+                raiseError(NotWellFormedError, QStringLiteral("Expected ':' after a member name"));
+                return false;
+            }
+            m_state = MemberValue;
+            break;
+        case MemberValue:
+            if (c == '[' && m_currentKey == QLatin1String("features")) {
+                if (!m_type.isNull() && m_type != QLatin1String("FeatureCollection")) {
+                    raiseError(NotWellFormedError, QStringLiteral("The document is not a FeatureCollection"));
+                    return false;
+                }
+                m_state = FirstElement;
+                break;
+            }
+            if (!isReaderValueStart(c)) {
+                raiseError(NotWellFormedError, QStringLiteral("Expected a value"));
+                return false;
+            }
+            m_valueStart = m_pos;
+            continue;
+        case MemberEnd:
+            if (c == '}') {
+                ++m_pos;
+                if (!finishDocument())
+                    return false;
+                continue;
+            }
+            if (c != ',') {
+                raiseError(NotWellFormedError, QStringLiteral("Expected ',' or '}' after a member"));
+                return false;
+            }
+            m_state = MemberKey;
+            break;
+        case FirstElement:
+        case Element:
+            if (c == ']' && m_state == FirstElement) {
+                m_state = MemberEnd;
+                break;
+            }
+            if (!isReaderValueStart(c)) {
+                raiseError(NotWellFormedError, QStringLiteral("Expected a feature"));
+                return false;
+            }
+            m_valueStart = m_pos;
+            continue;
+        case ElementEnd:
+            if (c == ']') {
+                m_state = MemberEnd;
+            } else if (c == ',') {
+                m_state = Element;
+            } else {
+                raiseError(NotWellFormedError, QStringLiteral("Expected ',' or ']' after a feature"));
+                return false;
+            }
+            break;
+        case DocumentEnd:
+            raiseError(NotWellFormedError, QStringLiteral("Garbage at the end of the document"));
+            return false;
+        }
+        ++m_pos;
+    }
+    return false;
+}
+
+// Moves past the end of the value starting at m_valueStart, returns false if it is not complete
+bool QGeoJsonReader::scanValue()
+{
+    const char *data = m_buffer.constData();
+    const int size = m_buffer.size();
+    for (; m_pos < size; ++m_pos) {
+        const char c = data[m_pos];
+        if (m_inString) {
+            if (m_escape) {
+                m_escape = false;
+            } else if (c == '\\') {
+                m_escape = true;
+            } else if (c == '"') {
+                m_inString = false;
+                if (m_stack.isEmpty()) {
+                    ++m_pos;
+                    return true;
+                }
+            }
+            continue;
+        }
+        if (m_stack.isEmpty() && m_pos > m_valueStart) {
+            // past the first character of a number or literal
+            if (!isReaderScalarCharacter(c))
+                return true;
+            continue;
+        }
+
+        switch (c) {
+        case '"':
+            m_inString = true;
+            break;
+        case '{':
+        case '[':
+            m_stack.append(c);
+            break;
+        case '}':
+        case ']':
+            if (m_stack.isEmpty() || m_stack.at(m_stack.size() - 1) != (c == '}' ? '{' : '[')) {
+                raiseError(NotWellFormedError, QStringLiteral("Unbalanced brackets"));
+                return false;
+            }
+            m_stack.chop(1);
+            if (m_stack.isEmpty()) {
+                ++m_pos;
+                return true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return false;
+}
+
+// Parses a member name or value of the top level object, from start to the reader position
+bool QGeoJsonReader::parseMemberText(int start, QVariant *value)
+{
+    GeoJsonTextParser parser(m_buffer.constData() + start, m_buffer.constData() + m_pos);
+    *value = parser.parseJsonValue();
+    QJsonParseError parseError;
+    parseError.error = parser.error();
+    parseError.offset = parser.errorOffset();
+    if (parseError.error == QJsonParseError::NoError && !parser.atEnd()) {
+        parseError.error = QJsonParseError::GarbageAtEnd;
+        parseError.offset = m_pos - start;
+    }
+    if (parseError.error != QJsonParseError::NoError) {
+        raiseError(NotWellFormedError, parseError.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool QGeoJsonReader::finishDocument()
+{
+    m_state = DocumentEnd;
+    if (m_type != QLatin1String("FeatureCollection")) {
+        raiseError(NotWellFormedError, QStringLiteral("The document is not a FeatureCollection"));
+        return false;
+    }
+    m_finished = true;
+    return true;
+}
+
+void QGeoJsonReader::compactBuffer()
+{
+    // Drop the text already scanned, except for a partially received value
+    const int keep = m_valueStart >= 0 ? m_valueStart : m_pos;
+    if (keep > 0) {
+        m_buffer.remove(0, keep);
+        m_discarded += keep;
+        m_pos -= keep;
+        if (m_valueStart >= 0)
+            m_valueStart -= keep;
+    }
+}
+
+bool QGeoJsonReader::fetchData()
+{
+    compactBuffer();
+    if (!m_device)
+        return false;
+    const QByteArray chunk = m_device->read(ReadChunkSize);
+    if (chunk.isEmpty())
+        return false;
+    m_buffer.append(chunk);
+    return true;
+}
+
+void QGeoJsonReader::raiseError(Error error, const QString &message)
+{
+    m_error = error;
+    m_errorString = message;
+}
+
+/*! \class QGeoJsonWriter
+    \inmodule Qt.labs.location
+    \ingroup json
+    \since WIP
+
+    \brief The QGeoJsonWriter class exports a GeoJSON collection to a QIODevice incrementally.
+
+    QGeoJsonWriter writes a FeatureCollection, or a GeometryCollection, one member at a time:
+    call beginFeatureCollection(), then writeFeature() for every feature, then end(). Each
+    member is exported with the same functions as QGeoJson::exportGeoJson(), serialized and
+    written to the device straight away, so the memory in use does not depend on the size
+    of the collection.
+
+    writeFeature() accepts the maps found in the "FeatureCollection" list of the importer, with
+    a single "Feature" key, and writeGeometry() the geometry maps of a "GeometryCollection".
+    The text written is the same as QGeoJson::exportGeoJsonText() returns for the whole
+    collection.
+*/
+
+QGeoJsonWriter::QGeoJsonWriter()
+    : m_device(nullptr), m_collection(NoCollection), m_count(0), m_precision(-1), m_hasError(false)
+{
+}
+
+QGeoJsonWriter::QGeoJsonWriter(QIODevice *device)
+    : m_device(device), m_collection(NoCollection), m_count(0), m_precision(-1), m_hasError(false)
+{
+}
+
+QGeoJsonWriter::~QGeoJsonWriter()
+{
+}
+
+/*!
+    Sets the current device to \a device, which must be open for writing, and resets the
+    writer state.
+*/
+void QGeoJsonWriter::setDevice(QIODevice *device)
+{
+    m_device = device;
+    m_collection = NoCollection;
+    m_count = 0;
+    m_hasError = false;
+    m_errorString.clear();
+}
+
+QIODevice *QGeoJsonWriter::device() const
+{
+    return m_device;
+}
+
+/*!
+    Sets the number of decimal places written for the coordinates to \a precision, as
+    QGeoJson::ExportOptions::coordinatePrecision does. The default of -1 writes the shortest
+    text that reads back to the same double.
+*/
+void QGeoJsonWriter::setCoordinatePrecision(int precision)
+{
+    m_precision = precision;
+}
+
+int QGeoJsonWriter::coordinatePrecision() const
+{
+    return m_precision;
+}
+
+bool QGeoJsonWriter::beginFeatureCollection()
+{
+    return begin(FeatureCollection, "{\"features\":[");
+}
+
+/*!
+    Exports \a feature and writes it as the next member of the FeatureCollection.
+*/
+bool QGeoJsonWriter::writeFeature(const QVariantMap &feature)
+{
+    return writeMember(FeatureCollection, exportFeatureText(feature, m_precision));
+}
+
+bool QGeoJsonWriter::beginGeometryCollection()
+{
+    return begin(GeometryCollection, "{\"geometries\":[");
+}
+
+/*!
+    Exports \a geometry and writes it as the next member of the GeometryCollection.
+*/
+bool QGeoJsonWriter::writeGeometry(const QVariantMap &geometry)
+{
+    if (m_precision < 0)
+        return writeMember(GeometryCollection, QJsonDocument(exportGeometry(geometry)).toJson(QJsonDocument::Compact));
+    QByteArray text;
+    appendGeometryText(&text, geometry, m_precision);
+    return writeMember(GeometryCollection, text);
+}
+
+/*!
+    Closes the collection started by beginFeatureCollection() or beginGeometryCollection().
+*/
+bool QGeoJsonWriter::end()
+{
+    const Collection collection = m_collection;
+    m_collection = NoCollection;
+    m_count = 0;
+    switch (collection) {
+    case FeatureCollection:
+        return write("],\"type\":\"FeatureCollection\"}");
+    case GeometryCollection:
+        return write("],\"type\":\"GeometryCollection\"}");
+    case NoCollection:
+        break;
+    }
+    m_hasError = true;
+    m_errorString = QStringLiteral("No collection to end");
+    return false;
+}
+
+bool QGeoJsonWriter::hasError() const
+{
+    return m_hasError;
+}
+
+QString QGeoJsonWriter::errorString() const
+{
+    return m_errorString;
+}
+
+bool QGeoJsonWriter::begin(Collection collection, const char *text)
+{
+    if (m_collection != NoCollection) {
+        m_hasError = true;
+        m_errorString = QStringLiteral("A collection is already being written");
+        return false;
+    }
+    m_collection = collection;
+    m_count = 0;
+    return write(text);
+}
+
+bool QGeoJsonWriter::writeMember(Collection collection, const QByteArray &text)
+{
+    if (m_collection != collection) {
+        m_hasError = true;
+        m_errorString = QStringLiteral("Member written outside of its collection");
+        return false;
+    }
+    if (m_count++ && !write(","))
+        return false;
+    return write(text);
+}
+
+bool QGeoJsonWriter::write(const QByteArray &text)
+{
+    if (m_hasError)
+        return false;
+    if (!m_device || m_device->write(text) != text.size()) {
+        m_hasError = true;
+        m_errorString = m_device ? m_device->errorString() : QStringLiteral("No device");
+        return false;
+    }
+    return true;
+}
+
+// GeoJSON text sequences, one record per line or per RFC 8142 record separator
+
+static const char RecordSeparator = '\x1e';
+
+static inline bool isSeqWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == RecordSeparator;
+}
+
+class SeqRecordImportTask : public QRunnable
+{
+public:
+    SeqRecordImportTask(const char *data, const int *ranges, int begin, int end, QVariantMap *results, bool *valid)
+        : m_data(data), m_ranges(ranges), m_begin(begin), m_end(end), m_results(results), m_valid(valid)
+    {
+    }
+
+    void run() override
+    {
+        for (int i = m_begin; i < m_end; ++i) {
+            GeoJsonTextParser parser(m_data + m_ranges[2 * i], m_data + m_ranges[2 * i + 1]);
+            m_results[i] = parser.parseDocument();
+            m_valid[i] = parser.error() == QJsonParseError::NoError;
+        }
+    }
+
+private:
+    const char *const m_data;
+    const int *const m_ranges;
+    const int m_begin;
+    const int m_end;
+    QVariantMap *m_results;
+    bool *m_valid;
+};
+
+/*! \class QGeoJsonSeqReader
+    \inmodule Qt.labs.location
+    \ingroup json
+    \since WIP
+
+    \brief The QGeoJsonSeqReader class imports GeoJSON text sequences incrementally.
+
+    QGeoJsonSeqReader reads a sequence of GeoJSON texts, usually one Feature each, from a
+    QIODevice or from chunks handed over with addData(). Both framings are recognized from
+    the first record: newline-delimited texts, and RFC 8142 sequences where every text is
+    introduced by the record separator 0x1E and may then span several lines. In the latter
+    case a record is complete when the next separator arrives, or at the end of the input.
+
+    Complete records are gathered in batches of batchSize() and imported together, on
+    threadCount() worker threads when it is not 1, with the same parser as
+    QGeoJson::importGeoJson(const QByteArray &). The records are then delivered in their
+    original order: feature() returns the importGeoJson() map of a record, which for a Feature
+    has a single "Feature" key like the elements of an imported "FeatureCollection" list.
+    The text of a batch is discarded once imported, so the memory in use is bounded by the
+    batch size rather than by the length of the sequence.
+
+    As RFC 8142 recommends, a record which cannot be parsed is skipped; invalidRecordCount()
+    tells how many were. This includes the last record of a device at its end, even without
+    a separator after it. When the data available ends inside a record which does not parse
+    and more data may follow, error() is set to PrematureEndOfDocumentError and reading can
+    resume after more data has been added or has arrived on the device.
+*/
+
+QGeoJsonSeqReader::QGeoJsonSeqReader()
+    : m_device(nullptr), m_threadCount(1), m_batchSize(256), m_pool(nullptr)
+{
+    clear();
+}
+
+QGeoJsonSeqReader::QGeoJsonSeqReader(QIODevice *device)
+    : m_device(nullptr), m_threadCount(1), m_batchSize(256), m_pool(nullptr)
+{
+    setDevice(device);
+}
+
+QGeoJsonSeqReader::QGeoJsonSeqReader(const QByteArray &data)
+    : m_device(nullptr), m_threadCount(1), m_batchSize(256), m_pool(nullptr)
+{
+    clear();
+    addData(data);
+}
+
+QGeoJsonSeqReader::~QGeoJsonSeqReader()
+{
+    delete m_pool;
+}
+
+/*!
+    Sets the current device to \a device and resets the reader. The device must be open
+    for reading.
+*/
+void QGeoJsonSeqReader::setDevice(QIODevice *device)
+{
+    clear();
+    m_device = device;
+}
+
+QIODevice *QGeoJsonSeqReader::device() const
+{
+    return m_device;
+}
+
+/*!
+    Appends \a data to the text being read.
+*/
+void QGeoJsonSeqReader::addData(const QByteArray &data)
+{
+    compactBuffer();
+    m_buffer.append(data);
+}
+
+/*!
+    Removes any device or data from the reader and resets its internal state. The thread
+    count and batch size are kept.
+*/
+void QGeoJsonSeqReader::clear()
+{
+    m_device = nullptr;
+    m_buffer.clear();
+    m_pos = 0;
+    m_scanPos = 0;
+    m_discarded = 0;
+    m_framing = UnknownFraming;
+    m_batch.clear();
+    m_batchPos = 0;
+    m_feature.clear();
+    m_invalidCount = 0;
+    m_error = NoError;
+    m_errorString.clear();
+}
+
+/*!
+    Sets the number of threads importing the records of a batch to \a threadCount, 0 meaning
+    QThread::idealThreadCount(). The default is 1, importing on the calling thread.
+*/
+void QGeoJsonSeqReader::setThreadCount(int threadCount)
+{
+    m_threadCount = threadCount;
+}
+
+int QGeoJsonSeqReader::threadCount() const
+{
+    return m_threadCount;
+}
+
+/*!
+    Sets the number of records gathered before they are imported to \a recordCount. The
+    default is 256.
+*/
+void QGeoJsonSeqReader::setBatchSize(int recordCount)
+{
+    m_batchSize = qMax(1, recordCount);
+}
+
+int QGeoJsonSeqReader::batchSize() const
+{
+    return m_batchSize;
+}
+
+/*!
+    Makes the next record available through feature(). Returns false at the end of the
+    sequence, or when more data is needed.
+*/
+bool QGeoJsonSeqReader::readNextFeature()
+{
+    if (m_error == PrematureEndOfDocumentError) {
+        m_error = NoError;
+        m_errorString.clear();
+    }
+    while (m_batchPos >= m_batch.size()) {
+        if (!readBatch())
+            return false;
+    }
+    m_feature = m_batch.at(m_batchPos);
+    m_batch[m_batchPos++].clear();
+    return true;
+}
+
+/*!
+    Returns the map imported from the record read by the last successful call to
+    readNextFeature().
+*/
+QVariantMap QGeoJsonSeqReader::feature() const
+{
+    return m_feature;
+}
+
+/*!
+    Imports every remaining record and passes it to \a handler, until the end of the
+    sequence or until \a handler returns false. Returns false if an error occurred.
+*/
+bool QGeoJsonSeqReader::readFeatures(const std::function<bool(const QVariantMap &)> &handler)
+{
+    while (readNextFeature()) {
+        if (!handler(m_feature))
+            return true;
+    }
+    return m_error == NoError;
+}
+
+/*!
+    Returns true when every record has been read and no more data is expected from the
+    device. Without a device, more data may always be added.
+*/
+bool QGeoJsonSeqReader::atEnd() const
+{
+    if (m_batchPos < m_batch.size() || !m_device || !m_device->atEnd())
+        return false;
+    for (int i = m_pos; i < m_buffer.size(); ++i) {
+        if (!isSeqWhitespace(m_buffer.at(i)))
+            return false;
+    }
+    return true;
+}
+
+QGeoJsonSeqReader::Error QGeoJsonSeqReader::error() const
+{
+    return m_error;
+}
+
+QString QGeoJsonSeqReader::errorString() const
+{
+    return m_errorString;
+}
+
+/*!
+    Returns the offset in bytes from the start of the sequence of the text not read yet.
+*/
+qint64 QGeoJsonSeqReader::characterOffset() const
+{
+    return m_discarded + m_pos;
+}
+
+/*!
+    Returns the number of records skipped because they could not be parsed.
+*/
+int QGeoJsonSeqReader::invalidRecordCount() const
+{
+    return m_invalidCount;
+}
+
+bool QGeoJsonSeqReader::readBatch()
+{
+    m_batch.clear();
+    m_batchPos = 0;
+    compactBuffer();
+
+    // offsets into m_buffer, which is only appended to until the batch is imported
+    QVector<int> ranges;
+    int start;
+    int end;
+    while (ranges.size() < 2 * m_batchSize) {
+        if (scanRecord(&start, &end)) {
+            ranges << start << end;
+        } else if (!fetchData()) {
+            break;
+        }
+    }
+
+    if (ranges.isEmpty()) {
+        // the input is exhausted: the text left is the last record when it parses on its own
+        start = m_pos;
+        end = m_buffer.size();
+        while (start < end && isSeqWhitespace(m_buffer.at(start)))
+            ++start;
+        if (start == end)
+            return false;
+        GeoJsonTextParser parser(m_buffer.constData() + start, m_buffer.constData() + end);
+        const QVariantMap parsedGeoJsonMap = parser.parseDocument();
+        if (m_buffer.at(start) != '{' || parser.error() != QJsonParseError::NoError) {
+            if (m_device && m_device->atEnd()) {
+                // no more data can complete it: skipped like an invalid record in the middle
+                m_pos = end;
+                ++m_invalidCount;
+                return false;
+            }
+            m_error = PrematureEndOfDocumentError;
+            m_errorString = QStringLiteral("Premature end of document");
+            return false;
+        }
+        m_pos = end;
+        m_batch.append(parsedGeoJsonMap);
+        return true;
+    }
+
+    importRecords(ranges);
+    return true;
+}
+
+bool QGeoJsonSeqReader::scanRecord(int *start, int *end)
+{
+    const int size = m_buffer.size();
+    if (m_framing == UnknownFraming) {
+        int i = m_pos;
+        while (i < size && (m_buffer.at(i) == ' ' || m_buffer.at(i) == '\t'
+                            || m_buffer.at(i) == '\n' || m_buffer.at(i) == '\r'))
+            ++i;
+        if (i == size)
+            return false;
+        m_framing = m_buffer.at(i) == RecordSeparator ? RecordSeparatorFraming : LineFraming;
+    }
+    const char separator = m_framing == RecordSeparatorFraming ? RecordSeparator : '\n';
+
+    for (;;) {
+        // the text before m_scanPos has no separator, it is not searched again after a refill
+        const int next = m_buffer.indexOf(separator, qMax(m_pos, m_scanPos));
+        if (next < 0) {
+            m_scanPos = size;
+            return false;
+        }
+        int first = m_pos;
+        int last = next;
+        m_pos = next + 1;
+        while (first < last && isSeqWhitespace(m_buffer.at(first)))
+            ++first;
+        while (last > first && isSeqWhitespace(m_buffer.at(last - 1)))
+            --last;
+        if (first < last) { // empty records are not counted
+            *start = first;
+            *end = last;
+            return true;
+        }
+    }
+}
+
+void QGeoJsonSeqReader::importRecords(const QVector<int> &ranges)
+{
+    const int recordCount = ranges.size() / 2;
+    QVector<QVariantMap> results(recordCount);
+    QVector<bool> valid(recordCount);
+    bool *validData = valid.data();
+    const int threadCount = qMin(m_threadCount > 0 ? m_threadCount : QThread::idealThreadCount(), recordCount);
+
+    if (threadCount <= 1) {
+        SeqRecordImportTask(m_buffer.constData(), ranges.constData(), 0, recordCount, results.data(), validData).run();
+    } else {
+        if (!m_pool)
+            m_pool = new QThreadPool;
+        m_pool->setMaxThreadCount(threadCount);
+        for (int i = 0; i < threadCount; ++i) {
+            const int begin = int(qint64(recordCount) * i / threadCount);
+            const int end = int(qint64(recordCount) * (i + 1) / threadCount);
+            m_pool->start(new SeqRecordImportTask(m_buffer.constData(), ranges.constData(), begin, end,
+                                                  results.data(), validData));
+        }
+        m_pool->waitForDone();
+    }
+
+    m_batch.reserve(recordCount);
+    for (int i = 0; i < recordCount; ++i) {
+        if (validData[i])
+            m_batch.append(results.at(i));
+        else
+            ++m_invalidCount;
+    }
+}
+
+void QGeoJsonSeqReader::compactBuffer()
+{
+    if (m_pos > 0) {
+        m_buffer.remove(0, m_pos);
+        m_discarded += m_pos;
+        m_scanPos = qMax(m_scanPos - m_pos, 0);
+        m_pos = 0;
+    }
+}
+
+bool QGeoJsonSeqReader::fetchData()
+{
+    if (!m_device)
+        return false;
+    const QByteArray chunk = m_device->read(ReadChunkSize);
+    if (chunk.isEmpty())
+        return false;
+    m_buffer.append(chunk);
+    return true;
+}
+
+/*! \class QGeoJsonSeqWriter
+    \inmodule Qt.labs.location
+    \ingroup json
+    \since WIP
+
+    \brief The QGeoJsonSeqWriter class writes GeoJSON text sequences.
+
+    Every call to writeFeature() exports one feature with the same functions as
+    QGeoJson::exportGeoJson() and writes it to the device on a line of its own, without an
+    enclosing collection. With setRecordSeparator() the lines are also introduced by the
+    record separator 0x1E, as RFC 8142 specifies; otherwise the output is newline-delimited
+    GeoJSON. Both are read back by QGeoJsonSeqReader.
+*/
+
+QGeoJsonSeqWriter::QGeoJsonSeqWriter()
+    : m_device(nullptr), m_precision(-1), m_recordSeparator(false), m_hasError(false)
+{
+}
+
+QGeoJsonSeqWriter::QGeoJsonSeqWriter(QIODevice *device)
+    : m_device(device), m_precision(-1), m_recordSeparator(false), m_hasError(false)
+{
+}
+
+QGeoJsonSeqWriter::~QGeoJsonSeqWriter()
+{
+}
+
+/*!
+    Sets the current device to \a device, which must be open for writing, and clears the
+    error state.
+*/
+void QGeoJsonSeqWriter::setDevice(QIODevice *device)
+{
+    m_device = device;
+    m_hasError = false;
+    m_errorString.clear();
+}
+
+QIODevice *QGeoJsonSeqWriter::device() const
+{
+    return m_device;
+}
+
+/*!
+    Sets the number of decimal places written for the coordinates to \a precision, as
+    QGeoJson::ExportOptions::coordinatePrecision does.
+*/
+void QGeoJsonSeqWriter::setCoordinatePrecision(int precision)
+{
+    m_precision = precision;
+}
+
+int QGeoJsonSeqWriter::coordinatePrecision() const
+{
+    return m_precision;
+}
+
+/*!
+    Introduces every record with the 0x1E record separator of RFC 8142 when \a enabled is true.
+*/
+void QGeoJsonSeqWriter::setRecordSeparator(bool enabled)
+{
+    m_recordSeparator = enabled;
+}
+
+bool QGeoJsonSeqWriter::recordSeparator() const
+{
+    return m_recordSeparator;
+}
+
+/*!
+    Exports \a feature, a map with a single "Feature" key as found in the "FeatureCollection"
+    list of the importer, and writes it as the next record.
+*/
+bool QGeoJsonSeqWriter::writeFeature(const QVariantMap &feature)
+{
+    if (m_hasError)
+        return false;
+    QByteArray text;
+    if (m_recordSeparator)
+        text.append(RecordSeparator);
+    text.append(exportFeatureText(feature, m_precision));
+    text.append('\n');
+    if (!m_device || m_device->write(text) != text.size()) {
+        m_hasError = true;
+        m_errorString = m_device ? m_device->errorString() : QStringLiteral("No device");
+        return false;
+    }
+    return true;
+}
+
+bool QGeoJsonSeqWriter::hasError() const
+{
+    return m_hasError;
+}
+
+QString QGeoJsonSeqWriter::errorString() const
+{
+    return m_errorString;
+}
+
+// Incremental export of FeatureCollections
+
+static const quint64 fragmentHashSeed = Q_UINT64_C(14695981039346656037);
+
+static inline quint64 fragmentHash(quint64 hash, quint64 word)
+{
+    hash = (hash ^ word) * Q_UINT64_C(1099511628211);
+    return hash ^ (hash >> 29);
+}
+
+static quint64 fragmentHash(quint64 hash, double value)
+{
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return fragmentHash(hash, bits);
+}
+
+static quint64 fragmentHash(quint64 hash, const QString &string)
+{
+    hash = fragmentHash(hash, quint64(string.size()));
+    const ushort *units = string.utf16();
+    for (int i = 0; i < string.size(); ++i)
+        hash = fragmentHash(hash, quint64(units[i]));
+    return hash;
+}
+
+static quint64 fragmentHash(quint64 hash, const QList<QGeoCoordinate> &path)
+{
+    hash = fragmentHash(hash, quint64(path.size()));
+    for (const QGeoCoordinate &coordinate: path) {
+        hash = fragmentHash(hash, coordinate.latitude());
+        hash = fragmentHash(hash, coordinate.longitude());
+        hash = fragmentHash(hash, coordinate.altitude());
+    }
+    return hash;
+}
+
+// Hash of what exportFeature() reads from a value of the importGeoJson() layout
+static quint64 fragmentHash(quint64 hash, const QVariant &value)
+{
+    const int type = value.userType();
+    hash = fragmentHash(hash, quint64(type));
+    if (type == QMetaType::QVariantMap) {
+        const QVariantMap map = value.toMap();
+        for (QVariantMap::const_iterator iter = map.constBegin(); iter != map.constEnd(); ++iter) {
+            hash = fragmentHash(hash, iter.key());
+            hash = fragmentHash(hash, iter.value());
+        }
+    } else if (type == QMetaType::QVariantList) {
+        const QVariantList list = value.toList();
+        hash = fragmentHash(hash, quint64(list.size()));
+        for (const QVariant &element: list)
+            hash = fragmentHash(hash, element);
+    } else if (type == qMetaTypeId<QGeoCircle>()) {
+        const QGeoCoordinate center = value.value<QGeoCircle>().center();
+        hash = fragmentHash(hash, QList<QGeoCoordinate>() << center);
+    } else if (type == qMetaTypeId<QGeoPath>()) {
+        hash = fragmentHash(hash, value.value<QGeoPath>().path());
+    } else if (type == qMetaTypeId<QGeoPolygon>()) {
+        const QGeoPolygon polygon = value.value<QGeoPolygon>();
+        hash = fragmentHash(hash, polygon.path());
+        for (int i = 0; i < polygon.holesCount(); ++i)
+            hash = fragmentHash(hash, polygon.holePath(i));
+    } else if (type == QMetaType::Double || type == QMetaType::Float) {
+        hash = fragmentHash(hash, value.toDouble());
+    } else if (value.isValid()) {
+        hash = fragmentHash(hash, value.toString());
+    }
+    return hash;
+}
+
+/*! \class QGeoJsonIncrementalExporter
+    \inmodule Qt.labs.location
+    \ingroup json
+    \since WIP
+
+    \brief The QGeoJsonIncrementalExporter class re-exports a changing FeatureCollection, serializing only the features that changed.
+
+    exportGeoJsonText() returns the same text as QGeoJson::exportGeoJsonText(). For a
+    FeatureCollection, the serialized text of every feature with an "id" is kept, keyed by that
+    id and stamped with a hash of the feature. On the next call a feature whose stamp has not
+    changed is copied from the cache as bytes; only new and modified features, and those
+    without an id, go through the exporter again. The features that are no longer in the
+    collection are dropped from the cache.
+
+    By default the stamp hashes the whole feature, geometry included, which is cheap next to
+    exporting it. When the features carry a version, or modification time, in their
+    properties, setVersionProperty() makes the stamp hash that property only: then the cost
+    of an export is proportional to the number of features whose version changed.
+*/
+
+QGeoJsonIncrementalExporter::QGeoJsonIncrementalExporter()
+    : m_precision(-1), m_reusedCount(0)
+{
+}
+
+/*!
+    Sets the number of decimal places of the coordinates, as
+    QGeoJson::ExportOptions::coordinatePrecision does, and clears the cache.
+*/
+void QGeoJsonIncrementalExporter::setCoordinatePrecision(int precision)
+{
+    if (precision != m_precision)
+        clear();
+    m_precision = precision;
+}
+
+/*!
+    Stamps the features with the value of their \a name property only, or with their whole
+    content when \a name is empty. Clears the cache.
+*/
+void QGeoJsonIncrementalExporter::setVersionProperty(const QString &name)
+{
+    if (name != m_versionProperty)
+        clear();
+    m_versionProperty = name;
+}
+
+void QGeoJsonIncrementalExporter::clear()
+{
+    m_fragments.clear();
+    m_reusedCount = 0;
+}
+
+/*!
+    Exports \a geojsonMap and returns its compact UTF-8 serialization. Maps that do not hold a
+    FeatureCollection are exported by QGeoJson::exportGeoJsonText() without caching.
+*/
+QByteArray QGeoJsonIncrementalExporter::exportGeoJsonText(const QVariantMap &geojsonMap)
+{
+    m_reusedCount = 0;
+    if (!geojsonMap.contains(QStringLiteral("FeatureCollection"))) {
+        QGeoJson::ExportOptions options;
+        options.coordinatePrecision = m_precision;
+        return QGeoJson::exportGeoJsonText(geojsonMap, options);
+    }
+
+    const QString keyFeature = QStringLiteral("Feature");
+    const QString keyId = QStringLiteral("id");
+    const QString keyProperties = QStringLiteral("properties");
+    const QVariantList features = geojsonMap.value(QStringLiteral("FeatureCollection")).value<QVariantList>();
+    QHash<QByteArray, Fragment> fragments;
+    fragments.reserve(features.size());
+
+    QByteArray text("{\"features\":[");
+    for (int i = 0; i < features.size(); ++i) {
+        if (i)
+            text.append(',');
+        const QVariantMap feature = features.at(i).value<QVariantMap>();
+        const QVariantMap featureMap = feature.value(keyFeature).value<QVariantMap>();
+        const QVariant id = featureMap.value(keyId);
+        if (id == QVariant::Invalid) {
+            text.append(exportFeatureText(feature, m_precision));
+            continue;
+        }
+
+        QByteArray key;
+        appendJsonVariantText(&key, id);
+        Fragment fragment;
+        if (m_versionProperty.isEmpty())
+            fragment.stamp = fragmentHash(fragmentHashSeed, QVariant(featureMap));
+        else
+            fragment.stamp = fragmentHash(fragmentHashSeed, featureMap.value(keyProperties).toMap().value(m_versionProperty));
+
+        const QHash<QByteArray, Fragment>::const_iterator cached = m_fragments.constFind(key);
+        if (cached != m_fragments.constEnd() && cached->stamp == fragment.stamp) {
+            fragment.text = cached->text;
+            ++m_reusedCount;
+        } else {
+            fragment.text = exportFeatureText(feature, m_precision);
+        }
+        text.append(fragment.text);
+        fragments.insert(key, fragment);
+    }
+    text.append("],\"type\":\"FeatureCollection\"}");
+
+    m_fragments.swap(fragments);
+    return text;
+}
+
+// Spatial index
+
+static void extendGeometryExtent(GeoJsonExtent *extent, const QVariantMap &geometryMap)
+{
+    QVariantMap::const_iterator iter;
+    for (iter = geometryMap.begin(); iter != geometryMap.end(); ++iter) {
+        const QString &key = iter.key();
+        if (key == QStringLiteral("Point")) {
+            extent->add(iter.value().value<QGeoCircle>().center());
+        } else if (key == QStringLiteral("LineString")) {
+            extent->add(iter.value().value<QGeoPath>().path());
+        } else if (key == QStringLiteral("Polygon")) {
+            extent->add(iter.value().value<QGeoPolygon>().path()); // holes lie inside the perimeter
+        } else if (key == QStringLiteral("MultiPoint")) {
+            for (const QVariant &point: iter.value().value<QVariantList>())
+                extent->add(point.value<QGeoCircle>().center());
+        } else if (key == QStringLiteral("MultiLineString")) {
+            for (const QVariant &path: iter.value().value<QVariantList>())
+                extent->add(path.value<QGeoPath>().path());
+        } else if (key == QStringLiteral("MultiPolygon")) {
+            for (const QVariant &polygon: iter.value().value<QVariantList>())
+                extent->add(polygon.value<QGeoPolygon>().path());
+        } else if (key == QStringLiteral("GeometryCollection")) {
+            for (const QVariant &geometry: iter.value().value<QVariantList>())
+                extendGeometryExtent(extent, geometry.value<QVariantMap>());
+        }
+    }
+}
+
+static int storeGeometryEnd(const QGeoJsonGeometryStore &store, int geometry)
+{
+    const int childCount = store.childCount(geometry);
+    int next = geometry + 1;
+    for (int i = 0; i < childCount; ++i)
+        next = storeGeometryEnd(store, next);
+    return next;
+}
+
+/*! \class QGeoJsonSpatialIndex
+    \inmodule Qt.labs.location
+    \ingroup json
+    \since WIP
+
+    \brief The QGeoJsonSpatialIndex class answers rectangle and nearest-neighbor queries on
+    the features of a GeoJSON document.
+
+    The index is a packed R-tree, bulk-loaded with the Sort-Tile-Recursive algorithm: every
+    item is reduced to its bounding box, the boxes are sorted into tiles of up to 16 entries
+    and the tiles are grouped the same way, level after level, up to a single root. The tree
+    is stored in one contiguous array and cannot be modified once built; call build() again,
+    or clear(), addItem() and finish(), to index a new set of items.
+
+    Queries return item indices, which for build() are the positions of the features in the
+    "FeatureCollection" list of the importer, or in the store. Features without coordinates
+    are not indexed. The index compares the positions as plane coordinates.
+
+    The bounding boxes are those of the QGeoCoordinate values of the imported geometries,
+    whose latitude() holds the first member of a GeoJSON position, the longitude: addItem()
+    and intersects(double, double, double, double) take the boxes in that layout. The
+    QGeoRectangle and QGeoCoordinate arguments of intersects() and nearest() are geographic
+    instead, their longitudes compared with the first position members as
+    QGeoJson::ImportOptions::filter does, so that longitudes past 90 degrees can be queried.
+*/
+
+QGeoJsonSpatialIndex::QGeoJsonSpatialIndex()
+    : m_itemCount(0)
+{
+}
+
+/*!
+    Indexes the geometries of \a geojsonMap, as returned by QGeoJson::importGeoJson(). Each
+    feature of a FeatureCollection is one item; a single Feature or geometry is item 0.
+*/
+void QGeoJsonSpatialIndex::build(const QVariantMap &geojsonMap)
+{
+    clear();
+    QVariantList features;
+    if (geojsonMap.contains(QStringLiteral("FeatureCollection"))) {
+        features = geojsonMap.value(QStringLiteral("FeatureCollection")).value<QVariantList>();
+    } else if (geojsonMap.contains(QStringLiteral("Feature"))) {
+        features.append(geojsonMap);
+    } else {
+        GeoJsonExtent extent;
+        extendGeometryExtent(&extent, geojsonMap);
+        if (!extent.isEmpty())
+            addItem(0, extent.minLatitude, extent.minLongitude, extent.maxLatitude, extent.maxLongitude);
+    }
+
+    m_nodes.reserve(features.size());
+    for (int i = 0; i < features.size(); ++i) {
+        const QVariantMap feature = features.at(i).value<QVariantMap>().value(QStringLiteral("Feature")).value<QVariantMap>();
+        GeoJsonExtent extent;
+        extendGeometryExtent(&extent, feature.value(QStringLiteral("geometry")).value<QVariantMap>());
+        if (!extent.isEmpty())
+            addItem(i, extent.minLatitude, extent.minLongitude, extent.maxLatitude, extent.maxLongitude);
+    }
+    finish();
+}
+
+/*!
+    Indexes the features of \a store, or its single geometry when the store holds no
+    features, reading the coordinate columns directly.
+*/
+void QGeoJsonSpatialIndex::build(const QGeoJsonGeometryStore &store)
+{
+    clear();
+    const QVector<double> &x = store.x();
+    const QVector<double> &y = store.y();
+    const QVector<int> &ringOffsets = store.ringOffsets();
+    const QVector<int> &partOffsets = store.partOffsets();
+    const QVector<int> &geometryOffsets = store.geometryOffsets();
+
+    const int itemCount = store.featureCount() > 0 ? store.featureCount() : qMin(store.geometryCount(), 1);
+    m_nodes.reserve(itemCount);
+    for (int i = 0; i < itemCount; ++i) {
+        const int geometry = store.featureCount() > 0 ? store.featureGeometry(i) : 0;
+        if (geometry < 0 || geometry >= store.geometryCount())
+            continue;
+        const int begin = ringOffsets.at(partOffsets.at(geometryOffsets.at(geometry)));
+        const int end = ringOffsets.at(partOffsets.at(geometryOffsets.at(storeGeometryEnd(store, geometry))));
+        GeoJsonExtent extent;
+        for (int v = begin; v < end; ++v)
+            extent.add(x.at(v), y.at(v));
+        if (!extent.isEmpty())
+            addItem(i, extent.minLatitude, extent.minLongitude, extent.maxLatitude, extent.maxLongitude);
+    }
+    finish();
+}
+
+void QGeoJsonSpatialIndex::clear()
+{
+    m_nodes.clear();
+    m_itemCount = 0;
+}
+
+/*!
+    Adds \a item with the given bounding box to the index being built. The index can be
+    queried once finish() has been called.
+*/
+void QGeoJsonSpatialIndex::addItem(int item, double minLatitude, double minLongitude, double maxLatitude, double maxLongitude)
+{
+    Q_ASSERT(m_nodes.size() == m_itemCount);
+    Node node = { minLatitude, minLongitude, maxLatitude, maxLongitude, item, 0 };
+    m_nodes.append(node);
+    ++m_itemCount;
+}
+
+/*!
+    Bulk-loads the tree on the items added since the last clear().
+*/
+void QGeoJsonSpatialIndex::finish()
+{
+    m_nodes.resize(m_itemCount);
+    int levelBegin = 0;
+    int levelEnd = m_nodes.size();
+    while (levelEnd - levelBegin > 1) {
+        // Sort-Tile-Recursive: vertical slices by latitude, then tiles by longitude inside each slice
+        Node *first = m_nodes.data() + levelBegin;
+        Node *last = m_nodes.data() + levelEnd;
+        const int count = levelEnd - levelBegin;
+        const int tileCount = (count + NodeSize - 1) / NodeSize;
+        const int sliceCount = qCeil(qSqrt(double(tileCount)));
+        const int sliceSize = NodeSize * ((tileCount + sliceCount - 1) / sliceCount);
+
+        std::sort(first, last, [](const Node &a, const Node &b) {
+            return a.minLatitude + a.maxLatitude < b.minLatitude + b.maxLatitude;
+        });
+        for (Node *slice = first; slice < last; slice += sliceSize) {
+            std::sort(slice, qMin(slice + sliceSize, last), [](const Node &a, const Node &b) {
+                return a.minLongitude + a.maxLongitude < b.minLongitude + b.maxLongitude;
+            });
+        }
+
+        // Tiles do not cross slice boundaries, the last tile of a slice may be partial
+        for (int slice = levelBegin; slice < levelEnd; slice += sliceSize) {
+            const int sliceEnd = qMin(slice + sliceSize, levelEnd);
+            for (int tile = slice; tile < sliceEnd; tile += NodeSize) {
+                const int tileEnd = qMin(tile + NodeSize, sliceEnd);
+                Node parent = m_nodes.at(tile);
+                parent.index = tile;
+                parent.childCount = tileEnd - tile;
+                for (int i = tile + 1; i < tileEnd; ++i) {
+                    const Node &child = m_nodes.at(i);
+                    parent.minLatitude = qMin(parent.minLatitude, child.minLatitude);
+                    parent.minLongitude = qMin(parent.minLongitude, child.minLongitude);
+                    parent.maxLatitude = qMax(parent.maxLatitude, child.maxLatitude);
+                    parent.maxLongitude = qMax(parent.maxLongitude, child.maxLongitude);
+                }
+                m_nodes.append(parent);
+            }
+        }
+        levelBegin = levelEnd;
+        levelEnd = m_nodes.size();
+    }
+    m_nodes.squeeze();
+}
+
+/*!
+    Returns the items whose bounding box intersects \a rectangle, whose longitudes are
+    compared with the first position members. A rectangle crossing the antimeridian is
+    queried as its two halves.
+*/
+QVector<int> QGeoJsonSpatialIndex::intersects(const QGeoRectangle &rectangle) const
+{
+    if (!rectangle.isValid())
+        return QVector<int>();
+    const double west = rectangle.topLeft().longitude();
+    const double east = rectangle.bottomRight().longitude();
+    const double south = rectangle.bottomRight().latitude();
+    const double north = rectangle.topLeft().latitude();
+    if (west <= east)
+        return intersects(west, south, east, north);
+
+    // an item spanning the whole width is found by both halves
+    QVector<int> result = intersects(west, south, 180, north);
+    result += intersects(-180, south, east, north);
+    std::sort(result.begin(), result.end());
+    result.resize(int(std::unique(result.begin(), result.end()) - result.begin()));
+    return result;
+}
+
+/*!
+    Returns the items whose bounding box intersects the box from \a minLatitude,
+    \a minLongitude to \a maxLatitude, \a maxLongitude, given in the layout of the imported
+    QGeoCoordinate values: the latitudes bound the first position members.
+*/
+
+QVector<int> QGeoJsonSpatialIndex::intersects(double minLatitude, double minLongitude, double maxLatitude, double maxLongitude) const
+{
+    QVector<int> result;
+    if (m_nodes.isEmpty())
+        return result;
+
+    QVector<int> stack;
+    stack.append(m_nodes.size() - 1);
+    while (!stack.isEmpty()) {
+        const Node &node = m_nodes.at(stack.takeLast());
+        if (node.maxLatitude < minLatitude || node.minLatitude > maxLatitude
+                || node.maxLongitude < minLongitude || node.minLongitude > maxLongitude)
+            continue;
+        if (node.childCount == 0) {
+            result.append(node.index);
+            continue;
+        }
+        for (int i = node.index; i < node.index + node.childCount; ++i)
+            stack.append(i);
+    }
+    return result;
+}
+
+/*!
+    Returns up to \a count items, the nearest to \a coordinate first. The longitude of
+    \a coordinate is compared with the first position members. The distance is the plane
+    distance from \a coordinate to the bounding box of each item, the shorter way around
+    the antimeridian.
+*/
+QVector<int> QGeoJsonSpatialIndex::nearest(const QGeoCoordinate &coordinate, int count) const
+{
+    QVector<int> result;
+    if (m_nodes.isEmpty() || count <= 0)
+        return result;
+
+    // in the layout of the nodes, the first position member in the latitude fields
+    const double x = coordinate.longitude();
+    const double y = coordinate.latitude();
+    auto boxDistance = [x, y](const Node &node) {
+        double dx = qInf();
+        for (double shift: { 0.0, -360.0, 360.0 })
+            dx = qMin(dx, qMax(qMax(node.minLatitude - (x + shift), (x + shift) - node.maxLatitude), 0.0));
+        const double dy = qMax(qMax(node.minLongitude - y, y - node.maxLongitude), 0.0);
+        return dx * dx + dy * dy;
+    };
+
+    // Best-first search, a queued node without children is an item
+    typedef QPair<double, int> QueueEntry;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+    queue.push(QueueEntry(boxDistance(m_nodes.last()), m_nodes.size() - 1));
+    while (!queue.empty() && result.size() < count) {
+        const Node &node = m_nodes.at(queue.top().second);
+        queue.pop();
+        if (node.childCount == 0) {
+            result.append(node.index);
+            continue;
+        }
+        for (int i = node.index; i < node.index + node.childCount; ++i)
+            queue.push(QueueEntry(boxDistance(m_nodes.at(i)), i));
+    }
+    return result;
+}
+
+// Tile index
+
+// Web Mercator projection of the positions, the first member of a GeoJSON position being the
+// longitude; the importer keeps it in QGeoCoordinate::latitude()
+static inline double tileProjectX(double longitude)
+{
+    return longitude / 360.0 + 0.5;
+}
+
+static inline double tileProjectY(double latitude)
+{
+    const double sine = qSin(qDegreesToRadians(latitude));
+    const double y = 0.5 - 0.25 * qLn((1 + sine) / (1 - sine)) / M_PI;
+    return qBound(0.0, y, 1.0);
+}
+
+static inline QGeoCoordinate tileUnproject(double x, double y)
+{
+    QGeoCoordinate coordinate;
+    coordinate.setLatitude((x - 0.5) * 360.0);
+    coordinate.setLongitude(qRadiansToDegrees(2 * qAtan(qExp(M_PI * (1 - 2 * y)))) - 90.0);
+    return coordinate;
+}
+
+static inline quint64 tileKey(int z, int x, int y)
+{
+    return (quint64(z) << 48) | (quint64(x) << 24) | quint64(y);
+}
+
+static void appendTilePositions(QVector<double> *ring, const QList<QGeoCoordinate> &path)
+{
+    ring->reserve(ring->size() + path.size() * 3);
+    for (const QGeoCoordinate &coordinate: path) {
+        ring->append(tileProjectX(coordinate.latitude()));
+        ring->append(tileProjectY(coordinate.longitude()));
+        ring->append(0);
+    }
+}
+
+// Douglas-Peucker run down to the tolerance of the deepest zoom level, storing for each kept
+// position the squared distance it was kept at, so that every zoom level can select its own
+// positions without simplifying again; the endpoints are always kept
+static void markTileImportance(QVector<double> *ring, double sqTolerance)
+{
+    const int count = ring->size() / 3;
+    if (count == 0)
+        return;
+    double *p = ring->data();
+    p[2] = 1;
+    p[(count - 1) * 3 + 2] = 1;
+
+    QVector<QPair<int, int>> ranges;
+    ranges.append(qMakePair(0, count - 1));
+    while (!ranges.isEmpty()) {
+        const QPair<int, int> range = ranges.takeLast();
+        const double *a = p + range.first * 3;
+        const double *b = p + range.second * 3;
+        double maxDistance = sqTolerance;
+        int farthest = -1;
+        for (int i = range.first + 1; i < range.second; ++i) {
+            const double distance = segmentDistanceSquared(p[i * 3], p[i * 3 + 1], a[0], a[1], b[0], b[1]);
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                farthest = i;
+            }
+        }
+        if (farthest < 0)
+            continue;
+        p[farthest * 3 + 2] = maxDistance;
+        ranges.append(qMakePair(range.first, farthest));
+        ranges.append(qMakePair(farthest, range.second));
+    }
+}
+
+static inline void appendTileIntersection(QVector<double> *slice, double ax, double ay, double bx, double by,
+                                          double k, int axis)
+{
+    // intersections are kept at every zoom level, like endpoints
+    if (axis == 0) {
+        slice->append(k);
+        slice->append(ay + (by - ay) * (k - ax) / (bx - ax));
+    } else {
+        slice->append(ax + (bx - ax) * (k - ay) / (by - ay));
+        slice->append(k);
+    }
+    slice->append(1);
+}
+
+// Clips a line or ring to k1 <= coordinate <= k2 along axis. A line may leave several slices,
+// a ring leaves at most one, closed again when clipping opened it.
+static void clipTileLine(const QVector<double> &ring, QVector<QVector<double>> *slices, double k1, double k2,
+                         int axis, bool isPolygon)
+{
+    const int count = ring.size() / 3;
+    if (count == 0)
+        return;
+    const double *p = ring.constData();
+    QVector<double> slice;
+    for (int i = 0; i < count - 1; ++i) {
+        const double ax = p[i * 3];
+        const double ay = p[i * 3 + 1];
+        const double bx = p[i * 3 + 3];
+        const double by = p[i * 3 + 4];
+        const double a = axis == 0 ? ax : ay;
+        const double b = axis == 0 ? bx : by;
+        bool exited = false;
+
+        if (a < k1) {
+            if (b > k1) // enters from below k1
+                appendTileIntersection(&slice, ax, ay, bx, by, k1, axis);
+        } else if (a > k2) {
+            if (b < k2) // enters from above k2
+                appendTileIntersection(&slice, ax, ay, bx, by, k2, axis);
+        } else {
+            slice.append(ax);
+            slice.append(ay);
+            slice.append(p[i * 3 + 2]);
+        }
+        if (b < k1 && a >= k1) {
+            appendTileIntersection(&slice, ax, ay, bx, by, k1, axis);
+            exited = true;
+        }
+        if (b > k2 && a <= k2) {
+            appendTileIntersection(&slice, ax, ay, bx, by, k2, axis);
+            exited = true;
+        }
+        if (!isPolygon && exited) {
+            slices->append(slice);
+            slice.clear();
+        }
+    }
+
+    const double *last = p + (count - 1) * 3;
+    const double a = axis == 0 ? last[0] : last[1];
+    if (a >= k1 && a <= k2) {
+        slice.append(last[0]);
+        slice.append(last[1]);
+        slice.append(last[2]);
+    }
+    const int end = slice.size() - 3;
+    if (isPolygon && end >= 3 && (slice.at(end) != slice.at(0) || slice.at(end + 1) != slice.at(1))) {
+        slice.append(slice.at(0));
+        slice.append(slice.at(1));
+        slice.append(slice.at(2));
+    }
+    if (!slice.isEmpty())
+        slices->append(slice);
+}
+
+static double tileRingArea(const QVector<double> &ring)
+{
+    double area = 0;
+    for (int i = 3; i < ring.size(); i += 3)
+        area += ring.at(i - 3) * ring.at(i + 1) - ring.at(i) * ring.at(i - 2);
+    return qAbs(area) * 0.5;
+}
+
+static double tileLineLength(const QVector<double> &ring)
+{
+    double length = 0;
+    for (int i = 3; i < ring.size(); i += 3) {
+        const double dx = ring.at(i) - ring.at(i - 3);
+        const double dy = ring.at(i + 1) - ring.at(i - 2);
+        length += qSqrt(dx * dx + dy * dy);
+    }
+    return length;
+}
+
+static QList<QGeoCoordinate> tileRingCoordinates(const QVector<double> &ring, double sqTolerance)
+{
+    QList<QGeoCoordinate> coordinates;
+    coordinates.reserve(ring.size() / 3);
+    for (int i = 0; i < ring.size(); i += 3) {
+        if (sqTolerance == 0 || ring.at(i + 2) > sqTolerance)
+            coordinates.append(tileUnproject(ring.at(i), ring.at(i + 1)));
+    }
+    return coordinates;
+}
+
+/*! \class QGeoJsonTileIndex
+    \inmodule Qt.labs.location
+    \ingroup json
+    \since WIP
+
+    \brief The QGeoJsonTileIndex class slices the features of a GeoJSON document into z/x/y
+    map tiles.
+
+    build() projects the geometries once to Web Mercator and ranks their positions with the
+    Douglas-Peucker algorithm, down to the tolerance of the deepest zoom level. tile() then
+    produces a tile on its first request, by clipping the features of its deepest already
+    produced ancestor level after level, and keeps it: later requests for the same tile return
+    the stored map. The features kept for a tile include those within Options::buffer pixels
+    of its edges, so that the clipped geometries of neighboring tiles overlap.
+
+    Lines are cut into as many parts as the tile crosses, polygon rings, holes included, are
+    clipped separately and closed along the tile edges. A polygon whose outer ring falls
+    outside the tile is left out with its holes. Tiles below Options::maxZoom keep only the
+    positions that matter at their scale, and drop the lines shorter and the rings smaller
+    than the tolerance. GeometryCollections are split into one feature per geometry, sharing
+    the properties and id of their feature. Geometries are not wrapped across the
+    antimeridian.
+
+    Positions are read and written with the longitude in QGeoCoordinate::latitude(), which
+    is where the importer stores the first member of a GeoJSON position.
+
+    The index is not thread-safe: tile() updates the cache.
+*/
+
+QGeoJsonTileIndex::QGeoJsonTileIndex()
+    : m_featureCount(0)
+{
+}
+
+/*!
+    Projects the geometries of \a geojsonMap, as returned by QGeoJson::importGeoJson(), and
+    makes them the content of tile 0/0/0, using \a options for every tile produced.
+*/
+void QGeoJsonTileIndex::build(const QVariantMap &geojsonMap, const Options &options)
+{
+    clear();
+    m_options = options;
+    m_options.maxZoom = qBound(0, options.maxZoom, 24);
+    m_options.extent = qMax(1, options.extent);
+
+    Tile root;
+    QVariantList features;
+    if (geojsonMap.contains(QStringLiteral("FeatureCollection")))
+        features = geojsonMap.value(QStringLiteral("FeatureCollection")).value<QVariantList>();
+    else if (geojsonMap.contains(QStringLiteral("Feature")))
+        features.append(geojsonMap);
+    else
+        addGeometry(&root.source, geojsonMap, QVariant(), QVariant());
+
+    for (const QVariant &featureVariant: qAsConst(features)) {
+        const QVariantMap feature = featureVariant.value<QVariantMap>().value(QStringLiteral("Feature")).value<QVariantMap>();
+        addGeometry(&root.source, feature.value(QStringLiteral("geometry")).value<QVariantMap>(),
+                    feature.value(QStringLiteral("properties")), feature.value(QStringLiteral("id")));
+    }
+    m_featureCount = root.source.size();
+    m_tiles.insert(tileKey(0, 0, 0), root);
+}
+
+/*!
+    Removes the features and every tile.
+*/
+void QGeoJsonTileIndex::clear()
+{
+    m_tiles.clear();
+    m_featureCount = 0;
+}
+
+/*!
+    Removes every produced tile but 0/0/0, which holds the projected features.
+*/
+void QGeoJsonTileIndex::clearCache()
+{
+    if (m_tiles.isEmpty())
+        return;
+    const Tile root = m_tiles.value(tileKey(0, 0, 0));
+    m_tiles.clear();
+    m_tiles.insert(tileKey(0, 0, 0), root);
+}
+
+void QGeoJsonTileIndex::addGeometry(QVector<Feature> *features, const QVariantMap &geometryMap,
+                                    const QVariant &properties, const QVariant &id) const
+{
+    const double maxZoomTolerance = m_options.tolerance / (double(1 << m_options.maxZoom) * m_options.extent);
+    const double sqTolerance = maxZoomTolerance * maxZoomTolerance;
+
+    QVariantMap::const_iterator iter;
+    for (iter = geometryMap.begin(); iter != geometryMap.end(); ++iter) {
+        const QString &key = iter.key();
+        Feature feature;
+        feature.properties = properties;
+        feature.id = id;
+        QVector<Ring> rings;
+        if (key == QStringLiteral("Point")) {
+            feature.type = PointFeature;
+            rings.append(Ring());
+            appendTilePositions(&rings.last(), QList<QGeoCoordinate>() << iter.value().value<QGeoCircle>().center());
+            feature.parts.append(rings);
+        } else if (key == QStringLiteral("MultiPoint")) {
+            feature.type = MultiPointFeature;
+            rings.append(Ring());
+            for (const QVariant &point: iter.value().value<QVariantList>())
+                appendTilePositions(&rings.last(), QList<QGeoCoordinate>() << point.value<QGeoCircle>().center());
+            feature.parts.append(rings);
+        } else if (key == QStringLiteral("LineString") || key == QStringLiteral("MultiLineString")) {
+            QVariantList paths;
+            if (key == QStringLiteral("LineString")) {
+                feature.type = LineStringFeature;
+                paths.append(iter.value());
+            } else {
+                feature.type = MultiLineStringFeature;
+                paths = iter.value().value<QVariantList>();
+            }
+            for (const QVariant &path: qAsConst(paths)) {
+                Ring ring;
+                appendTilePositions(&ring, path.value<QGeoPath>().path());
+                markTileImportance(&ring, sqTolerance);
+                feature.parts.append(QVector<Ring>() << ring);
+            }
+        } else if (key == QStringLiteral("Polygon") || key == QStringLiteral("MultiPolygon")) {
+            QVariantList polygons;
+            if (key == QStringLiteral("Polygon")) {
+                feature.type = PolygonFeature;
+                polygons.append(iter.value());
+            } else {
+                feature.type = MultiPolygonFeature;
+                polygons = iter.value().value<QVariantList>();
+            }
+            for (const QVariant &polygonVariant: qAsConst(polygons)) {
+                const QGeoPolygon polygon = polygonVariant.value<QGeoPolygon>();
+                rings.clear();
+                for (int i = -1; i < polygon.holesCount(); ++i) {
+                    Ring ring;
+                    appendTilePositions(&ring, i < 0 ? polygon.path() : polygon.holePath(i));
+                    markTileImportance(&ring, sqTolerance);
+                    rings.append(ring);
+                }
+                feature.parts.append(rings);
+            }
+        } else if (key == QStringLiteral("GeometryCollection")) {
+            for (const QVariant &geometry: iter.value().value<QVariantList>())
+                addGeometry(features, geometry.value<QVariantMap>(), properties, id);
+            continue;
+        } else {
+            continue;
+        }
+
+        updateBounds(&feature);
+        if (feature.minX <= feature.maxX) // has at least one position
+            features->append(feature);
+    }
+}
+
+void QGeoJsonTileIndex::updateBounds(Feature *feature)
+{
+    feature->minX = feature->minY = std::numeric_limits<double>::infinity();
+    feature->maxX = feature->maxY = -std::numeric_limits<double>::infinity();
+    for (const QVector<Ring> &rings: qAsConst(feature->parts)) {
+        for (const Ring &ring: rings) {
+            for (int i = 0; i < ring.size(); i += 3) {
+                feature->minX = qMin(feature->minX, ring.at(i));
+                feature->maxX = qMax(feature->maxX, ring.at(i));
+                feature->minY = qMin(feature->minY, ring.at(i + 1));
+                feature->maxY = qMax(feature->maxY, ring.at(i + 1));
+            }
+        }
+    }
+}
+
+QVector<QGeoJsonTileIndex::Feature> QGeoJsonTileIndex::clipFeatures(const QVector<Feature> &features, double k1,
+                                                                    double k2, int axis)
+{
+    QVector<Feature> clipped;
+    for (const Feature &feature: features) {
+        const double min = axis == 0 ? feature.minX : feature.minY;
+        const double max = axis == 0 ? feature.maxX : feature.maxY;
+        if (min >= k1 && max <= k2) {
+            clipped.append(feature); // entirely inside
+            continue;
+        }
+        if (max < k1 || min > k2)
+            continue;
+
+        Feature part = feature;
+        part.parts.clear();
+        for (const QVector<Ring> &rings: feature.parts) {
+            switch (feature.type) {
+            case PointFeature:
+            case MultiPointFeature:
+            {
+                Ring points;
+                const Ring &ring = rings.first();
+                for (int i = 0; i < ring.size(); i += 3) {
+                    const double value = ring.at(i + axis);
+                    if (value >= k1 && value <= k2) {
+                        points.append(ring.at(i));
+                        points.append(ring.at(i + 1));
+                        points.append(ring.at(i + 2));
+                    }
+                }
+                if (!points.isEmpty())
+                    part.parts.append(QVector<Ring>() << points);
+                break;
+            }
+            case LineStringFeature:
+            case MultiLineStringFeature:
+            {
+                QVector<Ring> slices;
+                clipTileLine(rings.first(), &slices, k1, k2, axis, false);
+                for (const Ring &slice: qAsConst(slices)) {
+                    if (slice.size() >= 6)
+                        part.parts.append(QVector<Ring>() << slice);
+                }
+                break;
+            }
+            case PolygonFeature:
+            case MultiPolygonFeature:
+            {
+                QVector<Ring> polygon;
+                for (int i = 0; i < rings.size(); ++i) {
+                    QVector<Ring> slices;
+                    clipTileLine(rings.at(i), &slices, k1, k2, axis, true);
+                    if (slices.isEmpty() || slices.first().size() < 12) {
+                        if (i == 0)
+                            break; // the holes go with the outer ring
+                        continue;
+                    }
+                    polygon.append(slices.first());
+                }
+                if (!polygon.isEmpty())
+                    part.parts.append(polygon);
+                break;
+            }
+            }
+        }
+        if (part.parts.isEmpty())
+            continue;
+        updateBounds(&part);
+        clipped.append(part);
+    }
+    return clipped;
+}
+
+QVariantMap QGeoJsonTileIndex::renderTile(const QVector<Feature> &features, int z) const
+{
+    const double tolerance = z == m_options.maxZoom ? 0 : m_options.tolerance / (double(1 << z) * m_options.extent);
+    const double sqTolerance = tolerance * tolerance;
+    const QString keyFeature = QStringLiteral("Feature");
+
+    QVariantList parsedFeatureCollection;
+    QVariantMap importedMap;
+    for (const Feature &feature: features) {
+        QVariantMap geometry;
+        switch (feature.type) {
+        case PointFeature:
+        case MultiPointFeature:
+        {
+            const QList<QGeoCoordinate> points = tileRingCoordinates(feature.parts.first().first(), 0);
+            if (feature.type == PointFeature && points.size() == 1) {
+                QGeoCircle point;
+                point.setCenter(points.first());
+                geometry.insert(QStringLiteral("Point"), QVariant::fromValue(point));
+            } else {
+                geometry.insert(QStringLiteral("MultiPoint"), importMultiPointCoordinates(points));
+            }
+            break;
+        }
+        case LineStringFeature:
+        case MultiLineStringFeature:
+        {
+            QList<QList<QGeoCoordinate>> paths;
+            for (const QVector<Ring> &rings: feature.parts) {
+                if (tolerance > 0 && tileLineLength(rings.first()) < tolerance)
+                    continue;
+                const QList<QGeoCoordinate> path = tileRingCoordinates(rings.first(), sqTolerance);
+                if (path.size() >= 2)
+                    paths.append(path);
+            }
+            if (paths.isEmpty())
+                continue;
+            if (feature.type == LineStringFeature && paths.size() == 1) {
+                QGeoPath path;
+                path.setPath(paths.first());
+                geometry.insert(QStringLiteral("LineString"), QVariant::fromValue(path));
+            } else {
+                geometry.insert(QStringLiteral("MultiLineString"), importMultiLineStringCoordinates(paths));
+            }
+            break;
+        }
+        case PolygonFeature:
+        case MultiPolygonFeature:
+        {
+            QVariantList polygons;
+            for (const QVector<Ring> &rings: feature.parts) {
+                QList<QList<QGeoCoordinate>> perimeters;
+                for (int i = 0; i < rings.size(); ++i) {
+                    const QList<QGeoCoordinate> ring = (tolerance > 0 && tileRingArea(rings.at(i)) < sqTolerance)
+                            ? QList<QGeoCoordinate>() : tileRingCoordinates(rings.at(i), sqTolerance);
+                    if (ring.size() < 4) { // too small, or collapsed by the simplification
+                        if (i == 0)
+                            break;
+                        continue;
+                    }
+                    perimeters.append(ring);
+                }
+                if (!perimeters.isEmpty())
+                    polygons.append(QVariant::fromValue(importPolygonPerimeters(perimeters)));
+            }
+            if (polygons.isEmpty())
+                continue;
+            if (feature.type == PolygonFeature && polygons.size() == 1)
+                geometry.insert(QStringLiteral("Polygon"), polygons.first());
+            else
+                geometry.insert(QStringLiteral("MultiPolygon"), polygons);
+            break;
+        }
+        }
+
+        QVariantMap parsedFeature;
+        parsedFeature.insert(QStringLiteral("geometry"), geometry);
+        parsedFeature.insert(QStringLiteral("properties"), feature.properties);
+        if (feature.id != QVariant::Invalid)
+            parsedFeature.insert(QStringLiteral("id"), feature.id);
+        importedMap.insert(keyFeature, parsedFeature);
+        parsedFeatureCollection.append(importedMap);
+    }
+
+    QVariantMap parsedGeoJsonMap;
+    parsedGeoJsonMap.insert(QStringLiteral("FeatureCollection"), parsedFeatureCollection);
+    return parsedGeoJsonMap;
+}
+
+/*!
+    Returns the features of the tile \a x, \a y at zoom level \a z, in the layout of
+    QGeoJson::importGeoJson(), as a "FeatureCollection" whose coordinates are clipped to the
+    tile and its buffer and simplified for the zoom level. The map can be passed to
+    QGeoJson::exportGeoJson().
+
+    The first request of a tile produces it and the tiles on the way from its deepest produced
+    ancestor; later requests return the stored map. An empty map is returned for coordinates
+    outside of the zoom level, for levels above Options::maxZoom, and before build().
+*/
+QVariantMap QGeoJsonTileIndex::tile(int z, int x, int y)
+{
+    if (m_tiles.isEmpty() || z < 0 || z > m_options.maxZoom)
+        return QVariantMap();
+    const int tileCount = 1 << z;
+    if (x < 0 || x >= tileCount || y < 0 || y >= tileCount)
+        return QVariantMap();
+
+    QHash<quint64, Tile>::iterator tileIter = m_tiles.find(tileKey(z, x, y));
+    if (tileIter != m_tiles.end() && tileIter->rendered)
+        return tileIter->geojson;
+
+    if (tileIter == m_tiles.end()) {
+        // the root tile is always there
+        int parentZ = z - 1;
+        while (!m_tiles.contains(tileKey(parentZ, x >> (z - parentZ), y >> (z - parentZ))))
+            --parentZ;
+        QVector<Feature> source = m_tiles.value(tileKey(parentZ, x >> (z - parentZ), y >> (z - parentZ))).source;
+
+        const double buffer = double(m_options.buffer) / m_options.extent;
+        for (int childZ = parentZ + 1; childZ <= z; ++childZ) {
+            const int childX = x >> (z - childZ);
+            const int childY = y >> (z - childZ);
+            const double scale = double(1 << childZ);
+            source = clipFeatures(source, (childX - buffer) / scale, (childX + 1 + buffer) / scale, 0);
+            source = clipFeatures(source, (childY - buffer) / scale, (childY + 1 + buffer) / scale, 1);
+            Tile child;
+            child.source = source;
+            tileIter = m_tiles.insert(tileKey(childZ, childX, childY), child);
+        }
+    }
+
+    tileIter->geojson = renderTile(tileIter->source, z);
+    tileIter->rendered = true;
+    return tileIter->geojson;
+}
+
+// Property tables
+
+/*! \class QGeoJsonPropertyTable
+    \inmodule Qt.labs.location
+    \ingroup json
+    \since WIP
+
+    \brief The QGeoJsonPropertyTable class stores the properties of the features of a
+    collection by schema, instead of in a QVariantMap per feature.
+
+    Each row holds the "properties" member of one feature. A map is stored under the schema
+    of its set of keys: the keys are kept once per schema, and shared by all the schemas
+    containing them, and the values of each key are stored in a column, one QVariant per row
+    of the schema. Features of a layer usually share a single schema, so the map nodes and
+    key strings of every feature are replaced by a slot per value. Properties that are not a
+    map are stored as they are.
+
+    The table is filled by QGeoJson::importGeoJson() when ImportOptions::propertyTable is set,
+    and read by QGeoJson::exportGeoJsonText() when ExportOptions::propertyTable is, the row of
+    a feature being its position in the "FeatureCollection" list. appendPropertiesJson()
+    writes the keys from text escaped once per schema.
+*/
+
+QGeoJsonPropertyTable::QGeoJsonPropertyTable()
+    : m_lastSchema(-1)
+{
+}
+
+void QGeoJsonPropertyTable::clear()
+{
+    m_schemas.clear();
+    m_schemaIndex.clear();
+    m_keys.clear();
+    m_rows.clear();
+    m_otherValues.clear();
+    m_lastSchema = -1;
+}
+
+void QGeoJsonPropertyTable::reserve(int rowCount)
+{
+    m_rows.reserve(rowCount);
+}
+
+static bool hasSchemaKeys(const QVariantMap &properties, const QStringList &keys)
+{
+    if (properties.size() != keys.size())
+        return false;
+    int i = 0;
+    for (QVariantMap::const_iterator iter = properties.constBegin(); iter != properties.constEnd(); ++iter) {
+        if (iter.key() != keys.at(i++))
+            return false;
+    }
+    return true;
+}
+
+int QGeoJsonPropertyTable::findSchema(const QVariantMap &properties)
+{
+    if (m_lastSchema >= 0 && hasSchemaKeys(properties, m_schemas.at(m_lastSchema).keys))
+        return m_lastSchema;
+
+    QString signature;
+    for (QVariantMap::const_iterator iter = properties.constBegin(); iter != properties.constEnd(); ++iter) {
+        signature.append(iter.key());
+        signature.append(QChar(0));
+    }
+    const QHash<QString, int>::const_iterator found = m_schemaIndex.constFind(signature);
+    if (found != m_schemaIndex.constEnd()) {
+        m_lastSchema = found.value();
+        return m_lastSchema;
+    }
+
+    Schema schema;
+    schema.rowCount = 0;
+    schema.columns.resize(properties.size());
+    for (QVariantMap::const_iterator iter = properties.constBegin(); iter != properties.constEnd(); ++iter) {
+        QHash<QString, QString>::const_iterator key = m_keys.constFind(iter.key());
+        if (key == m_keys.constEnd())
+            key = m_keys.insert(iter.key(), iter.key());
+        schema.keys.append(key.value());
+        QByteArray text;
+        appendJsonValueText(&text, QJsonValue(key.value()));
+        text.append(':');
+        schema.keyText.append(text);
+    }
+    m_schemas.append(schema);
+    m_lastSchema = m_schemas.size() - 1;
+    m_schemaIndex.insert(signature, m_lastSchema);
+    return m_lastSchema;
+}
+
+/*!
+    Appends a row holding \a properties and returns its number.
+*/
+int QGeoJsonPropertyTable::appendRow(const QVariant &properties)
+{
+    Row row;
+    if (properties.userType() == QMetaType::QVariantMap) {
+        const QVariantMap map = properties.toMap();
+        row.schema = findSchema(map);
+        Schema &schema = m_schemas[row.schema];
+        row.index = schema.rowCount++;
+        int column = 0;
+        for (QVariantMap::const_iterator iter = map.constBegin(); iter != map.constEnd(); ++iter)
+            schema.columns[column++].append(iter.value());
+    } else {
+        row.schema = -1;
+        row.index = m_otherValues.size();
+        m_otherValues.append(properties);
+    }
+    m_rows.append(row);
+    return m_rows.size() - 1;
+}
+
+/*!
+    Returns the properties of \a row, a QVariantMap rebuilt from the columns of its schema
+    when they were one.
+*/
+QVariant QGeoJsonPropertyTable::properties(int row) const
+{
+    if (row < 0 || row >= m_rows.size())
+        return QVariant();
+    const Row &entry = m_rows.at(row);
+    if (entry.schema < 0)
+        return m_otherValues.at(entry.index);
+    const Schema &schema = m_schemas.at(entry.schema);
+    QVariantMap map;
+    for (int i = 0; i < schema.keys.size(); ++i)
+        map.insert(schema.keys.at(i), schema.columns.at(i).at(entry.index));
+    return map;
+}
+
+/*!
+    Returns the value of \a key in the properties of \a row, or an invalid QVariant when they
+    have no such key.
+*/
+QVariant QGeoJsonPropertyTable::value(int row, const QString &key) const
+{
+    if (row < 0 || row >= m_rows.size() || m_rows.at(row).schema < 0)
+        return QVariant();
+    const Row &entry = m_rows.at(row);
+    const Schema &schema = m_schemas.at(entry.schema);
+    const int column = schema.keys.indexOf(key);
+    return column < 0 ? QVariant() : schema.columns.at(column).at(entry.index);
+}
+
+int QGeoJsonPropertyTable::rowSchema(int row) const
+{
+    return row >= 0 && row < m_rows.size() ? m_rows.at(row).schema : -1;
+}
+
+QStringList QGeoJsonPropertyTable::schemaKeys(int schema) const
+{
+    return schema >= 0 && schema < m_schemas.size() ? m_schemas.at(schema).keys : QStringList();
+}
+
+int QGeoJsonPropertyTable::schemaRowCount(int schema) const
+{
+    return schema >= 0 && schema < m_schemas.size() ? m_schemas.at(schema).rowCount : 0;
+}
+
+/*!
+    Returns the values of \a key for the rows of \a schema, in the order the rows were
+    appended, without copying them.
+*/
+QVector<QVariant> QGeoJsonPropertyTable::column(int schema, const QString &key) const
+{
+    if (schema < 0 || schema >= m_schemas.size())
+        return QVector<QVariant>();
+    const int column = m_schemas.at(schema).keys.indexOf(key);
+    return column < 0 ? QVector<QVariant>() : m_schemas.at(schema).columns.at(column);
+}
+
+/*!
+    Appends to \a text the compact JSON text of the properties of \a row, the same as the
+    "properties" member of exportFeature() serialized by QJsonDocument. Properties that are
+    not a map are written as an empty object.
+*/
+void QGeoJsonPropertyTable::appendPropertiesJson(QByteArray *text, int row) const
+{
+    if (row < 0 || row >= m_rows.size()) {
+        text->append("{}");
+        return;
+    }
+    const Row &entry = m_rows.at(row);
+    if (entry.schema < 0) {
+        appendJsonValueText(text, m_otherValues.at(entry.index).toJsonObject());
+        return;
+    }
+    const Schema &schema = m_schemas.at(entry.schema);
+    text->append('{');
+    for (int i = 0; i < schema.columns.size(); ++i) {
+        if (i)
+            text->append(',');
+        text->append(schema.keyText.at(i));
+        appendJsonValueText(text, QJsonValue::fromVariant(schema.columns.at(i).at(entry.index)));
+    }
+    text->append('}');
+}
+
+/*!
+    Returns the heap bytes held by the table, counted like QGeoJson::memoryUsage() does. The
+    values go to QGeoJsonMemoryUsage::propertyBytes, the keys, columns and rows to
+    QGeoJsonMemoryUsage::overheadBytes.
+*/
+QGeoJsonMemoryUsage QGeoJsonPropertyTable::memoryUsage() const
+{
+    // QVector keeps its QVariant slots inline, after a 24-byte header
+    QGeoJsonMemoryUsage usage;
+    for (const Schema &schema: m_schemas) {
+        usage.overheadBytes += allocationBytes(ListHeaderBytes + 8 * qint64(schema.keys.size()));
+        for (int i = 0; i < schema.columns.size(); ++i) {
+            usage.overheadBytes += allocationBytes(ArrayHeaderBytes + schema.keyText.at(i).size() + 1);
+            usage.overheadBytes += allocationBytes(ArrayHeaderBytes + 16 * qint64(schema.columns.at(i).size()));
+            for (const QVariant &value: schema.columns.at(i))
+                usage.propertyBytes += variantBytes(value);
+        }
+    }
+    for (QHash<QString, QString>::const_iterator iter = m_keys.constBegin(); iter != m_keys.constEnd(); ++iter)
+        usage.overheadBytes += stringBytes(iter.key().size());
+    usage.overheadBytes += allocationBytes(ArrayHeaderBytes + 8 * qint64(m_rows.size()));
+    usage.overheadBytes += variantListStructureBytes(m_otherValues.size());
+    for (const QVariant &value: m_otherValues)
+        usage.propertyBytes += variantBytes(value);
+    return usage;
 }
 
 QT_END_NAMESPACE
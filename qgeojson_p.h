@@ -42,6 +42,14 @@
 
 #include <QtCore/qvariant.h>
 #include <QtCore/qjsondocument.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qvector.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qsharedpointer.h>
+#include <QtCore/qfuture.h>
+#include <QtPositioning/qgeorectangle.h>
+
+#include <functional>
 
 //
 //  W A R N I N G
@@ -55,6 +63,62 @@
 //
 QT_BEGIN_NAMESPACE
 
+class QGeoCoordinate;
+class QGeoCircle;
+class QGeoPath;
+class QGeoPolygon;
+class QGeoJsonGeometryStore;
+class QGeoJsonSnapshot;
+class QGeoJsonLazyDocument;
+class QGeoJsonObject;
+class QGeoJsonPropertyTable;
+class QDebug;
+class QFile;
+class QThreadPool;
+class QCborValue;
+struct QCborParserError;
+
+struct QGeoJsonStats
+{
+    QGeoJsonStats() { reset(); }
+    void reset();
+
+    // wall time of each phase, in nanoseconds
+    qint64 parseTime; // UTF-8 text to QJsonDocument, or the whole direct text import
+    qint64 variantTime; // QJsonObject::toVariantMap()
+    qint64 conversionTime; // between JSON values and QGeoShape objects
+    qint64 serializationTime; // QJsonDocument to UTF-8 text
+
+    // content of the imported, or exported, map
+    int featureCount;
+    int geometryCounts[7]; // indexed by QGeoJsonGeometryStore::GeometryType
+    int ringCount; // Polygon perimeters and holes
+    qint64 vertexCount;
+
+    qint64 bytesIn;
+    qint64 bytesOut;
+};
+
+#ifndef QT_NO_DEBUG_STREAM
+QDebug operator<<(QDebug debug, const QGeoJsonStats &stats);
+#endif
+
+// Heap bytes retained by an imported map, modeled on Qt 5 containers on a 64-bit heap
+struct QGeoJsonMemoryUsage
+{
+    QGeoJsonMemoryUsage() : geometryBytes(0), propertyBytes(0), overheadBytes(0) {}
+
+    qint64 totalBytes() const { return geometryBytes + propertyBytes + overheadBytes; }
+
+    qint64 geometryBytes; // geometry maps, shapes and coordinates
+    qint64 propertyBytes; // "properties" and "id" values
+    qint64 overheadBytes; // document, collection and feature maps and lists
+};
+
+#ifndef QT_NO_DEBUG_STREAM
+QDebug operator<<(QDebug debug, const QGeoJsonMemoryUsage &usage);
+#endif
+
 class QGeoJson
 {
 
@@ -62,11 +126,740 @@ public:
     QGeoJson();
     ~QGeoJson();
 
+    enum Simplification {
+        NoSimplification,
+        DouglasPeucker,
+        VisvalingamWhyatt
+    };
+
+    struct ImportOptions
+    {
+        ImportOptions()
+            : threadCount(1), simplification(NoSimplification), simplifyTolerance(0), memoryBudget(0),
+              errorString(nullptr), propertyTable(nullptr), stats(nullptr) {}
+
+        int threadCount; // worker threads for FeatureCollections, 0 for QThread::idealThreadCount()
+        QGeoRectangle filter; // only import the features intersecting it, unless invalid; longitudes match the first position member
+        Simplification simplification; // applied to paths and polygon rings as they are imported
+        double simplifyTolerance; // in degrees, simplification is off unless positive
+        qint64 memoryBudget; // bytes the imported map may retain, as memoryUsage() counts them, 0 for no limit
+        QString *errorString; // set when the import is aborted, when not null
+        QGeoJsonPropertyTable *propertyTable; // receives the feature properties instead of the feature maps, when not null
+        QGeoJsonStats *stats; // filled by the call when not null
+    };
+
     // importer public method
     static QVariantMap importGeoJson(const QJsonDocument &geojsonDoc);
+    static QVariantMap importGeoJson(const QJsonDocument &geojsonDoc, const ImportOptions &options);
+    static QVariantMap importGeoJson(const QByteArray &geojsonText, QJsonParseError *error = nullptr);
+    static QVariantMap importGeoJson(const QByteArray &geojsonText, const ImportOptions &options,
+                                     QJsonParseError *error = nullptr);
+    static QVariantMap importGeoJsonFile(const QString &fileName, QJsonParseError *error = nullptr,
+                                         QString *errorString = nullptr);
+    static QFuture<QVariantMap> importGeoJsonAsync(const QByteArray &geojsonText, QThreadPool *pool = nullptr);
+
+    // memory accounting of the importGeoJson() layout
+    static QGeoJsonMemoryUsage estimateMemoryUsage(const QByteArray &geojsonText, QJsonParseError *error = nullptr);
+    static QGeoJsonMemoryUsage memoryUsage(const QVariantMap &geojsonMap);
+
+    struct ExportOptions
+    {
+        ExportOptions() : threadCount(1), coordinatePrecision(-1), propertyTable(nullptr), stats(nullptr) {}
+
+        int threadCount; // worker threads for FeatureCollections, 0 for QThread::idealThreadCount()
+        int coordinatePrecision; // decimal places of the coordinates, up to 15, -1 for shortest round-trip
+        const QGeoJsonPropertyTable *propertyTable; // properties of the features by position, when not null
+        QGeoJsonStats *stats; // filled by the call when not null
+    };
 
     // exporter public method
     static QJsonDocument exportGeoJson(const QVariantMap &geojsonMap);
+    static QByteArray exportGeoJsonText(const QVariantMap &geojsonMap, const ExportOptions &options = ExportOptions());
+
+    // columnar import target
+    static QGeoJsonGeometryStore importGeometryStore(const QJsonDocument &geojsonDoc);
+    static QGeoJsonGeometryStore importGeometryStore(const QByteArray &geojsonText, QJsonParseError *error = nullptr);
+    static QGeoJsonLazyDocument importLazy(const QByteArray &geojsonText, QJsonParseError *error = nullptr);
+    static QJsonDocument exportGeometryStore(const QGeoJsonGeometryStore &store);
+
+    // binary snapshot of a geometry store, memory-mapped when loaded
+    static bool saveSnapshot(const QGeoJsonGeometryStore &store, const QString &fileName,
+                             QString *errorString = nullptr);
+    static QGeoJsonSnapshot loadSnapshot(const QString &fileName, QString *errorString = nullptr);
+
+    // typed import target
+    static QGeoJsonObject importTyped(const QJsonDocument &geojsonDoc);
+    static QJsonDocument exportTyped(const QGeoJsonObject &geojsonObject);
+
+    // CBOR, with positions packed in RFC 8746 typed arrays
+    static QVariantMap importGeoJsonCbor(const QCborValue &geojsonValue);
+    static QVariantMap importGeoJsonCbor(const QByteArray &geojsonCbor, QCborParserError *error = nullptr);
+    static QCborValue exportGeoJsonCbor(const QVariantMap &geojsonMap);
+};
+
+class QGeoJsonGeometryStore
+{
+public:
+    enum DocumentType : quint8 {
+        GeometryDocument,
+        FeatureDocument,
+        FeatureCollectionDocument
+    };
+
+    enum GeometryType : quint8 {
+        Point,
+        MultiPoint,
+        LineString,
+        MultiLineString,
+        Polygon,
+        MultiPolygon,
+        GeometryCollection
+    };
+
+    // Zero-copy view on consecutive positions, z is null when the store has no altitudes
+    struct CoordinateView
+    {
+        const double *x;
+        const double *y;
+        const double *z;
+        int size;
+
+        QGeoCoordinate coordinate(int i) const;
+        QList<QGeoCoordinate> toList() const;
+    };
+
+    QGeoJsonGeometryStore();
+
+    DocumentType documentType() const { return m_documentType; }
+    void setDocumentType(DocumentType type) { m_documentType = type; }
+    QVariant boundingBox() const { return m_bbox; }
+    void setBoundingBox(const QVariant &bbox) { m_bbox = bbox; }
+
+    // builder interface, geometries are appended in pre-order
+    int addGeometry(GeometryType type, int childCount = 0);
+    void addPart();
+    void addRing();
+    void addPosition(double x, double y);
+    void addPosition(double x, double y, double z);
+    void addFeature(int geometry, const QVariant &properties, const QVariant &id);
+    void addFeatureJson(int geometry, const char *properties, int propertiesLength, const char *id, int idLength);
+    int insertGeometryCollection(int geometry, int childCount);
+    void truncate(int geometryCount, int featureCount);
+    void squeeze();
+
+    int geometryCount() const { return m_geometryTypes.size(); }
+    GeometryType geometryType(int geometry) const { return GeometryType(m_geometryTypes.at(geometry)); }
+    int childCount(int geometry) const { return m_geometryChildren.at(geometry); }
+    int partCount(int geometry) const;
+    int ringCount(int geometry, int part) const;
+    CoordinateView ring(int geometry, int part, int ring) const;
+    int vertexCount() const { return m_x.size(); }
+    bool hasAltitude() const { return !m_z.isEmpty(); }
+
+    int featureCount() const { return m_featureGeometries.size(); }
+    int featureGeometry(int feature) const { return m_featureGeometries.at(feature); }
+    QVariant featureProperties(int feature) const;
+    QVariant featureId(int feature) const;
+
+    QGeoCircle toGeoCircle(int geometry, int part = 0) const;
+    QGeoPath toGeoPath(int geometry, int part = 0) const;
+    QGeoPolygon toGeoPolygon(int geometry, int part = 0) const;
+    QVariantMap toVariantMap() const;
+
+    // raw columns
+    const QVector<double> &x() const { return m_x; }
+    const QVector<double> &y() const { return m_y; }
+    const QVector<double> &z() const { return m_z; }
+    const QVector<int> &ringOffsets() const { return m_ringOffsets; }
+    const QVector<int> &partOffsets() const { return m_partOffsets; }
+    const QVector<int> &geometryOffsets() const { return m_geometryOffsets; }
+
+private:
+    friend class QGeoJson;
+    friend class QGeoJsonSnapshot;
+
+    QVariant featureJsonValue(int slot) const;
+
+    QVector<double> m_x;
+    QVector<double> m_y;
+    QVector<double> m_z; // empty unless a position has an altitude, NaN for the others
+    QVector<int> m_ringOffsets; // per ring, first position, plus the end
+    QVector<int> m_partOffsets; // per part, first ring, plus the end
+    QVector<int> m_geometryOffsets; // per geometry, first part, plus the end
+    QVector<quint8> m_geometryTypes;
+    QVector<int> m_geometryChildren;
+
+    QVector<int> m_featureGeometries;
+    QVariantList m_featureProperties;
+    QVariantList m_featureIds;
+    QByteArray m_featureJson; // "properties" and "id" text of the features added by addFeatureJson()
+    QVector<int> m_featureJsonOffsets; // per feature, properties and id begin, plus the end
+
+    DocumentType m_documentType;
+    QVariant m_bbox;
+};
+
+class QGeoJsonSnapshot
+{
+public:
+    QGeoJsonSnapshot();
+
+    bool isNull() const { return !m_base; }
+    bool verifyChecksum() const;
+
+    // same read interface as QGeoJsonGeometryStore, reading the mapped file
+    QGeoJsonGeometryStore::DocumentType documentType() const { return m_documentType; }
+    QVariant boundingBox() const { return m_bbox; }
+
+    int geometryCount() const { return m_geometryCount; }
+    QGeoJsonGeometryStore::GeometryType geometryType(int geometry) const;
+    int childCount(int geometry) const;
+    int partCount(int geometry) const;
+    int ringCount(int geometry, int part) const;
+    QGeoJsonGeometryStore::CoordinateView ring(int geometry, int part, int ring) const;
+    int vertexCount() const { return m_vertexCount; }
+    bool hasAltitude() const { return m_z != nullptr; }
+
+    int featureCount() const { return m_featureCount; }
+    int featureGeometry(int feature) const;
+    QVariant featureProperties(int feature) const;
+    QVariant featureId(int feature) const;
+
+    QGeoCircle toGeoCircle(int geometry, int part = 0) const;
+    QGeoPath toGeoPath(int geometry, int part = 0) const;
+    QGeoPolygon toGeoPolygon(int geometry, int part = 0) const;
+    QVariantMap toVariantMap() const;
+    QGeoJsonGeometryStore toGeometryStore() const;
+
+private:
+    friend class QGeoJson;
+
+    bool setData(const uchar *data, qint64 size, QString *errorString);
+    QVariant featureJsonValue(int slot) const;
+
+    QSharedPointer<QFile> m_file; // owns the mapping
+    QByteArray m_data; // owns the bytes when the file could not be mapped
+    const uchar *m_base;
+    qint64 m_size;
+
+    const double *m_x;
+    const double *m_y;
+    const double *m_z;
+    const int *m_ringOffsets;
+    const int *m_partOffsets;
+    const int *m_geometryOffsets;
+    const quint8 *m_geometryTypes;
+    const int *m_geometryChildren;
+    const int *m_featureGeometries;
+    const int *m_featureJsonOffsets;
+    const char *m_featureJson;
+    int m_vertexCount;
+    int m_geometryCount;
+    int m_featureCount;
+
+    QGeoJsonGeometryStore::DocumentType m_documentType;
+    QVariant m_bbox;
+};
+
+class QGeoJsonLazyDocument
+{
+public:
+    QGeoJsonLazyDocument();
+
+    QGeoJsonGeometryStore::DocumentType documentType() const { return m_documentType; }
+    QVariant boundingBox() const { return m_bbox; }
+
+    int featureCount() const { return m_geometries.size(); }
+    QVariant featureProperties(int feature) const;
+    QVariant featureId(int feature) const;
+    QVariantMap featureGeometry(int feature) const; // decoded on first access, then cached
+    bool isGeometryLoaded(int feature) const { return !m_geometries.at(feature).isEmpty(); }
+    QVariantMap feature(int feature) const; // an element of the importGeoJson() "FeatureCollection" list
+    int featureTextEnd(int feature) const; // offset in the text past the members of the feature
+
+    QVariantMap toVariantMap() const;
+
+private:
+    friend class QGeoJson;
+    friend class GeoJsonImportJob;
+
+    static QGeoJsonLazyDocument scan(const QByteArray &geojsonText, const std::function<bool(int)> &progress,
+                                     QJsonParseError *error);
+    QVariant rangeValue(int range) const;
+
+    QByteArray m_text;
+    QVector<int> m_ranges; // per feature, begin and end of the geometry, properties and id values
+    mutable QVector<QVariantMap> m_geometries; // empty until decoded
+    QGeoJsonGeometryStore::DocumentType m_documentType;
+    QVariant m_bbox;
+};
+
+class QGeoJsonObject
+{
+public:
+    enum Type : quint8 {
+        Point,
+        MultiPoint,
+        LineString,
+        MultiLineString,
+        Polygon,
+        MultiPolygon,
+        GeometryCollection,
+        Feature,
+        FeatureCollection,
+        Null
+    };
+
+    QGeoJsonObject();
+    explicit QGeoJsonObject(Type type);
+
+    Type type() const { return m_type; }
+    bool isGeometry() const { return m_type <= GeometryCollection; }
+
+    // Point, LineString and Polygon hold one shape, the Multi types one shape per member
+    const QList<QGeoShape> &shapes() const { return m_shapes; }
+    void appendShape(const QGeoShape &shape) { m_shapes.append(shape); }
+    QGeoCircle point(int i = 0) const;
+    QGeoPath lineString(int i = 0) const;
+    QGeoPolygon polygon(int i = 0) const;
+
+    // GeometryCollection members, FeatureCollection features, or the geometry of a Feature
+    const QVector<QGeoJsonObject> &children() const { return m_children; }
+    void append(const QGeoJsonObject &child) { m_children.append(child); }
+    QGeoJsonObject geometry() const;
+    void setGeometry(const QGeoJsonObject &geometry);
+
+    QVariant properties() const { return m_properties; }
+    void setProperties(const QVariant &properties) { m_properties = properties; }
+    QVariant id() const { return m_id; }
+    void setId(const QVariant &id) { m_id = id; }
+    QVariant boundingBox() const { return m_bbox; }
+    void setBoundingBox(const QVariant &bbox) { m_bbox = bbox; }
+
+    // conversion to and from the QVariantMap layout of QGeoJson::importGeoJson()
+    QVariantMap toVariantMap() const;
+    static QGeoJsonObject fromVariantMap(const QVariantMap &geojsonMap);
+
+private:
+    QVariantMap featureMap() const;
+    static QGeoJsonObject fromFeatureMap(const QVariantMap &featureMap);
+
+    Type m_type;
+    QList<QGeoShape> m_shapes;
+    QVector<QGeoJsonObject> m_children;
+    QVariant m_properties;
+    QVariant m_id;
+    QVariant m_bbox;
+};
+
+class QIODevice;
+
+class QGeoJsonReader
+{
+public:
+    enum Error {
+        NoError,
+        NotWellFormedError,
+        PrematureEndOfDocumentError
+    };
+
+    QGeoJsonReader();
+    explicit QGeoJsonReader(QIODevice *device);
+    explicit QGeoJsonReader(const QByteArray &data);
+    ~QGeoJsonReader();
+
+    void setDevice(QIODevice *device);
+    QIODevice *device() const;
+
+    void addData(const QByteArray &data);
+    void clear();
+
+    // pull interface, one imported "Feature" map per successful call
+    bool readNextFeature();
+    QVariantMap feature() const;
+
+    // push interface, the handler returns false to stop reading
+    bool readFeatures(const std::function<bool(const QVariantMap &)> &handler);
+
+    bool atEnd() const;
+    Error error() const;
+    QString errorString() const;
+    qint64 characterOffset() const;
+
+private:
+    Q_DISABLE_COPY(QGeoJsonReader)
+
+    // what the scanner expects next, outside of the values
+    enum ScanState : quint8 {
+        DocumentStart,
+        FirstMemberKey, // or the end of an empty object
+        MemberKey,
+        MemberColon,
+        MemberValue,
+        MemberEnd, // ',' or '}'
+        FirstElement, // or the end of an empty "features" array
+        Element,
+        ElementEnd, // ',' or ']'
+        DocumentEnd
+    };
+
+    bool scanFeature(int *start, int *length);
+    bool scanValue();
+    bool parseMemberText(int start, QVariant *value);
+    bool finishDocument();
+    void compactBuffer();
+    bool fetchData();
+    void raiseError(Error error, const QString &message);
+
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    int m_pos;
+    qint64 m_discarded;
+
+    ScanState m_state;
+    QString m_currentKey; // of the top level member being read
+    QString m_type; // "type" member of the document, null until read
+    int m_valueStart; // of the member name, member value or feature being scanned, -1 between them
+    QByteArray m_stack; // open brackets of that value, '{' or '['
+    bool m_inString;
+    bool m_escape;
+    bool m_finished;
+
+    QVariantMap m_feature;
+    Error m_error;
+    QString m_errorString;
+};
+
+class QGeoJsonWriter
+{
+public:
+    QGeoJsonWriter();
+    explicit QGeoJsonWriter(QIODevice *device);
+    ~QGeoJsonWriter();
+
+    void setDevice(QIODevice *device);
+    QIODevice *device() const;
+
+    void setCoordinatePrecision(int precision);
+    int coordinatePrecision() const;
+
+    bool beginFeatureCollection();
+    bool writeFeature(const QVariantMap &feature);
+    bool beginGeometryCollection();
+    bool writeGeometry(const QVariantMap &geometry);
+    bool end();
+
+    bool hasError() const;
+    QString errorString() const;
+
+private:
+    Q_DISABLE_COPY(QGeoJsonWriter)
+
+    enum Collection {
+        NoCollection,
+        FeatureCollection,
+        GeometryCollection
+    };
+
+    bool begin(Collection collection, const char *text);
+    bool writeMember(Collection collection, const QByteArray &text);
+    bool write(const QByteArray &text);
+
+    QIODevice *m_device;
+    Collection m_collection;
+    int m_count;
+    int m_precision;
+    bool m_hasError;
+    QString m_errorString;
+};
+
+class QGeoJsonSeqReader
+{
+public:
+    enum Error {
+        NoError,
+        PrematureEndOfDocumentError
+    };
+
+    QGeoJsonSeqReader();
+    explicit QGeoJsonSeqReader(QIODevice *device);
+    explicit QGeoJsonSeqReader(const QByteArray &data);
+    ~QGeoJsonSeqReader();
+
+    void setDevice(QIODevice *device);
+    QIODevice *device() const;
+
+    void addData(const QByteArray &data);
+    void clear();
+
+    void setThreadCount(int threadCount); // 0 for QThread::idealThreadCount()
+    int threadCount() const;
+    void setBatchSize(int recordCount);
+    int batchSize() const;
+
+    // pull interface, the importGeoJson() map of one record per successful call
+    bool readNextFeature();
+    QVariantMap feature() const;
+
+    // push interface, the handler returns false to stop reading
+    bool readFeatures(const std::function<bool(const QVariantMap &)> &handler);
+
+    bool atEnd() const;
+    Error error() const;
+    QString errorString() const;
+    qint64 characterOffset() const;
+    int invalidRecordCount() const;
+
+private:
+    Q_DISABLE_COPY(QGeoJsonSeqReader)
+
+    enum Framing {
+        UnknownFraming,
+        LineFraming, // newline-delimited
+        RecordSeparatorFraming // RFC 8142, each record introduced by 0x1E
+    };
+
+    bool readBatch();
+    bool scanRecord(int *start, int *end);
+    void importRecords(const QVector<int> &ranges);
+    void compactBuffer();
+    bool fetchData();
+
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    int m_pos;
+    int m_scanPos; // searched for a record separator up to there
+    qint64 m_discarded;
+    Framing m_framing;
+
+    QVector<QVariantMap> m_batch;
+    int m_batchPos;
+    QVariantMap m_feature;
+
+    int m_threadCount;
+    int m_batchSize;
+    QThreadPool *m_pool;
+    int m_invalidCount;
+    Error m_error;
+    QString m_errorString;
+};
+
+class QGeoJsonSeqWriter
+{
+public:
+    QGeoJsonSeqWriter();
+    explicit QGeoJsonSeqWriter(QIODevice *device);
+    ~QGeoJsonSeqWriter();
+
+    void setDevice(QIODevice *device);
+    QIODevice *device() const;
+
+    void setCoordinatePrecision(int precision);
+    int coordinatePrecision() const;
+    void setRecordSeparator(bool enabled); // RFC 8142 framing, newline-delimited otherwise
+    bool recordSeparator() const;
+
+    bool writeFeature(const QVariantMap &feature);
+
+    bool hasError() const;
+    QString errorString() const;
+
+private:
+    Q_DISABLE_COPY(QGeoJsonSeqWriter)
+
+    QIODevice *m_device;
+    int m_precision;
+    bool m_recordSeparator;
+    bool m_hasError;
+    QString m_errorString;
+};
+
+class QGeoJsonIncrementalExporter
+{
+public:
+    QGeoJsonIncrementalExporter();
+
+    void setCoordinatePrecision(int precision);
+    int coordinatePrecision() const { return m_precision; }
+    void setVersionProperty(const QString &name);
+    QString versionProperty() const { return m_versionProperty; }
+
+    QByteArray exportGeoJsonText(const QVariantMap &geojsonMap);
+    int reusedCount() const { return m_reusedCount; } // features of the last export taken from the cache
+    void clear();
+
+private:
+    struct Fragment
+    {
+        quint64 stamp; // content hash, or hash of the version property
+        QByteArray text;
+    };
+
+    QHash<QByteArray, Fragment> m_fragments; // keyed by the JSON text of the feature id
+    QString m_versionProperty;
+    int m_precision;
+    int m_reusedCount;
+};
+
+class QGeoJsonSpatialIndex
+{
+public:
+    QGeoJsonSpatialIndex();
+
+    // builds the index on the features of an imported FeatureCollection, or on a single Feature or geometry
+    void build(const QVariantMap &geojsonMap);
+    void build(const QGeoJsonGeometryStore &store);
+
+    // builder interface, addItem() for every item then finish()
+    void clear();
+    void addItem(int item, double minLatitude, double minLongitude, double maxLatitude, double maxLongitude);
+    void finish();
+
+    int size() const { return m_itemCount; }
+    bool isEmpty() const { return m_itemCount == 0; }
+
+    // geographic arguments, their longitudes compared with the first position members
+    QVector<int> intersects(const QGeoRectangle &rectangle) const;
+    QVector<int> nearest(const QGeoCoordinate &coordinate, int count) const;
+    // in the layout of addItem(), the latitudes bounding the first position members
+    QVector<int> intersects(double minLatitude, double minLongitude, double maxLatitude, double maxLongitude) const;
+
+private:
+    struct Node
+    {
+        double minLatitude;
+        double minLongitude;
+        double maxLatitude;
+        double maxLongitude;
+        int index; // the item for leaves, the first child for inner nodes
+        int childCount;
+    };
+
+    static const int NodeSize = 16;
+
+    QVector<Node> m_nodes; // leaves first, then each level of inner nodes, the root last
+    int m_itemCount;
+};
+
+class QGeoJsonTileIndex
+{
+public:
+    struct Options
+    {
+        Options() : maxZoom(14), extent(4096), tolerance(3), buffer(64) {}
+
+        int maxZoom; // deepest zoom level served, up to 24, its tiles are not simplified
+        int extent; // tile width in pixels, the unit of tolerance and buffer
+        double tolerance; // simplification tolerance, in pixels
+        int buffer; // margin kept around each tile when clipping, in pixels
+    };
+
+    QGeoJsonTileIndex();
+
+    // projects the features of an imported FeatureCollection, or a single Feature or geometry
+    void build(const QVariantMap &geojsonMap, const Options &options = Options());
+    void clear();
+
+    QVariantMap tile(int z, int x, int y);
+
+    Options options() const { return m_options; }
+    int featureCount() const { return m_featureCount; }
+    int cachedTileCount() const { return m_tiles.size(); }
+    void clearCache(); // keeps the projected features of the root tile
+
+private:
+    enum FeatureType {
+        PointFeature,
+        MultiPointFeature,
+        LineStringFeature,
+        MultiLineStringFeature,
+        PolygonFeature,
+        MultiPolygonFeature
+    };
+
+    // x, y and importance triples, x and y in Web Mercator units from 0 to 1
+    typedef QVector<double> Ring;
+
+    struct Feature
+    {
+        FeatureType type;
+        QVector<QVector<Ring>> parts; // the points in a single ring, one ring per line, the rings of each polygon
+        double minX;
+        double minY;
+        double maxX;
+        double maxY;
+        QVariant properties;
+        QVariant id;
+    };
+
+    struct Tile
+    {
+        Tile() : rendered(false) {}
+
+        QVector<Feature> source; // clipped with the buffer, all positions kept
+        QVariantMap geojson; // importGeoJson() layout, once rendered
+        bool rendered;
+    };
+
+    void addGeometry(QVector<Feature> *features, const QVariantMap &geometryMap,
+                     const QVariant &properties, const QVariant &id) const;
+    static QVector<Feature> clipFeatures(const QVector<Feature> &features, double k1, double k2, int axis);
+    static void updateBounds(Feature *feature);
+    QVariantMap renderTile(const QVector<Feature> &features, int z) const;
+
+    Options m_options;
+    QHash<quint64, Tile> m_tiles;
+    int m_featureCount;
+};
+
+class QGeoJsonPropertyTable
+{
+public:
+    QGeoJsonPropertyTable();
+
+    void clear();
+    void reserve(int rowCount);
+
+    // one row per feature, a QVariantMap is stored in the columns of the schema of its keys
+    int appendRow(const QVariant &properties);
+    int rowCount() const { return m_rows.size(); }
+
+    QVariant properties(int row) const; // rebuilt as passed to appendRow()
+    QVariant value(int row, const QString &key) const;
+    int rowSchema(int row) const; // -1 when the properties of the row are not a map
+
+    int schemaCount() const { return m_schemas.size(); }
+    QStringList schemaKeys(int schema) const;
+    int schemaRowCount(int schema) const;
+    QVector<QVariant> column(int schema, const QString &key) const; // in the order of the rows of the schema
+
+    // compact JSON text of the properties of row, as exportFeature() writes them
+    void appendPropertiesJson(QByteArray *text, int row) const;
+    QGeoJsonMemoryUsage memoryUsage() const;
+
+private:
+    struct Schema
+    {
+        QStringList keys; // sorted, as in a QVariantMap
+        QVector<QByteArray> keyText; // each key escaped and followed by ':'
+        QVector<QVector<QVariant>> columns;
+        int rowCount;
+    };
+
+    struct Row
+    {
+        int schema; // -1 when the properties are not a map
+        int index; // in the columns of the schema, or in m_otherValues
+    };
+
+    int findSchema(const QVariantMap &properties);
+
+    QVector<Schema> m_schemas;
+    QHash<QString, int> m_schemaIndex; // keyed by the keys of each schema, each one followed by a null character
+    QHash<QString, QString> m_keys; // interned keys, shared by the schemas
+    QVector<Row> m_rows;
+    QVariantList m_otherValues;
+    int m_lastSchema; // schema of the last map row, tried first
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,687 @@
+#include <qgeojson_p.h>
+
+#include <QtCore/qbuffer.h>
+#include <QtCore/qfuture.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtCore/qthreadpool.h>
+#include <QtPositioning/qgeocircle.h>
+#include <QtPositioning/qgeocoordinate.h>
+#include <QtPositioning/qgeopath.h>
+#include <QtPositioning/qgeorectangle.h>
+#include <QtTest/QtTest>
+
+#include "geojsongenerator.h"
+
+#include <cstring>
+
+/*
+    Behavior tests of QGeoJson and the classes around it. The import paths are compared
+    through the text exportGeoJsonText() writes for their results, which does not depend on
+    how the QGeoShape values compare.
+*/
+
+// A Point, a LineString and a Polygon, with ids and properties; positions are longitude first
+static const char sampleCollection[] =
+    "{\"type\":\"FeatureCollection\",\"features\":["
+    "{\"type\":\"Feature\",\"id\":1,\"properties\":{\"name\":\"a\",\"rank\":3},"
+    "\"geometry\":{\"type\":\"Point\",\"coordinates\":[10,20]}},"
+    "{\"type\":\"Feature\",\"id\":2,\"properties\":{\"name\":\"b\",\"rank\":2},"
+    "\"geometry\":{\"type\":\"LineString\",\"coordinates\":[[30,40],[31,41.5],[32,42]]}},"
+    "{\"type\":\"Feature\",\"id\":3,\"properties\":{\"name\":\"c\",\"rank\":1},"
+    "\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[[-10,-10],[-5,-10],[-5,-5],[-10,-10]]]}}"
+    "]}";
+
+static QByteArray sampleText()
+{
+    return QByteArray(sampleCollection);
+}
+
+static QVariantList featureList(const QVariantMap &geojsonMap)
+{
+    return geojsonMap.value(QStringLiteral("FeatureCollection")).value<QVariantList>();
+}
+
+static QVariantMap collectionMap(const QVariantList &features)
+{
+    QVariantMap geojsonMap;
+    geojsonMap.insert(QStringLiteral("FeatureCollection"), features);
+    return geojsonMap;
+}
+
+static QByteArray storeText(const QGeoJsonGeometryStore &store)
+{
+    return QGeoJson::exportGeometryStore(store).toJson(QJsonDocument::Compact);
+}
+
+// Holds the only thread of a pool until released, so that a job queued behind it can be
+// canceled before it runs
+class BlockingJob : public QRunnable
+{
+public:
+    explicit BlockingJob(QSemaphore *started, QSemaphore *release)
+        : m_started(started), m_release(release)
+    {
+    }
+
+    void run() override
+    {
+        m_started->release();
+        m_release->acquire();
+    }
+
+private:
+    QSemaphore *m_started;
+    QSemaphore *m_release;
+};
+
+class tst_QGeoJson : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void importText();
+    void importMalformedText();
+    void readerDevice();
+    void readerChunks();
+    void readerSplit();
+    void readerMalformed_data();
+    void readerMalformed();
+    void writer();
+    void seqWriterReader();
+    void snapshot();
+    void snapshotCorrupted();
+    void geometryStore_data();
+    void geometryStore();
+    void lazyDocument();
+    void asyncImport();
+    void asyncImportMalformed();
+    void asyncImportCanceled();
+    void spatialIndex();
+    void tileIndex();
+    void incrementalExporter();
+    void propertyTable();
+    void filter();
+    void memoryBudget();
+    void simplification();
+    void stats();
+};
+
+void tst_QGeoJson::importText()
+{
+    QJsonParseError error;
+    const QVariantMap direct = QGeoJson::importGeoJson(sampleText(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(featureList(direct).size(), 3);
+
+    const QVariantMap document = QGeoJson::importGeoJson(QJsonDocument::fromJson(sampleText()));
+    QCOMPARE(QGeoJson::exportGeoJsonText(direct), QGeoJson::exportGeoJsonText(document));
+
+    const QGeoCircle point = featureList(direct).at(0).toMap().value(QStringLiteral("Feature")).toMap()
+            .value(QStringLiteral("geometry")).toMap().value(QStringLiteral("Point")).value<QGeoCircle>();
+    QCOMPARE(point.center().latitude(), 10.0); // the first position member
+    QCOMPARE(point.center().longitude(), 20.0);
+}
+
+void tst_QGeoJson::importMalformedText()
+{
+    QJsonParseError error;
+    const QVariantMap geojsonMap = QGeoJson::importGeoJson(QByteArray("{\"type\":\"FeatureCollection\",\"features\":[{"), &error);
+    QVERIFY(error.error != QJsonParseError::NoError);
+    QVERIFY(geojsonMap.isEmpty());
+}
+
+void tst_QGeoJson::readerDevice()
+{
+    QByteArray text = sampleText();
+    QBuffer buffer(&text);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    QGeoJsonReader reader(&buffer);
+    QVariantList features;
+    while (reader.readNextFeature())
+        features.append(reader.feature());
+    QCOMPARE(reader.error(), QGeoJsonReader::NoError);
+    QVERIFY(reader.atEnd());
+    QCOMPARE(QGeoJson::exportGeoJsonText(collectionMap(features)),
+             QGeoJson::exportGeoJsonText(QGeoJson::importGeoJson(sampleText())));
+}
+
+void tst_QGeoJson::readerChunks()
+{
+    const QByteArray text = sampleText();
+    QGeoJsonReader reader;
+    QVariantList features;
+    for (int pos = 0; pos < text.size(); pos += 7) {
+        reader.addData(text.mid(pos, 7));
+        while (reader.readNextFeature())
+            features.append(reader.feature());
+        QVERIFY(reader.error() == QGeoJsonReader::NoError || reader.error() == QGeoJsonReader::PrematureEndOfDocumentError);
+    }
+    QVERIFY(reader.atEnd());
+    QCOMPARE(QGeoJson::exportGeoJsonText(collectionMap(features)),
+             QGeoJson::exportGeoJsonText(QGeoJson::importGeoJson(text)));
+}
+
+void tst_QGeoJson::readerSplit()
+{
+    // Chunk boundaries at every position, in strings with escapes and brackets, in numbers
+    // and literals, and elements which are not objects; "type" comes last
+    const QByteArray text(
+        "{\"bbox\":[-10,-10,32,42],\"features\":[ {\"type\":\"Feature\",\"id\":1,"
+        "\"properties\":{\"name\":\"a\\\"]}\"},\"geometry\":{\"type\":\"Point\",\"coordinates\":[10.25,-20]}},\n"
+        "  12.5e1 , null,\"b\\\\\",{\"type\":\"Feature\",\"id\":\"x\",\"properties\":null,"
+        "\"geometry\":{\"type\":\"LineString\",\"coordinates\":[[30,40],[31,41.5]]}}],"
+        " \"type\" : \"FeatureCollection\"}\n");
+    const QByteArray expected = QGeoJson::exportGeoJsonText(QGeoJson::importGeoJson(text));
+    QCOMPARE(featureList(QGeoJson::importGeoJson(text)).size(), 5);
+
+    for (int split = 0; split <= text.size(); ++split) {
+        QGeoJsonReader reader;
+        QVariantList features;
+        reader.addData(text.left(split));
+        while (reader.readNextFeature())
+            features.append(reader.feature());
+        QVERIFY(reader.error() == QGeoJsonReader::NoError || reader.error() == QGeoJsonReader::PrematureEndOfDocumentError);
+        reader.addData(text.mid(split));
+        while (reader.readNextFeature())
+            features.append(reader.feature());
+        QVERIFY2(reader.error() == QGeoJsonReader::NoError, qPrintable(reader.errorString()));
+        QVERIFY(reader.atEnd());
+        QCOMPARE(QGeoJson::exportGeoJsonText(collectionMap(features)), expected);
+    }
+}
+
+void tst_QGeoJson::readerMalformed_data()
+{
+    QTest::addColumn<QByteArray>("text");
+
+    QTest::newRow("not an object") << QByteArray("[]");
+    QTest::newRow("missing member separator") << QByteArray("{\"type\":\"FeatureCollection\" \"features\":[]}");
+    QTest::newRow("unquoted key") << QByteArray("{type:\"FeatureCollection\",\"features\":[]}");
+    QTest::newRow("missing colon") << QByteArray("{\"type\" \"FeatureCollection\",\"features\":[]}");
+    QTest::newRow("invalid member value") << QByteArray("{\"type\":\"FeatureCollection\",\"bbox\":[1,2,],\"features\":[]}");
+    QTest::newRow("invalid literal") << QByteArray("{\"type\":\"FeatureCollection\",\"name\":nul,\"features\":[]}");
+    QTest::newRow("missing feature separator")
+            << QByteArray("{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\"} {\"type\":\"Feature\"}]}");
+    QTest::newRow("garbage between features")
+            << QByteArray("{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\"}, x, {\"type\":\"Feature\"}]}");
+    QTest::newRow("trailing feature separator") << QByteArray("{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\"},]}");
+    QTest::newRow("invalid scalar feature") << QByteArray("{\"type\":\"FeatureCollection\",\"features\":[tru]}");
+    QTest::newRow("invalid feature") << QByteArray("{\"type\":\"FeatureCollection\",\"features\":[{\"type\" \"Feature\"}]}");
+    QTest::newRow("unbalanced feature") << QByteArray("{\"type\":\"FeatureCollection\",\"features\":[{\"type\":[\"Feature\"}}]}");
+    QTest::newRow("garbage at end") << QByteArray("{\"type\":\"FeatureCollection\",\"features\":[]} {}");
+    QTest::newRow("Feature document") << QByteArray("{\"type\":\"Feature\",\"geometry\":null,\"properties\":null}");
+    QTest::newRow("geometry document") << QByteArray("{\"type\":\"Point\",\"coordinates\":[1,2]}");
+    QTest::newRow("features of a Feature") << QByteArray("{\"type\":\"Feature\",\"features\":[{\"type\":\"Feature\"}]}");
+    QTest::newRow("type after the features") << QByteArray("{\"features\":[],\"type\":\"GeometryCollection\"}");
+    QTest::newRow("no type") << QByteArray("{\"features\":[]}");
+}
+
+void tst_QGeoJson::readerMalformed()
+{
+    QFETCH(QByteArray, text);
+    QGeoJsonReader reader(text);
+    while (reader.readNextFeature()) {
+    }
+    QCOMPARE(reader.error(), QGeoJsonReader::NotWellFormedError);
+    QVERIFY(reader.atEnd());
+    QVERIFY(!reader.errorString().isEmpty());
+}
+
+void tst_QGeoJson::writer()
+{
+    const QVariantMap geojsonMap = QGeoJson::importGeoJson(sampleText());
+    QByteArray text;
+    QBuffer buffer(&text);
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+
+    QGeoJsonWriter writer(&buffer);
+    QVERIFY(writer.beginFeatureCollection());
+    for (const QVariant &feature: featureList(geojsonMap))
+        QVERIFY(writer.writeFeature(feature.toMap()));
+    QVERIFY(writer.end());
+    QVERIFY(!writer.hasError());
+    QCOMPARE(text, QGeoJson::exportGeoJsonText(geojsonMap));
+}
+
+void tst_QGeoJson::seqWriterReader()
+{
+    const QVariantList features = featureList(QGeoJson::importGeoJson(sampleText()));
+    for (bool recordSeparator: { false, true }) {
+        QByteArray text;
+        QBuffer buffer(&text);
+        QVERIFY(buffer.open(QIODevice::WriteOnly));
+        QGeoJsonSeqWriter writer(&buffer);
+        writer.setRecordSeparator(recordSeparator);
+        for (const QVariant &feature: features)
+            QVERIFY(writer.writeFeature(feature.toMap()));
+        buffer.close();
+
+        QGeoJsonSeqReader reader(text);
+        int count = 0;
+        while (reader.readNextFeature()) {
+            QVERIFY(count < features.size());
+            QCOMPARE(QGeoJson::exportGeoJsonText(reader.feature()),
+                     QGeoJson::exportGeoJsonText(features.at(count).toMap()));
+            ++count;
+        }
+        QCOMPARE(count, features.size());
+        QCOMPARE(reader.error(), QGeoJsonSeqReader::NoError);
+        QCOMPARE(reader.invalidRecordCount(), 0);
+    }
+}
+
+void tst_QGeoJson::snapshot()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("sample.snapshot"));
+
+    const QGeoJsonGeometryStore store = QGeoJson::importGeometryStore(sampleText());
+    QCOMPARE(store.featureCount(), 3);
+    QString errorString;
+    QVERIFY2(QGeoJson::saveSnapshot(store, fileName, &errorString), qPrintable(errorString));
+
+    const QGeoJsonSnapshot snapshot = QGeoJson::loadSnapshot(fileName, &errorString);
+    QVERIFY2(!snapshot.isNull(), qPrintable(errorString));
+    QVERIFY(snapshot.verifyChecksum());
+    QCOMPARE(snapshot.featureCount(), store.featureCount());
+    QCOMPARE(snapshot.vertexCount(), store.vertexCount());
+    QCOMPARE(snapshot.featureId(1), QVariant(2.0));
+    QCOMPARE(storeText(snapshot.toGeometryStore()), storeText(store));
+}
+
+void tst_QGeoJson::snapshotCorrupted()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("sample.snapshot"));
+    QVERIFY(QGeoJson::saveSnapshot(QGeoJson::importGeometryStore(sampleText()), fileName));
+    QFile savedFile(fileName);
+    QVERIFY(savedFile.open(QIODevice::ReadOnly));
+    const QByteArray saved = savedFile.readAll();
+    savedFile.close();
+
+    auto writeSnapshot = [&fileName](const QByteArray &data) {
+        QFile file(fileName);
+        return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(data) == data.size();
+    };
+
+    for (int size: { 0, 16, saved.size() / 2, saved.size() - 8 }) {
+        QVERIFY(writeSnapshot(saved.left(size)));
+        QString errorString;
+        QVERIFY(QGeoJson::loadSnapshot(fileName, &errorString).isNull());
+        QVERIFY(!errorString.isEmpty());
+    }
+
+    // Every 32-bit word overwritten in turn: a snapshot which still opens must be readable in
+    // full, and fail its checksum
+    for (int pos = 0; pos + 4 <= saved.size(); pos += 4) {
+        for (qint32 value: { qint32(-1), qint32(1), qint32(0x7fffffff) }) {
+            QByteArray data = saved;
+            memcpy(data.data() + pos, &value, sizeof(value));
+            if (data == saved)
+                continue;
+            QVERIFY(writeSnapshot(data));
+            const QGeoJsonSnapshot snapshot = QGeoJson::loadSnapshot(fileName);
+            if (snapshot.isNull())
+                continue;
+            QVERIFY2(!snapshot.verifyChecksum(), qPrintable(QStringLiteral("word at %1").arg(pos)));
+            const QVariantMap geojsonMap = snapshot.toVariantMap();
+            Q_UNUSED(geojsonMap)
+        }
+    }
+}
+
+void tst_QGeoJson::geometryStore_data()
+{
+    QTest::addColumn<QByteArray>("text");
+
+    GeoJsonGenerator generator;
+    for (int kind = 0; kind < GeoJsonGenerator::KindCount; ++kind) {
+        const GeoJsonGenerator::Kind generatorKind = GeoJsonGenerator::Kind(kind);
+        QTest::newRow(qPrintable(GeoJsonGenerator::kindName(generatorKind)))
+                << generator.generate(generatorKind, 2000).text;
+    }
+
+    QTest::newRow("sample") << sampleText();
+    QTest::newRow("nested collections") << QByteArray(
+        "{\"type\":\"FeatureCollection\",\"features\":["
+        "{\"type\":\"Feature\",\"id\":\"gc\",\"properties\":null,\"geometry\":{\"type\":\"GeometryCollection\",\"geometries\":["
+        "{\"type\":\"GeometryCollection\",\"geometries\":[{\"type\":\"Point\",\"coordinates\":[1,2]},"
+        "{\"type\":\"GeometryCollection\",\"geometries\":[]}]},"
+        "{\"coordinates\":[[[0,0],[1,0],[1,1],[0,0]]],\"type\":\"Polygon\"},"
+        "{\"type\":\"MultiPoint\",\"coordinates\":[[3,4],[5,6]]}]}},"
+        "{\"type\":\"Feature\",\"geometry\":null,\"properties\":{}}]}");
+    QTest::newRow("collection document") << QByteArray(
+        "{\"geometries\":[{\"type\":\"LineString\",\"coordinates\":[[1,2],[3,4]]},"
+        "{\"type\":\"GeometryCollection\",\"geometries\":[{\"type\":\"Point\",\"coordinates\":[5,6]}]}],"
+        "\"type\":\"GeometryCollection\"}");
+    QTest::newRow("altitudes") << QByteArray(
+        "{\"type\":\"FeatureCollection\",\"features\":["
+        "{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\",\"coordinates\":[1,2,3.5]}},"
+        "{\"type\":\"Feature\",\"geometry\":{\"type\":\"LineString\",\"coordinates\":[[1,2,-10],[3,4],[5,6,1e3]]}},"
+        "{\"type\":\"Feature\",\"geometry\":{\"type\":\"MultiPolygon\",\"coordinates\":"
+        "[[[[0,0,1],[1,0,2],[1,1,3],[0,0,1]]],[[[5,5],[6,5],[6,6],[5,5]]]]}}]}");
+    QTest::newRow("escapes") << QByteArray(
+        "{\"type\":\"Feature\",\"id\":\"a\\\"b\","
+        "\"properties\":{\"name\":\"line\\nbreak \\u00e9 \\\\ \\/\",\"n\\u0061me2\":[1,\"\\ud83d\\ude00\"]},"
+        "\"geo\\u006detry\":{\"ty\\u0070e\":\"\\u0050oint\",\"coordinates\":[7,8]}}");
+    QTest::newRow("bbox") << QByteArray(
+        "{\"bbox\":[-10,-10,32,42],\"type\":\"FeatureCollection\",\"features\":["
+        "{\"type\":\"Feature\",\"bbox\":[10,20,10,20],\"geometry\":{\"type\":\"Point\",\"bbox\":[10,20,10,20],"
+        "\"coordinates\":[10,20]},\"properties\":{\"bbox\":true}}]}");
+    QTest::newRow("geometry bbox") << QByteArray(
+        "{\"type\":\"MultiLineString\",\"coordinates\":[[[1,2],[3,4]],[[5,6,7],[8,9,10]]],\"bbox\":[1,2,8,9]}");
+}
+
+// The direct text import of the store gives the same store as the import of a QJsonDocument
+void tst_QGeoJson::geometryStore()
+{
+    QFETCH(QByteArray, text);
+
+    QJsonParseError error;
+    const QGeoJsonGeometryStore direct = QGeoJson::importGeometryStore(text, &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    const QJsonDocument document = QJsonDocument::fromJson(text, &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    const QGeoJsonGeometryStore documentStore = QGeoJson::importGeometryStore(document);
+
+    QCOMPARE(direct.documentType(), documentStore.documentType());
+    QCOMPARE(direct.featureCount(), documentStore.featureCount());
+    QCOMPARE(direct.geometryCount(), documentStore.geometryCount());
+    QCOMPARE(storeText(direct), storeText(documentStore));
+}
+
+void tst_QGeoJson::lazyDocument()
+{
+    QJsonParseError error;
+    const QGeoJsonLazyDocument document = QGeoJson::importLazy(sampleText(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(document.featureCount(), 3);
+    QVERIFY(!document.isGeometryLoaded(1));
+    QCOMPARE(document.featureProperties(1).toMap().value(QStringLiteral("name")).toString(), QStringLiteral("b"));
+    QVERIFY(!document.isGeometryLoaded(1));
+    QVERIFY(document.featureGeometry(1).contains(QStringLiteral("LineString")));
+    QVERIFY(document.isGeometryLoaded(1));
+    QCOMPARE(QGeoJson::exportGeoJsonText(document.toVariantMap()),
+             QGeoJson::exportGeoJsonText(QGeoJson::importGeoJson(sampleText())));
+}
+
+void tst_QGeoJson::asyncImport()
+{
+    QFuture<QVariantMap> future = QGeoJson::importGeoJsonAsync(sampleText());
+    future.waitForFinished();
+    QVERIFY(!future.isCanceled());
+    QCOMPARE(QGeoJson::exportGeoJsonText(future.result()),
+             QGeoJson::exportGeoJsonText(QGeoJson::importGeoJson(sampleText())));
+}
+
+void tst_QGeoJson::asyncImportMalformed()
+{
+    const QByteArray text("{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\",\"geometry\":");
+    QJsonParseError error;
+    QGeoJson::importLazy(text, &error); // the scan of importGeoJsonAsync()
+    QVERIFY(error.error != QJsonParseError::NoError);
+
+    QFuture<QVariantMap> future = QGeoJson::importGeoJsonAsync(text);
+    future.waitForFinished();
+    QVERIFY(!future.isCanceled());
+    QCOMPARE(future.resultCount(), 0); // not an empty FeatureCollection
+    QCOMPARE(future.progressValue(), future.progressMaximum());
+    QCOMPARE(future.progressText(), QStringLiteral("parse error at offset %1: %2")
+             .arg(error.offset).arg(error.errorString()));
+}
+
+void tst_QGeoJson::asyncImportCanceled()
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(1);
+    QSemaphore started;
+    QSemaphore release;
+    pool.start(new BlockingJob(&started, &release));
+    started.acquire();
+
+    QFuture<QVariantMap> future = QGeoJson::importGeoJsonAsync(sampleText(), &pool);
+    future.cancel();
+    release.release();
+    QVERIFY(pool.waitForDone());
+    QVERIFY(future.isCanceled());
+    QVERIFY(future.isFinished());
+    QCOMPARE(future.resultCount(), 0);
+}
+
+void tst_QGeoJson::spatialIndex()
+{
+    const QVariantMap geojsonMap = QGeoJson::importGeoJson(sampleText());
+    QGeoJsonSpatialIndex index;
+    index.build(geojsonMap);
+    QCOMPARE(index.size(), 3);
+
+    QCOMPARE(index.intersects(9, 19, 11, 21), QVector<int>() << 0);
+    QCOMPARE(index.intersects(31.5, 41, 50, 50), QVector<int>() << 1);
+    QVERIFY(index.intersects(0, 0, 1, 1).isEmpty());
+
+    QVector<int> all = index.intersects(-90, -90, 90, 90);
+    std::sort(all.begin(), all.end());
+    QCOMPARE(all, QVector<int>() << 0 << 1 << 2);
+
+    QCOMPARE(index.nearest(QGeoCoordinate(-6, -6), 1), QVector<int>() << 2);
+    QCOMPARE(index.nearest(QGeoCoordinate(41, 33), 1), QVector<int>() << 1);
+
+    // geographic rectangles, longitudes 9 to 11 and latitudes 19 to 21 hold the Point
+    QCOMPARE(index.intersects(QGeoRectangle(QGeoCoordinate(21, 9), QGeoCoordinate(19, 11))), QVector<int>() << 0);
+    QVERIFY(index.intersects(QGeoRectangle(QGeoCoordinate(11, 19), QGeoCoordinate(9, 21))).isEmpty());
+
+    // longitudes past 90 degrees, and a rectangle crossing the antimeridian
+    QGeoJsonSpatialIndex worldIndex;
+    worldIndex.addItem(0, 175, -5, 179, 5);
+    worldIndex.addItem(1, -179, -5, -175, 5);
+    worldIndex.addItem(2, -5, -5, 5, 5);
+    worldIndex.addItem(3, -180, 40, 180, 50);
+    worldIndex.finish();
+    QCOMPARE(worldIndex.intersects(QGeoRectangle(QGeoCoordinate(10, 170), QGeoCoordinate(-10, -170))),
+             QVector<int>() << 0 << 1);
+    QCOMPARE(worldIndex.intersects(QGeoRectangle(QGeoCoordinate(45, 170), QGeoCoordinate(-10, -170))),
+             QVector<int>() << 0 << 1 << 3);
+    QCOMPARE(worldIndex.intersects(QGeoRectangle(QGeoCoordinate(10, 100), QGeoCoordinate(-10, 176))),
+             QVector<int>() << 0);
+    QCOMPARE(worldIndex.nearest(QGeoCoordinate(0, -178), 1), QVector<int>() << 1);
+    QCOMPARE(worldIndex.nearest(QGeoCoordinate(0, 180), 2).size(), 2);
+
+    QGeoJsonSpatialIndex storeIndex;
+    storeIndex.build(QGeoJson::importGeometryStore(sampleText()));
+    QCOMPARE(storeIndex.intersects(9, 19, 11, 21), QVector<int>() << 0);
+}
+
+void tst_QGeoJson::tileIndex()
+{
+    QGeoJsonTileIndex index;
+    QVERIFY(index.tile(0, 0, 0).isEmpty());
+    index.build(QGeoJson::importGeoJson(sampleText()));
+    QCOMPARE(index.featureCount(), 3);
+
+    const QVariantMap root = index.tile(0, 0, 0);
+    QCOMPARE(featureList(root).size(), 3);
+    QVERIFY(index.tile(1, 2, 0).isEmpty()); // outside of zoom level 1
+    QVERIFY(index.tile(index.options().maxZoom + 1, 0, 0).isEmpty());
+
+    // the Point at longitude 10, latitude 20 lies in the north-east quadrant at zoom level 1
+    const QVariantList northEast = featureList(index.tile(1, 1, 0));
+    bool hasPoint = false;
+    for (const QVariant &feature: northEast) {
+        if (feature.toMap().value(QStringLiteral("Feature")).toMap().value(QStringLiteral("id")).toInt() == 1)
+            hasPoint = true;
+    }
+    QVERIFY(hasPoint);
+}
+
+void tst_QGeoJson::incrementalExporter()
+{
+    QVariantMap geojsonMap = QGeoJson::importGeoJson(sampleText());
+    QGeoJsonIncrementalExporter exporter;
+    QCOMPARE(exporter.exportGeoJsonText(geojsonMap), QGeoJson::exportGeoJsonText(geojsonMap));
+    QCOMPARE(exporter.reusedCount(), 0);
+    QCOMPARE(exporter.exportGeoJsonText(geojsonMap), QGeoJson::exportGeoJsonText(geojsonMap));
+    QCOMPARE(exporter.reusedCount(), 3);
+
+    // a modified feature is exported again
+    QVariantList features = featureList(geojsonMap);
+    QVariantMap feature = features.at(0).toMap();
+    QVariantMap featureMap = feature.value(QStringLiteral("Feature")).toMap();
+    QVariantMap properties = featureMap.value(QStringLiteral("properties")).toMap();
+    properties.insert(QStringLiteral("name"), QStringLiteral("z"));
+    featureMap.insert(QStringLiteral("properties"), properties);
+    feature.insert(QStringLiteral("Feature"), featureMap);
+    features[0] = feature;
+    geojsonMap = collectionMap(features);
+    QCOMPARE(exporter.exportGeoJsonText(geojsonMap), QGeoJson::exportGeoJsonText(geojsonMap));
+    QCOMPARE(exporter.reusedCount(), 2);
+}
+
+void tst_QGeoJson::propertyTable()
+{
+    QGeoJsonPropertyTable table;
+    QGeoJson::ImportOptions importOptions;
+    importOptions.propertyTable = &table;
+    const QVariantMap geojsonMap = QGeoJson::importGeoJson(sampleText(), importOptions);
+    QCOMPARE(table.rowCount(), 3);
+    QCOMPARE(table.schemaCount(), 1);
+    QCOMPARE(table.value(1, QStringLiteral("name")).toString(), QStringLiteral("b"));
+    QCOMPARE(table.properties(2).toMap().value(QStringLiteral("rank")).toDouble(), 1.0);
+    QVERIFY(!featureList(geojsonMap).at(0).toMap().value(QStringLiteral("Feature")).toMap()
+            .contains(QStringLiteral("properties")));
+
+    QGeoJson::ExportOptions exportOptions;
+    exportOptions.propertyTable = &table;
+    QCOMPARE(QGeoJson::exportGeoJsonText(geojsonMap, exportOptions),
+             QGeoJson::exportGeoJsonText(QGeoJson::importGeoJson(sampleText())));
+}
+
+void tst_QGeoJson::filter()
+{
+    // longitudes 5 to 15, latitudes 15 to 25: the Point only
+    QGeoJson::ImportOptions options;
+    options.filter = QGeoRectangle(QGeoCoordinate(25, 5), QGeoCoordinate(15, 15));
+    const QVariantList features = featureList(QGeoJson::importGeoJson(sampleText(), options));
+    QCOMPARE(features.size(), 1);
+    QCOMPARE(features.at(0).toMap().value(QStringLiteral("Feature")).toMap().value(QStringLiteral("id")).toInt(), 1);
+
+    const QVariantList documentFeatures = featureList(QGeoJson::importGeoJson(QJsonDocument::fromJson(sampleText()), options));
+    QCOMPARE(QGeoJson::exportGeoJsonText(collectionMap(documentFeatures)),
+             QGeoJson::exportGeoJsonText(collectionMap(features)));
+
+    // The text import reads the extents itself; it must keep the features the QJsonDocument
+    // import keeps: "bbox" first, the last occurrence of a member, GeometryCollections,
+    // positions with values which are not numbers, features without coordinates
+    const QByteArray text(
+        "{\"type\":\"FeatureCollection\",\"features\":["
+        "{\"type\":\"Feature\",\"bbox\":[100,0,101,1],\"geometry\":{\"type\":\"Point\",\"coordinates\":[10,20]}},"
+        "{\"type\":\"Feature\",\"bbox\":[1,2,3],\"geometry\":{\"type\":\"Point\",\"coordinates\":[10,20]}},"
+        "{\"type\":\"Feature\",\"bbox\":[100,0,0,101,1,0],\"geometry\":null,\"bbox\":\"none\"},"
+        "{\"type\":\"Feature\",\"geometry\":{\"type\":\"GeometryCollection\",\"geometries\":["
+        "{\"type\":\"Point\",\"coordinates\":[-170,5,3]},{\"type\":\"LineString\",\"coordinates\":[[175,-5],[179,5]]}]}},"
+        "{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\",\"coordinates\":[175,\"x\"]}},"
+        "{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\",\"coordinates\":[175]}},"
+        "{\"type\":\"Feature\",\"geometry\":{\"coordinates\":[[[0,0]],3,[\"a\",[1,1]]],\"type\":\"MultiPolygon\"}},"
+        "{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\",\"coordinates\":[10,20]},\"geometry\":{\"type\":\"Point\",\"coordinates\":[-10,-20]}},"
+        "{\"type\":\"Feature\",\"properties\":{\"bbox\":[0,0,1,1]}},"
+        "7,{}]}");
+    const QGeoRectangle rectangles[] = {
+        QGeoRectangle(QGeoCoordinate(25, 5), QGeoCoordinate(15, 15)),
+        QGeoRectangle(QGeoCoordinate(10, 90), QGeoCoordinate(-10, 178)),
+        QGeoRectangle(QGeoCoordinate(10, 170), QGeoCoordinate(-10, -175)),
+        QGeoRectangle(QGeoCoordinate(2, -1), QGeoCoordinate(-1, 2)),
+        QGeoRectangle(QGeoCoordinate(-15, -15), QGeoCoordinate(-25, -5)),
+        QGeoRectangle(QGeoCoordinate(90, -180), QGeoCoordinate(-90, 180))
+    };
+    for (const QGeoRectangle &rectangle: rectangles) {
+        options.filter = rectangle;
+        QJsonParseError error;
+        const QVariantMap direct = QGeoJson::importGeoJson(text, options, &error);
+        QCOMPARE(error.error, QJsonParseError::NoError);
+        QCOMPARE(QGeoJson::exportGeoJsonText(direct),
+                 QGeoJson::exportGeoJsonText(QGeoJson::importGeoJson(QJsonDocument::fromJson(text), options)));
+    }
+    options.filter = QGeoRectangle(QGeoCoordinate(10, 90), QGeoCoordinate(-10, 178));
+    QCOMPARE(featureList(QGeoJson::importGeoJson(text, options)).size(), 3);
+
+    // other documents are imported whole
+    const QByteArray feature("{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\",\"coordinates\":[10,20]},\"properties\":null}");
+    QVERIFY(QGeoJson::importGeoJson(feature, options).contains(QStringLiteral("Feature")));
+    const QByteArray point("{\"type\":\"Point\",\"coordinates\":[10,20]}");
+    QCOMPARE(QGeoJson::exportGeoJsonText(QGeoJson::importGeoJson(point, options)),
+             QGeoJson::exportGeoJsonText(QGeoJson::importGeoJson(point)));
+
+    // malformed features are reported, even those left out
+    QJsonParseError error;
+    QGeoJson::importGeoJson(QByteArray("{\"type\":\"FeatureCollection\",\"features\":[{\"geometry\":{\"coordinates\":[1 2]}}]}"),
+                            options, &error);
+    QVERIFY(error.error != QJsonParseError::NoError);
+}
+
+void tst_QGeoJson::memoryBudget()
+{
+    QString errorString;
+    QGeoJson::ImportOptions options;
+    options.errorString = &errorString;
+    options.memoryBudget = 64;
+    QVERIFY(QGeoJson::importGeoJson(sampleText(), options).isEmpty());
+    QVERIFY(!errorString.isEmpty());
+
+    const QVariantMap geojsonMap = QGeoJson::importGeoJson(sampleText());
+    options.memoryBudget = QGeoJson::memoryUsage(geojsonMap).totalBytes();
+    QCOMPARE(QGeoJson::exportGeoJsonText(QGeoJson::importGeoJson(sampleText(), options)),
+             QGeoJson::exportGeoJsonText(geojsonMap));
+    QVERIFY(errorString.isEmpty());
+}
+
+void tst_QGeoJson::simplification()
+{
+    const QByteArray text("{\"type\":\"LineString\",\"coordinates\":[[0,0],[1,1],[2,2.001],[3,3],[4,4]]}");
+    for (QGeoJson::Simplification simplification: { QGeoJson::DouglasPeucker, QGeoJson::VisvalingamWhyatt }) {
+        QGeoJson::ImportOptions options;
+        options.simplification = simplification;
+        options.simplifyTolerance = 0.1;
+        const QGeoPath path = QGeoJson::importGeoJson(text, options).value(QStringLiteral("LineString")).value<QGeoPath>();
+        QCOMPARE(path.path().size(), 2);
+        QCOMPARE(path.path().first().latitude(), 0.0);
+        QCOMPARE(path.path().last().latitude(), 4.0);
+    }
+
+    QGeoJson::ImportOptions options;
+    options.simplification = QGeoJson::DouglasPeucker; // no tolerance, off
+    QCOMPARE(QGeoJson::importGeoJson(text, options).value(QStringLiteral("LineString")).value<QGeoPath>().path().size(), 5);
+}
+
+void tst_QGeoJson::stats()
+{
+#ifdef QGEOJSON_NO_STATS
+    QSKIP("The statistics are not compiled in");
+#endif
+    QGeoJsonStats stats;
+    QGeoJson::ImportOptions options;
+    options.stats = &stats;
+    QGeoJson::importGeoJson(sampleText(), options);
+    QCOMPARE(stats.featureCount, 3);
+    QCOMPARE(stats.geometryCounts[QGeoJsonGeometryStore::Point], 1);
+    QCOMPARE(stats.geometryCounts[QGeoJsonGeometryStore::LineString], 1);
+    QCOMPARE(stats.geometryCounts[QGeoJsonGeometryStore::Polygon], 1);
+    QCOMPARE(stats.ringCount, 1);
+    QCOMPARE(stats.vertexCount, qint64(8));
+    QCOMPARE(stats.bytesIn, qint64(sampleText().size()));
+
+    QGeoJsonStats exportStats;
+    QGeoJson::ExportOptions exportOptions;
+    exportOptions.stats = &exportStats;
+    const QByteArray text = QGeoJson::exportGeoJsonText(QGeoJson::importGeoJson(sampleText()), exportOptions);
+    QCOMPARE(exportStats.featureCount, 3);
+    QCOMPARE(exportStats.bytesOut, qint64(text.size()));
+}
+
+QTEST_GUILESS_MAIN(tst_QGeoJson)
+
+#include "tst_qgeojson.moc"